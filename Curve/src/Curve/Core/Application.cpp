@@ -2,21 +2,30 @@
 #include "Application.h"
 
 #include "Time.h"
+#include "JobSystem.h"
 
 #include "Curve/Renderer/Renderer.h"
 
 namespace cv {
 
 	Application::Application(const ApplicationSpecification& spec)
-		: m_Specification(spec), m_Window(spec.WindowTitle, spec.WindowWidth, spec.WindowHeight)
+		: m_Specification(spec), m_Window(spec.WindowTitle, spec.WindowWidth, spec.WindowHeight, spec.Headless)
 	{
 		s_Instance = this;
 
+		JobSystem::Init(m_Specification.ThreadCount);
+
+		// ImGui needs a swapchain to render into
+		if (m_Specification.Headless)
+			m_Specification.UseImGui = false;
+
 		m_Window.SetEventCallback([this](Event& event) { this->OnEvent(event); });
 
-		m_Renderer = Renderer::Create(m_Window);
+		RendererSpecification rendererSpec{};
+		rendererSpec.Headless = m_Specification.Headless;
+		m_Renderer = Renderer::Create(m_Window, rendererSpec);
 
-		if (spec.UseImGui)
+		if (m_Specification.UseImGui)
 		{
 			m_ImGuiLayer = m_Renderer->CreateImGuiLayer();
 			PushLayer(m_ImGuiLayer);
@@ -28,10 +37,18 @@ namespace cv {
 		m_LayerStack.Clear();
 
 		delete m_Renderer;
+
+		JobSystem::Shutdown();
 	}
 
 	void Application::Run()
 	{
+		if (m_Specification.Headless)
+		{
+			RunHeadless();
+			return;
+		}
+
 		m_Window.Show();
 
 		while (m_Running)
@@ -68,6 +85,71 @@ namespace cv {
 		m_Window.Hide();
 	}
 
+	void Application::RunHeadless()
+	{
+		CV_INFO("Rendering ", m_Specification.HeadlessFrameCount, " headless frames");
+
+		float startTime = Time::GetTime();
+		m_LastFrameTime = startTime;
+
+		for (uint32_t frame = 0; frame < m_Specification.HeadlessFrameCount && m_Running; frame++)
+		{
+			float time = Time::GetTime();
+			Timestep timestep = time - m_LastFrameTime;
+			m_LastFrameTime = time;
+
+			m_Renderer->BeginFrame();
+			for (Layer* layer : m_LayerStack)
+				layer->OnUpdate(timestep);
+			m_Renderer->EndFrame();
+
+			m_Window.OnUpdate();
+		}
+
+		float totalTime = Time::GetTime() - startTime;
+		uint32_t frameCount = std::max(m_Specification.HeadlessFrameCount, 1u);
+		CV_INFO("Headless run took ", totalTime * 1000.0f, "ms (", totalTime * 1000.0f / (float)frameCount, "ms/frame)");
+
+		if (!m_Specification.HeadlessOutputPath.empty())
+			WriteHeadlessTarget(m_Specification.HeadlessOutputPath);
+	}
+
+	void Application::WriteHeadlessTarget(const std::filesystem::path& path)
+	{
+		if (!m_HeadlessTarget)
+		{
+			CV_WARNING("No headless target set, nothing to write to ", path.string());
+			return;
+		}
+
+		uint32_t width = m_HeadlessTarget->GetWidth();
+		uint32_t height = m_HeadlessTarget->GetHeight();
+
+		Buffer<StagingBuffer>* buffer = m_Renderer->CreateBuffer<StagingBuffer>((size_t)width * height * 4);
+		m_HeadlessTarget->CopyAttachmentImageToBuffer(0, buffer);
+
+		const uint8_t* pixels = (const uint8_t*)buffer->Map(buffer->GetSize());
+
+		// main attachment is BGRA8, write it out as binary PPM
+		std::ofstream stream(path, std::ios::binary);
+		if (stream)
+		{
+			stream << "P6\n" << width << " " << height << "\n255\n";
+			for (size_t i = 0; i < (size_t)width * height; i++)
+			{
+				const uint8_t* pixel = pixels + i * 4;
+				char rgb[3] = { (char)pixel[2], (char)pixel[1], (char)pixel[0] };
+				stream.write(rgb, 3);
+			}
+			CV_INFO("Wrote headless target to ", path.string());
+		}
+		else
+			CV_ERROR("Failed to open ", path.string(), " for writing!");
+
+		buffer->Unmap();
+		delete buffer;
+	}
+
 	void Application::OnEvent(Event& event)
 	{
 		EventDispatcher dispatcher(event);
@@ -9,6 +9,7 @@
 
 #include <string>
 #include <vector>
+#include <filesystem>
 
 namespace cv {
 
@@ -38,15 +39,24 @@ namespace cv {
 		uint32_t WindowWidth = 1280, WindowHeight = 720;
 		std::string WindowTitle = "Curve Window";
 
+		// threads used by the job system, including the main thread, 0 uses the hardware concurrency
+		uint32_t ThreadCount = 0;
+
 		bool UseImGui = true;
 		bool UseDefaultTitlebar = true;
 
+		// renders HeadlessFrameCount frames without a swapchain, then writes the headless target to HeadlessOutputPath (if set)
+		bool Headless = false;
+		uint32_t HeadlessFrameCount = 100;
+		std::filesystem::path HeadlessOutputPath;
+
 		struct
 		{
 		} WindowsPlatformSettings;
 	};
 
 	class Renderer;
+	class Framebuffer;
 
 	class Application
 	{
@@ -64,9 +74,15 @@ namespace cv {
 		void Exit() { m_Running = false; }
 
 		Renderer* GetRenderer() { return m_Renderer; }
+
+		bool IsHeadless() const { return m_Specification.Headless; }
+		void SetHeadlessTarget(Framebuffer* framebuffer) { m_HeadlessTarget = framebuffer; }
 		
 		static Application& Get() { return *s_Instance; }
 	private:
+		void RunHeadless();
+		void WriteHeadlessTarget(const std::filesystem::path& path);
+
 		bool OnWindowCloseEvent(WindowCloseEvent& event);
 	private:
 		ApplicationSpecification m_Specification;
@@ -78,6 +94,7 @@ namespace cv {
 		float m_LastFrameTime = 0.0f;
 
 		ImGuiLayer* m_ImGuiLayer = nullptr;
+		Framebuffer* m_HeadlessTarget = nullptr;
 
 		bool m_Minimized = false;
 		bool m_Running = true;
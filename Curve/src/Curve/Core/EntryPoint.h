@@ -17,7 +17,7 @@ namespace cv {
 
 }
 
-#ifdef CV_DIST
+#if defined(CV_DIST) && defined(CV_PLATFORM_WINDOWS)
 
 #include <windows.h>
 
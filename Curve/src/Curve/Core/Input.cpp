@@ -1,7 +1,7 @@
 #include "cvpch.h"
 #include "Input.h"
 
-#include <glfw/glfw3.h>
+#include <GLFW/glfw3.h>
 
 namespace cv {
 
@@ -0,0 +1,258 @@
+#include "cvpch.h"
+#include "JobSystem.h"
+
+#include "Base.h"
+
+#include <deque>
+#include <condition_variable>
+
+namespace cv {
+
+	namespace Utils {
+
+		struct JobQueue
+		{
+			std::mutex Mutex;
+			std::deque<JobHandle> Jobs;
+		};
+
+		struct JobSystemData
+		{
+			std::vector<std::thread> Workers;
+
+			// one queue per worker, queue 0 is shared by the main thread and any other thread that isn't a worker
+			std::vector<std::unique_ptr<JobQueue>> Queues;
+
+			std::mutex SleepMutex;
+			std::condition_variable WakeCondition;
+			std::atomic<uint32_t> QueuedJobs = 0;
+			std::atomic<bool> Running = false;
+		};
+
+		static JobSystemData* s_JobSystem = nullptr;
+		static thread_local uint32_t s_QueueIndex = 0;
+
+		static void EnqueueJob(const JobHandle& job);
+
+		static void ExecuteJob(const JobHandle& job)
+		{
+			job->Function();
+			job->Function = nullptr;
+
+			std::vector<JobHandle> continuations;
+			{
+				std::lock_guard<std::mutex> lock(job->ContinuationMutex);
+				job->Finished.store(true, std::memory_order_release);
+				std::swap(continuations, job->Continuations);
+			}
+
+			for (const JobHandle& continuation : continuations)
+			{
+				if (--continuation->PendingDependencies == 0)
+					EnqueueJob(continuation);
+			}
+		}
+
+		static void EnqueueJob(const JobHandle& job)
+		{
+			// without workers everything runs inline, which keeps the job system usable before Init
+			if (!s_JobSystem)
+			{
+				ExecuteJob(job);
+				return;
+			}
+
+			s_JobSystem->QueuedJobs++;
+
+			JobQueue& queue = *s_JobSystem->Queues[s_QueueIndex];
+			{
+				std::lock_guard<std::mutex> lock(queue.Mutex);
+				queue.Jobs.push_back(job);
+			}
+
+			{
+				// pairs with the predicate check in WorkerLoop, so the wakeup can't get lost
+				std::lock_guard<std::mutex> lock(s_JobSystem->SleepMutex);
+			}
+			s_JobSystem->WakeCondition.notify_one();
+		}
+
+		// the own queue is used as a stack (newest first, still warm in cache), other queues are stolen from the front
+		static bool TryRunJob()
+		{
+			if (!s_JobSystem)
+				return false;
+
+			JobHandle job;
+			{
+				JobQueue& queue = *s_JobSystem->Queues[s_QueueIndex];
+				std::lock_guard<std::mutex> lock(queue.Mutex);
+				if (!queue.Jobs.empty())
+				{
+					job = std::move(queue.Jobs.back());
+					queue.Jobs.pop_back();
+				}
+			}
+
+			size_t queueCount = s_JobSystem->Queues.size();
+			for (size_t i = 1; !job && i < queueCount; i++)
+			{
+				JobQueue& queue = *s_JobSystem->Queues[(s_QueueIndex + i) % queueCount];
+				std::lock_guard<std::mutex> lock(queue.Mutex);
+				if (!queue.Jobs.empty())
+				{
+					job = std::move(queue.Jobs.front());
+					queue.Jobs.pop_front();
+				}
+			}
+
+			if (!job)
+				return false;
+
+			s_JobSystem->QueuedJobs--;
+			ExecuteJob(job);
+			return true;
+		}
+
+		static void WorkerLoop(uint32_t queueIndex)
+		{
+			s_QueueIndex = queueIndex;
+
+			while (s_JobSystem->Running)
+			{
+				if (TryRunJob())
+					continue;
+
+				std::unique_lock<std::mutex> lock(s_JobSystem->SleepMutex);
+				s_JobSystem->WakeCondition.wait(lock, []() { return s_JobSystem->QueuedJobs > 0 || !s_JobSystem->Running; });
+			}
+		}
+
+	}
+
+	void JobSystem::Init(uint32_t threadCount)
+	{
+		CV_ASSERT(!Utils::s_JobSystem && "Job system already initialized!");
+
+		if (threadCount == 0)
+			threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+		Utils::s_JobSystem = new Utils::JobSystemData();
+		Utils::s_JobSystem->Running = true;
+
+		for (uint32_t i = 0; i < threadCount; i++)
+			Utils::s_JobSystem->Queues.push_back(std::make_unique<Utils::JobQueue>());
+
+		for (uint32_t i = 1; i < threadCount; i++)
+			Utils::s_JobSystem->Workers.emplace_back(Utils::WorkerLoop, i);
+	}
+
+	void JobSystem::Shutdown()
+	{
+		if (!Utils::s_JobSystem)
+			return;
+
+		// whatever is still queued gets finished first, someone might be holding a handle to it
+		while (Utils::TryRunJob())
+		{
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(Utils::s_JobSystem->SleepMutex);
+			Utils::s_JobSystem->Running = false;
+		}
+		Utils::s_JobSystem->WakeCondition.notify_all();
+
+		for (std::thread& worker : Utils::s_JobSystem->Workers)
+			worker.join();
+
+		delete Utils::s_JobSystem;
+		Utils::s_JobSystem = nullptr;
+	}
+
+	uint32_t JobSystem::GetThreadCount()
+	{
+		return Utils::s_JobSystem ? (uint32_t)Utils::s_JobSystem->Queues.size() : 1;
+	}
+
+	JobHandle JobSystem::Schedule(std::function<void()>&& function, std::initializer_list<JobHandle> dependencies)
+	{
+		return Schedule(std::move(function), std::vector<JobHandle>(dependencies));
+	}
+
+	JobHandle JobSystem::Schedule(std::function<void()>&& function, const std::vector<JobHandle>& dependencies)
+	{
+		JobHandle job = std::make_shared<Job>();
+		job->Function = std::move(function);
+
+		// held until every dependency is registered, so a dependency finishing in between can't queue the job early
+		job->PendingDependencies = 1;
+
+		for (const JobHandle& dependency : dependencies)
+		{
+			if (!dependency)
+				continue;
+
+			std::lock_guard<std::mutex> lock(dependency->ContinuationMutex);
+			if (!dependency->Finished)
+			{
+				dependency->Continuations.push_back(job);
+				job->PendingDependencies++;
+			}
+		}
+
+		if (--job->PendingDependencies == 0)
+			Utils::EnqueueJob(job);
+
+		return job;
+	}
+
+	void JobSystem::Wait(const JobHandle& job)
+	{
+		if (!job)
+			return;
+
+		while (!job->Finished.load(std::memory_order_acquire))
+		{
+			if (!Utils::TryRunJob())
+				std::this_thread::yield();
+		}
+	}
+
+	void JobSystem::Wait(const std::vector<JobHandle>& jobs)
+	{
+		for (const JobHandle& job : jobs)
+			Wait(job);
+	}
+
+	void JobSystem::ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& function)
+	{
+		if (count == 0)
+			return;
+
+		grainSize = std::max<size_t>(grainSize, 1);
+		size_t chunkCount = (count + grainSize - 1) / grainSize;
+
+		// chunks are handed out from a shared counter, so a slow chunk never holds up the rest of its job
+		std::atomic<size_t> nextChunk = 0;
+		auto runChunks = [&]()
+		{
+			for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+			{
+				size_t begin = chunk * grainSize;
+				function(begin, std::min(begin + grainSize, count));
+			}
+		};
+
+		size_t jobCount = std::min<size_t>(chunkCount, GetThreadCount()) - 1;
+
+		std::vector<JobHandle> jobs;
+		jobs.reserve(jobCount);
+		for (size_t i = 0; i < jobCount; i++)
+			jobs.push_back(Schedule(runChunks));
+
+		runChunks();
+		Wait(jobs);
+	}
+
+}
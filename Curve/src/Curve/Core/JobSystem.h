@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <functional>
+#include <initializer_list>
+
+namespace cv {
+
+	struct Job
+	{
+		std::function<void()> Function;
+
+		// dependencies that haven't finished yet, the job is queued once this hits zero
+		std::atomic<uint32_t> PendingDependencies = 0;
+		std::atomic<bool> Finished = false;
+
+		std::mutex ContinuationMutex;
+		std::vector<std::shared_ptr<Job>> Continuations;
+	};
+
+	using JobHandle = std::shared_ptr<Job>;
+
+	// a work-stealing thread pool: every worker owns a queue and steals from the others once it runs dry
+	// threads that wait on a job help out with queued work instead of blocking, so jobs may schedule and wait on other jobs
+	class JobSystem
+	{
+	public:
+		// threadCount includes the calling thread, 0 uses the hardware concurrency
+		static void Init(uint32_t threadCount = 0);
+		static void Shutdown();
+
+		// workers plus the main thread, 1 before Init
+		static uint32_t GetThreadCount();
+
+		// runs after all dependencies have finished, handles to finished jobs are fine
+		static JobHandle Schedule(std::function<void()>&& function, std::initializer_list<JobHandle> dependencies = {});
+		static JobHandle Schedule(std::function<void()>&& function, const std::vector<JobHandle>& dependencies);
+
+		static void Wait(const JobHandle& job);
+		static void Wait(const std::vector<JobHandle>& jobs);
+
+		// calls function(begin, end) for chunks of at most grainSize indices out of [0, count) and returns once all of them are done
+		static void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& function);
+	};
+
+}
@@ -0,0 +1,89 @@
+#include "cvpch.h"
+#include "MappedFile.h"
+
+#include "Base.h"
+
+#ifdef CV_PLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace cv {
+
+#ifdef CV_PLATFORM_WINDOWS
+	MappedFile::MappedFile(const std::filesystem::path& path)
+	{
+		HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return;
+
+		LARGE_INTEGER size{};
+		GetFileSizeEx(file, &size);
+		m_Size = (size_t)size.QuadPart;
+		m_Open = true;
+
+		// the view keeps the file and the mapping alive on its own
+		if (m_Size > 0)
+		{
+			HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping)
+			{
+				m_Data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				CloseHandle(mapping);
+			}
+
+			if (!m_Data)
+			{
+				m_Size = 0;
+				m_Open = false;
+			}
+		}
+
+		CloseHandle(file);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (m_Data)
+			UnmapViewOfFile(m_Data);
+	}
+#else
+	MappedFile::MappedFile(const std::filesystem::path& path)
+	{
+		int file = open(path.c_str(), O_RDONLY);
+		if (file == -1)
+			return;
+
+		struct stat status{};
+		fstat(file, &status);
+		m_Size = (size_t)status.st_size;
+		m_Open = true;
+
+		// the mapping keeps the file alive on its own
+		if (m_Size > 0)
+		{
+			void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+			if (data == MAP_FAILED)
+			{
+				m_Size = 0;
+				m_Open = false;
+			}
+			else
+				m_Data = (const uint8_t*)data;
+		}
+
+		close(file);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (m_Data)
+			munmap((void*)m_Data, m_Size);
+	}
+#endif
+
+}
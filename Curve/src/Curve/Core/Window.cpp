@@ -20,15 +20,20 @@ namespace cv {
 		CV_ERROR("GLFW Error (", error, "): ", description);
 	}
 
-	Window::Window(const std::string& title, uint32_t width, uint32_t height)
+	Window::Window(const std::string& title, uint32_t width, uint32_t height, bool headless)
 	{
 		m_Data = {};
 		m_Data.Title = title;
 		m_Data.Width = width;
 		m_Data.Height = height;
+		m_Data.Headless = headless;
 
 		if (s_GLFWWindowCount == 0)
 		{
+			// the null platform gives us a window handle, input and timers without a display server
+			if (headless)
+				glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+
 			CV_ASSERT(glfwInit() && "Failed to initialize GLFW!");
 			glfwSetErrorCallback(GLFWErrorCallback);
 		}
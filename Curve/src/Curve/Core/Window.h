@@ -21,7 +21,7 @@ namespace cv {
 	class Window
 	{
 	public:
-		Window(const std::string& title, uint32_t width, uint32_t height);
+		Window(const std::string& title, uint32_t width, uint32_t height, bool headless = false);
 		~Window();
 
 		void SetEventCallback(std::function<void(Event&)>&& callback) { m_Data.EventCallback = callback; }
@@ -35,6 +35,7 @@ namespace cv {
 		void Restore() const;
 		
 		bool IsMaximized() const;
+		bool IsHeadless() const { return m_Data.Headless; }
 
 		uint32_t GetWidth() const { return m_Data.Width; }
 		uint32_t GetHeight() const { return m_Data.Height; }
@@ -57,6 +58,7 @@ namespace cv {
 			uint32_t Width, Height;
 
 			bool FramebufferResized = false;
+			bool Headless = false;
 
 			std::function<void(Event&)> EventCallback = nullptr;
 		};
@@ -0,0 +1,80 @@
+#include "cvpch.h"
+#include "Expression.h"
+
+#include "ExpressionParser.h"
+#include "ExpressionVM.h"
+
+namespace cv {
+
+	Expression::Expression(const std::string& source, const std::vector<std::string>& variables)
+		: m_Source(source), m_Variables(variables)
+	{
+		ExpressionParser parser(m_Source, m_Variables);
+		std::shared_ptr<ExpressionNode> root = parser.Parse();
+		if (!root)
+		{
+			m_Error = parser.GetError();
+			return;
+		}
+
+		if (!ExpressionCompiler::Compile(root.get(), (uint32_t)m_Variables.size(), m_Program, m_Error))
+			return;
+
+		m_Root = root;
+	}
+
+	float Expression::Evaluate(float x) const
+	{
+		return Evaluate(&x);
+	}
+
+	float Expression::Evaluate(const float* variables) const
+	{
+		CV_ASSERT(IsValid() && "Evaluating an invalid expression!");
+
+		const float* inputs[ExpressionCompiler::MaxRegisters];
+		for (size_t i = 0; i < m_Variables.size(); i++)
+			inputs[i] = variables + i;
+
+		float y = 0.0f;
+		ExpressionVM::Execute(m_Program, inputs, &y, 1);
+		return y;
+	}
+
+	void Expression::Evaluate(const float* x, float* y, size_t count) const
+	{
+		CV_ASSERT(m_Variables.size() == 1 && "Expression has more than one variable!");
+		Evaluate(&x, y, count);
+	}
+
+	void Expression::Evaluate(const float* const* variables, float* y, size_t count) const
+	{
+		CV_ASSERT(IsValid() && "Evaluating an invalid expression!");
+		ExpressionVM::Execute(m_Program, variables, y, count);
+	}
+
+	void Expression::Evaluate(const double* x, double* y, size_t count) const
+	{
+		CV_ASSERT(m_Variables.size() == 1 && "Expression has more than one variable!");
+		Evaluate(&x, y, count);
+	}
+
+	void Expression::Evaluate(const double* const* variables, double* y, size_t count) const
+	{
+		CV_ASSERT(IsValid() && "Evaluating an invalid expression!");
+		ExpressionVM::Execute(m_Program, variables, y, count);
+	}
+
+	Interval Expression::Evaluate(const Interval& x) const
+	{
+		CV_ASSERT(m_Variables.size() == 1 && "Expression has more than one variable!");
+		return Evaluate(&x);
+	}
+
+	Interval Expression::Evaluate(const Interval* variables) const
+	{
+		CV_ASSERT(IsValid() && "Evaluating an invalid expression!");
+		return ExpressionInterval::Execute(m_Program, variables);
+	}
+
+}
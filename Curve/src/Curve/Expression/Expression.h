@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Curve/Core/Base.h"
+
+#include "ExpressionAST.h"
+#include "ExpressionCompiler.h"
+#include "ExpressionInterval.h"
+
+#include <string>
+#include <vector>
+
+namespace cv {
+
+	// a formula typed at runtime, compiled once to bytecode and evaluated over whole arrays of samples
+	class Expression
+	{
+	public:
+		Expression() = default;
+		Expression(const std::string& source, const std::vector<std::string>& variables = { "x" });
+
+		bool IsValid() const { return m_Root != nullptr; }
+		const std::string& GetError() const { return m_Error; }
+
+		const std::string& GetSource() const { return m_Source; }
+		const std::vector<std::string>& GetVariables() const { return m_Variables; }
+
+		float Evaluate(float x) const;
+		float Evaluate(const float* variables) const;
+
+		void Evaluate(const float* x, float* y, size_t count) const;
+		void Evaluate(const float* const* variables, float* y, size_t count) const;
+
+		// constants stay the floats they were parsed as, only the arithmetic is done in double
+		void Evaluate(const double* x, double* y, size_t count) const;
+		void Evaluate(const double* const* variables, double* y, size_t count) const;
+
+		// bounds the expression over a range of inputs, see ExpressionInterval
+		Interval Evaluate(const Interval& x) const;
+		Interval Evaluate(const Interval* variables) const;
+
+		const ExpressionNode* GetRoot() const { return m_Root.get(); }
+		const ExpressionProgram& GetProgram() const { return m_Program; }
+	private:
+		std::string m_Source;
+		std::vector<std::string> m_Variables;
+		std::string m_Error;
+
+		std::shared_ptr<ExpressionNode> m_Root;
+		ExpressionProgram m_Program;
+	};
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cmath>
+#include <memory>
+#include <cstdint>
+
+namespace cv {
+
+	enum class ExpressionOp : uint8_t
+	{
+		Constant = 0, Variable,
+
+		// binary
+		Add, Subtract, Multiply, Divide, Power, Modulo, Min, Max, Atan2,
+
+		// unary
+		Negate, Abs, Sign, Floor, Ceil, Sqrt, Exp, Log, Log10,
+		Sin, Cos, Tan, Asin, Acos, Atan, Sinh, Cosh, Tanh
+	};
+
+	struct ExpressionNode
+	{
+		ExpressionOp Op = ExpressionOp::Constant;
+		float Value = 0.0f; // only for constants
+		uint32_t Variable = 0; // only for variables
+		std::shared_ptr<ExpressionNode> Operands[2];
+	};
+
+	inline uint32_t GetExpressionOpOperandCount(ExpressionOp op)
+	{
+		if (op <= ExpressionOp::Variable)
+			return 0;
+		if (op <= ExpressionOp::Atan2)
+			return 2;
+		return 1;
+	}
+
+	inline bool IsExpressionOpCommutative(ExpressionOp op)
+	{
+		return op == ExpressionOp::Add || op == ExpressionOp::Multiply || op == ExpressionOp::Min || op == ExpressionOp::Max;
+	}
+
+	inline float EvaluateExpressionOp(ExpressionOp op, float a, float b = 0.0f)
+	{
+		switch (op)
+		{
+			case ExpressionOp::Add:      return a + b;
+			case ExpressionOp::Subtract: return a - b;
+			case ExpressionOp::Multiply: return a * b;
+			case ExpressionOp::Divide:   return a / b;
+			case ExpressionOp::Power:    return std::pow(a, b);
+			case ExpressionOp::Modulo:   return a - b * std::floor(a / b);
+			case ExpressionOp::Min:      return std::fmin(a, b);
+			case ExpressionOp::Max:      return std::fmax(a, b);
+			case ExpressionOp::Atan2:    return std::atan2(a, b);
+			case ExpressionOp::Negate:   return -a;
+			case ExpressionOp::Abs:      return std::abs(a);
+			case ExpressionOp::Sign:     return (float)((a > 0.0f) - (a < 0.0f));
+			case ExpressionOp::Floor:    return std::floor(a);
+			case ExpressionOp::Ceil:     return std::ceil(a);
+			case ExpressionOp::Sqrt:     return std::sqrt(a);
+			case ExpressionOp::Exp:      return std::exp(a);
+			case ExpressionOp::Log:      return std::log(a);
+			case ExpressionOp::Log10:    return std::log10(a);
+			case ExpressionOp::Sin:      return std::sin(a);
+			case ExpressionOp::Cos:      return std::cos(a);
+			case ExpressionOp::Tan:      return std::tan(a);
+			case ExpressionOp::Asin:     return std::asin(a);
+			case ExpressionOp::Acos:     return std::acos(a);
+			case ExpressionOp::Atan:     return std::atan(a);
+			case ExpressionOp::Sinh:     return std::sinh(a);
+			case ExpressionOp::Cosh:     return std::cosh(a);
+			case ExpressionOp::Tanh:     return std::tanh(a);
+			default:                     break;
+		}
+
+		return 0.0f;
+	}
+
+}
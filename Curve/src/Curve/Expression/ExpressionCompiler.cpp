@@ -0,0 +1,149 @@
+#include "cvpch.h"
+#include "ExpressionCompiler.h"
+
+#include <map>
+#include <tuple>
+#include <bit>
+
+namespace cv {
+
+	namespace Utils {
+
+		struct ExpressionValue
+		{
+			ExpressionOp Op;
+			uint32_t A = 0, B = 0; // value indices for ops, bits of the constant or variable index otherwise
+		};
+
+		class ExpressionValueBuilder
+		{
+		public:
+			std::vector<ExpressionValue> Values;
+
+			uint32_t Emit(const ExpressionNode* node)
+			{
+				ExpressionValue value{ node->Op };
+
+				switch (GetExpressionOpOperandCount(node->Op))
+				{
+					case 0:
+						value.A = node->Op == ExpressionOp::Constant ? std::bit_cast<uint32_t>(node->Value) : node->Variable;
+						break;
+					case 1:
+						value.A = Emit(node->Operands[0].get());
+						break;
+					case 2:
+						value.A = Emit(node->Operands[0].get());
+						value.B = Emit(node->Operands[1].get());
+						if (IsExpressionOpCommutative(node->Op) && value.A > value.B)
+							std::swap(value.A, value.B);
+						break;
+				}
+
+				auto key = std::make_tuple(value.Op, value.A, value.B);
+				auto it = m_Lookup.find(key);
+				if (it != m_Lookup.end())
+					return it->second;
+
+				uint32_t index = (uint32_t)Values.size();
+				Values.push_back(value);
+				m_Lookup[key] = index;
+				return index;
+			}
+		private:
+			std::map<std::tuple<ExpressionOp, uint32_t, uint32_t>, uint32_t> m_Lookup;
+		};
+
+	}
+
+	bool ExpressionCompiler::Compile(const ExpressionNode* root, uint32_t variableCount, ExpressionProgram& program, std::string& error)
+	{
+		program = {};
+		program.VariableCount = variableCount;
+
+		Utils::ExpressionValueBuilder builder;
+		uint32_t rootValue = builder.Emit(root);
+		const auto& values = builder.Values;
+
+		constexpr uint32_t unassigned = ~0u;
+		std::vector<uint32_t> registers(values.size(), unassigned);
+
+		for (uint32_t i = 0; i < values.size(); i++)
+		{
+			if (values[i].Op != ExpressionOp::Constant)
+				continue;
+
+			registers[i] = variableCount + (uint32_t)program.Constants.size();
+			program.Constants.push_back(std::bit_cast<float>(values[i].A));
+		}
+
+		// values are in dependency order, so the last user of a value is the last point it has to stay alive
+		std::vector<uint32_t> lastUse(values.size(), 0);
+		for (uint32_t i = 0; i < values.size(); i++)
+		{
+			uint32_t operandCount = GetExpressionOpOperandCount(values[i].Op);
+			if (operandCount >= 1)
+				lastUse[values[i].A] = i;
+			if (operandCount == 2)
+				lastUse[values[i].B] = i;
+		}
+		lastUse[rootValue] = (uint32_t)values.size();
+
+		uint32_t firstTemporary = program.GetFirstTemporary();
+		uint32_t registerCount = firstTemporary;
+		std::vector<uint32_t> freeRegisters;
+
+		for (uint32_t i = 0; i < values.size(); i++)
+		{
+			const Utils::ExpressionValue& value = values[i];
+
+			if (value.Op == ExpressionOp::Constant)
+				continue;
+
+			if (value.Op == ExpressionOp::Variable)
+			{
+				registers[i] = value.A;
+				continue;
+			}
+
+			uint32_t operandCount = GetExpressionOpOperandCount(value.Op);
+			uint32_t a = registers[value.A];
+			uint32_t b = operandCount == 2 ? registers[value.B] : 0;
+
+			uint32_t destination;
+			if (!freeRegisters.empty())
+			{
+				destination = freeRegisters.back();
+				freeRegisters.pop_back();
+			}
+			else
+				destination = registerCount++;
+
+			if (registerCount > MaxRegisters)
+			{
+				error = "Expression is too complex";
+				return false;
+			}
+
+			// operands are only released after the destination is picked, so an instruction never writes over its own inputs
+			if (a >= firstTemporary && lastUse[value.A] == i)
+				freeRegisters.push_back(a);
+			if (operandCount == 2 && value.B != value.A && b >= firstTemporary && lastUse[value.B] == i)
+				freeRegisters.push_back(b);
+
+			registers[i] = destination;
+			program.Instructions.push_back({ value.Op, (uint8_t)destination, (uint8_t)a, (uint8_t)b });
+		}
+
+		if (registerCount > MaxRegisters)
+		{
+			error = "Expression is too complex";
+			return false;
+		}
+
+		program.RegisterCount = registerCount;
+		program.Result = (uint8_t)registers[rootValue];
+		return true;
+	}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ExpressionAST.h"
+
+#include <string>
+#include <vector>
+
+namespace cv {
+
+	struct ExpressionInstruction
+	{
+		ExpressionOp Op;
+		uint8_t Destination;
+		uint8_t A;
+		uint8_t B;
+	};
+
+	// registers are laid out as [variables][constants][temporaries]
+	struct ExpressionProgram
+	{
+		std::vector<ExpressionInstruction> Instructions;
+		std::vector<float> Constants;
+
+		uint32_t VariableCount = 0;
+		uint32_t RegisterCount = 0;
+		uint8_t Result = 0;
+
+		uint32_t GetFirstTemporary() const { return VariableCount + (uint32_t)Constants.size(); }
+	};
+
+	class ExpressionCompiler
+	{
+	public:
+		static constexpr uint32_t MaxRegisters = 256;
+
+		// merges common subexpressions and assigns registers by liveness, so temporaries are reused as soon as possible
+		static bool Compile(const ExpressionNode* root, uint32_t variableCount, ExpressionProgram& program, std::string& error);
+	};
+
+}
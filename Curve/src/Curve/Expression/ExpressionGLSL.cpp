@@ -0,0 +1,116 @@
+#include "cvpch.h"
+#include "ExpressionGLSL.h"
+
+#include <bit>
+#include <iomanip>
+
+namespace cv {
+
+	namespace Utils {
+
+		static std::string GetGLSLConstant(float value)
+		{
+			// folded constants can be inf or nan, which have no literal in GLSL
+			if (!std::isfinite(value))
+				return "uintBitsToFloat(" + std::to_string(std::bit_cast<uint32_t>(value)) + "u)";
+
+			std::ostringstream oss;
+			oss.imbue(std::locale::classic());
+			oss << std::setprecision(9) << value;
+
+			std::string result = oss.str();
+			if (result.find_first_of(".e") == std::string::npos)
+				result += ".0";
+
+			// keeps "-" + constant from turning into a decrement
+			return value < 0.0f ? "(" + result + ")" : result;
+		}
+
+		static std::string GetGLSLOperation(ExpressionOp op, const std::string& a, const std::string& b)
+		{
+			switch (op)
+			{
+				case ExpressionOp::Add:      return a + " + " + b;
+				case ExpressionOp::Subtract: return a + " - " + b;
+				case ExpressionOp::Multiply: return a + " * " + b;
+				case ExpressionOp::Divide:   return a + " / " + b;
+				case ExpressionOp::Power:    return "cv_pow(" + a + ", " + b + ")";
+				case ExpressionOp::Modulo:   return "mod(" + a + ", " + b + ")";
+				case ExpressionOp::Min:      return "min(" + a + ", " + b + ")";
+				case ExpressionOp::Max:      return "max(" + a + ", " + b + ")";
+				case ExpressionOp::Atan2:    return "atan(" + a + ", " + b + ")";
+				case ExpressionOp::Negate:   return "-" + a;
+				case ExpressionOp::Abs:      return "abs(" + a + ")";
+				case ExpressionOp::Sign:     return "sign(" + a + ")";
+				case ExpressionOp::Floor:    return "floor(" + a + ")";
+				case ExpressionOp::Ceil:     return "ceil(" + a + ")";
+				case ExpressionOp::Sqrt:     return "sqrt(" + a + ")";
+				case ExpressionOp::Exp:      return "exp(" + a + ")";
+				case ExpressionOp::Log:      return "log(" + a + ")";
+				case ExpressionOp::Log10:    return "log(" + a + ") * 0.434294482";
+				case ExpressionOp::Sin:      return "sin(" + a + ")";
+				case ExpressionOp::Cos:      return "cos(" + a + ")";
+				case ExpressionOp::Tan:      return "tan(" + a + ")";
+				case ExpressionOp::Asin:     return "asin(" + a + ")";
+				case ExpressionOp::Acos:     return "acos(" + a + ")";
+				case ExpressionOp::Atan:     return "atan(" + a + ")";
+				case ExpressionOp::Sinh:     return "sinh(" + a + ")";
+				case ExpressionOp::Cosh:     return "cosh(" + a + ")";
+				case ExpressionOp::Tanh:     return "tanh(" + a + ")";
+				default:                     break;
+			}
+
+			CV_ASSERT(false && "Unknown expression op!");
+			return "0.0";
+		}
+
+	}
+
+	std::string ExpressionGLSL::GetPrelude()
+	{
+		// GLSL leaves pow undefined for negative bases, the CPU side follows std::pow
+		return
+			"float cv_pow(float a, float b)\n"
+			"{\n"
+			"\tif (a >= 0.0 || b != floor(b))\n"
+			"\t\treturn pow(a, b);\n"
+			"\tfloat result = pow(-a, b);\n"
+			"\treturn mod(b, 2.0) == 0.0 ? result : -result;\n"
+			"}\n";
+	}
+
+	std::string ExpressionGLSL::GenerateFunction(const Expression& expression, const std::string& name)
+	{
+		CV_ASSERT(expression.IsValid() && "Generating GLSL for an invalid expression!");
+
+		const ExpressionProgram& program = expression.GetProgram();
+		const std::vector<std::string>& variables = expression.GetVariables();
+
+		// every register holds the name of whatever value currently lives in it
+		std::vector<std::string> registers(program.RegisterCount);
+		for (uint32_t i = 0; i < program.VariableCount; i++)
+			registers[i] = "v_" + variables[i];
+		for (size_t i = 0; i < program.Constants.size(); i++)
+			registers[program.VariableCount + i] = Utils::GetGLSLConstant(program.Constants[i]);
+
+		std::ostringstream oss;
+		oss << "float " << name << "(";
+		for (uint32_t i = 0; i < program.VariableCount; i++)
+			oss << (i ? ", " : "") << "float " << registers[i];
+		oss << ")\n{\n";
+
+		for (size_t i = 0; i < program.Instructions.size(); i++)
+		{
+			const ExpressionInstruction& instruction = program.Instructions[i];
+
+			std::string value = "t" + std::to_string(i);
+			oss << "\tfloat " << value << " = " << Utils::GetGLSLOperation(instruction.Op, registers[instruction.A], registers[instruction.B]) << ";\n";
+
+			registers[instruction.Destination] = value;
+		}
+
+		oss << "\treturn " << registers[program.Result] << ";\n}\n";
+		return oss.str();
+	}
+
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Expression.h"
+
+#include <string>
+
+namespace cv {
+
+	class ExpressionGLSL
+	{
+	public:
+		// helper functions the generated code depends on, has to be emitted once before any generated function
+		static std::string GetPrelude();
+
+		// emits "float <name>(float <variables>...)" from the compiled program, so folding and CSE carry over to the shader
+		static std::string GenerateFunction(const Expression& expression, const std::string& name);
+	};
+
+}
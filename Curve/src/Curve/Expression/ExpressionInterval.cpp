@@ -0,0 +1,295 @@
+#include "cvpch.h"
+#include "ExpressionInterval.h"
+
+#include "Curve/Core/Base.h"
+
+namespace cv {
+
+	namespace Utils {
+
+		static constexpr float s_Infinity = std::numeric_limits<float>::infinity();
+		static constexpr double s_Pi = 3.14159265358979323846;
+
+		// the vector kernels in ExpressionSIMD are a few ulps off libm, the bounds have to hold for the values they return as well
+		static constexpr int s_FunctionUlps = 4;
+
+		static Interval Entire()
+		{
+			Interval result(-s_Infinity, s_Infinity);
+			result.Continuous = false;
+			return result;
+		}
+
+		static Interval EmptyInterval()
+		{
+			Interval result(0.0f, 0.0f);
+			result.Continuous = false;
+			result.Empty = true;
+			return result;
+		}
+
+		// widens by at least ulps units in the last place, cheaper than stepping with nextafter
+		static float Widen(float value, int ulps, float direction)
+		{
+			if (!std::isfinite(value))
+				return value;
+			return value + direction * (std::abs(value) * (float)(ulps + 1) * std::numeric_limits<float>::epsilon() + std::numeric_limits<float>::min());
+		}
+
+		// every float operation rounds, the functions may be off by a little more than that
+		static Interval Round(Interval result, int ulps, bool continuous)
+		{
+			if (std::isnan(result.Min) || std::isnan(result.Max))
+				return Entire();
+
+			if (ulps)
+			{
+				result.Min = Widen(result.Min, ulps, -1.0f);
+				result.Max = Widen(result.Max, ulps, 1.0f);
+			}
+
+			result.Continuous = continuous && std::isfinite(result.Min) && std::isfinite(result.Max);
+			return result;
+		}
+
+		static Interval Hull(float a, float b, float c, float d)
+		{
+			return { std::min(std::min(a, b), std::min(c, d)), std::max(std::max(a, b), std::max(c, d)) };
+		}
+
+		static bool Contains(const Interval& a, float value)
+		{
+			return a.Min <= value && value <= a.Max;
+		}
+
+		template<typename Func>
+		static Interval Increasing(const Interval& a, bool continuous, Func func)
+		{
+			return Round({ func(a.Min), func(a.Max) }, s_FunctionUlps, continuous);
+		}
+
+		static Interval Add(const Interval& a, const Interval& b)
+		{
+			return Round({ a.Min + b.Min, a.Max + b.Max }, 1, a.Continuous && b.Continuous);
+		}
+
+		static Interval Subtract(const Interval& a, const Interval& b)
+		{
+			return Round({ a.Min - b.Max, a.Max - b.Min }, 1, a.Continuous && b.Continuous);
+		}
+
+		static Interval Multiply(const Interval& a, const Interval& b)
+		{
+			return Round(Hull(a.Min * b.Min, a.Min * b.Max, a.Max * b.Min, a.Max * b.Max), 1, a.Continuous && b.Continuous);
+		}
+
+		// x * x never goes negative, which multiplying the interval by itself can't know
+		static Interval Square(const Interval& a)
+		{
+			float min = a.Min * a.Min, max = a.Max * a.Max;
+			if (Contains(a, 0.0f))
+				return Round({ 0.0f, std::max(min, max) }, 1, a.Continuous);
+			return Round({ std::min(min, max), std::max(min, max) }, 1, a.Continuous);
+		}
+
+		static Interval Divide(const Interval& a, const Interval& b)
+		{
+			if (Contains(b, 0.0f))
+				return b.Min == 0.0f && b.Max == 0.0f ? EmptyInterval() : Entire();
+
+			return Round(Hull(a.Min / b.Min, a.Min / b.Max, a.Max / b.Min, a.Max / b.Max), 1, a.Continuous && b.Continuous);
+		}
+
+		static Interval Floor(const Interval& a)
+		{
+			float min = std::floor(a.Min), max = std::floor(a.Max);
+			return Round({ min, max }, 0, a.Continuous && min == max);
+		}
+
+		static Interval Power(const Interval& a, const Interval& b)
+		{
+			bool continuous = a.Continuous && b.Continuous;
+
+			// constant integer exponents, the only ones defined for negative bases
+			if (b.Min == b.Max && std::floor(b.Min) == b.Min && std::abs(b.Min) < 16777216.0f)
+			{
+				int64_t n = (int64_t)b.Min;
+				if (n == 0)
+					return Round({ 1.0f, 1.0f }, 0, a.Continuous);
+
+				float min = std::pow(a.Min, b.Min), max = std::pow(a.Max, b.Min);
+				if (n < 0 && Contains(a, 0.0f))
+					return a.Min == 0.0f && a.Max == 0.0f ? EmptyInterval() : Entire();
+				if (n % 2 == 0 && Contains(a, 0.0f))
+					return Round({ 0.0f, std::max(min, max) }, s_FunctionUlps, continuous);
+
+				return Round({ std::min(min, max), std::max(min, max) }, s_FunctionUlps, continuous);
+			}
+
+			// a positive base is monotonic in both the base and the exponent, so the corners bound it
+			if (a.Min > 0.0f || (a.Min == 0.0f && b.Min > 0.0f))
+				return Round(Hull(std::pow(a.Min, b.Min), std::pow(a.Min, b.Max), std::pow(a.Max, b.Min), std::pow(a.Max, b.Max)), s_FunctionUlps, continuous);
+
+			return a.Max < 0.0f && b.Min == b.Max ? EmptyInterval() : Entire();
+		}
+
+		static Interval Atan2(const Interval& a, const Interval& b)
+		{
+			// away from the branch cut along the negative x axis atan2 is monotonic in both arguments
+			if (b.Min > 0.0f || a.Min > 0.0f || a.Max < 0.0f)
+				return Round(Hull(std::atan2(a.Min, b.Min), std::atan2(a.Min, b.Max), std::atan2(a.Max, b.Min), std::atan2(a.Max, b.Max)), s_FunctionUlps, a.Continuous && b.Continuous);
+
+			return Round({ (float)-s_Pi, (float)s_Pi }, 1, false);
+		}
+
+		// the extrema of sin sit at pi/2 + k * pi, phase shifts the argument so cos can share it
+		static Interval Sin(const Interval& a, double phase)
+		{
+			double min = (double)a.Min + phase, max = (double)a.Max + phase;
+			if (!std::isfinite(min) || !std::isfinite(max) || max - min >= 2.0 * s_Pi)
+				return Round({ -1.0f, 1.0f }, 0, a.Continuous);
+
+			float sinMin = (float)std::sin(min), sinMax = (float)std::sin(max);
+			Interval result(std::min(sinMin, sinMax), std::max(sinMin, sinMax));
+
+			if (std::floor((min - 0.5 * s_Pi) / (2.0 * s_Pi)) != std::floor((max - 0.5 * s_Pi) / (2.0 * s_Pi)))
+				result.Max = 1.0f;
+			if (std::floor((min + 0.5 * s_Pi) / (2.0 * s_Pi)) != std::floor((max + 0.5 * s_Pi) / (2.0 * s_Pi)))
+				result.Min = -1.0f;
+
+			result = Round(result, s_FunctionUlps, a.Continuous);
+			result.Min = std::max(result.Min, -1.0f);
+			result.Max = std::min(result.Max, 1.0f);
+			return result;
+		}
+
+		static Interval Tan(const Interval& a)
+		{
+			double min = (double)a.Min, max = (double)a.Max;
+			if (!std::isfinite(min) || !std::isfinite(max) || max - min >= s_Pi)
+				return Entire();
+
+			// the poles sit at pi/2 + k * pi
+			if (std::floor((min - 0.5 * s_Pi) / s_Pi) != std::floor((max - 0.5 * s_Pi) / s_Pi))
+				return Entire();
+
+			return Round({ std::tan(a.Min), std::tan(a.Max) }, s_FunctionUlps, a.Continuous);
+		}
+
+		// clamps a to [min, max], the part outside of it has no value
+		static bool Restrict(Interval& a, float min, float max, bool includeMin)
+		{
+			if (a.Max < min || (!includeMin && a.Max == min) || a.Min > max)
+				return false;
+
+			if (a.Min < min || (!includeMin && a.Min == min) || a.Max > max)
+				a.Continuous = false;
+
+			a.Min = std::max(a.Min, min);
+			a.Max = std::min(a.Max, max);
+			return true;
+		}
+
+		static Interval Execute(ExpressionOp op, Interval a, const Interval& b, bool sameOperands)
+		{
+			if (a.Empty || b.Empty)
+				return EmptyInterval();
+
+			switch (op)
+			{
+				case ExpressionOp::Add:      return Add(a, b);
+				case ExpressionOp::Subtract: return Subtract(a, b);
+				case ExpressionOp::Multiply: return sameOperands ? Square(a) : Multiply(a, b);
+				case ExpressionOp::Divide:   return Divide(a, b);
+				case ExpressionOp::Power:    return Power(a, b);
+				case ExpressionOp::Modulo:   return Subtract(a, Multiply(b, Floor(Divide(a, b))));
+				case ExpressionOp::Min:      return Round({ std::min(a.Min, b.Min), std::min(a.Max, b.Max) }, 0, a.Continuous && b.Continuous);
+				case ExpressionOp::Max:      return Round({ std::max(a.Min, b.Min), std::max(a.Max, b.Max) }, 0, a.Continuous && b.Continuous);
+				case ExpressionOp::Atan2:    return Atan2(a, b);
+				case ExpressionOp::Negate:   return Round({ -a.Max, -a.Min }, 0, a.Continuous);
+				case ExpressionOp::Abs:
+				{
+					float min = std::abs(a.Min), max = std::abs(a.Max);
+					return Round({ Contains(a, 0.0f) ? 0.0f : std::min(min, max), std::max(min, max) }, 0, a.Continuous);
+				}
+				case ExpressionOp::Sign:
+				{
+					float min = (float)((a.Min > 0.0f) - (a.Min < 0.0f)), max = (float)((a.Max > 0.0f) - (a.Max < 0.0f));
+					return Round({ min, max }, 0, a.Continuous && min == max);
+				}
+				case ExpressionOp::Floor:    return Floor(a);
+				case ExpressionOp::Ceil:
+				{
+					float min = std::ceil(a.Min), max = std::ceil(a.Max);
+					return Round({ min, max }, 0, a.Continuous && min == max);
+				}
+				case ExpressionOp::Sqrt:
+				{
+					if (!Restrict(a, 0.0f, s_Infinity, true))
+						return EmptyInterval();
+					return Increasing(a, a.Continuous, [](float v) { return std::sqrt(v); });
+				}
+				case ExpressionOp::Exp:      return Increasing(a, a.Continuous, [](float v) { return std::exp(v); });
+				case ExpressionOp::Log:
+				{
+					if (!Restrict(a, 0.0f, s_Infinity, false))
+						return EmptyInterval();
+					return Increasing(a, a.Continuous, [](float v) { return std::log(v); });
+				}
+				case ExpressionOp::Log10:
+				{
+					if (!Restrict(a, 0.0f, s_Infinity, false))
+						return EmptyInterval();
+					return Increasing(a, a.Continuous, [](float v) { return std::log10(v); });
+				}
+				case ExpressionOp::Sin:      return Sin(a, 0.0);
+				case ExpressionOp::Cos:      return Sin(a, 0.5 * s_Pi);
+				case ExpressionOp::Tan:      return Tan(a);
+				case ExpressionOp::Asin:
+				{
+					if (!Restrict(a, -1.0f, 1.0f, true))
+						return EmptyInterval();
+					return Increasing(a, a.Continuous, [](float v) { return std::asin(v); });
+				}
+				case ExpressionOp::Acos:
+				{
+					if (!Restrict(a, -1.0f, 1.0f, true))
+						return EmptyInterval();
+					return Round({ std::acos(a.Max), std::acos(a.Min) }, s_FunctionUlps, a.Continuous);
+				}
+				case ExpressionOp::Atan:     return Increasing(a, a.Continuous, [](float v) { return std::atan(v); });
+				case ExpressionOp::Sinh:     return Increasing(a, a.Continuous, [](float v) { return std::sinh(v); });
+				case ExpressionOp::Cosh:
+				{
+					float min = std::cosh(a.Min), max = std::cosh(a.Max);
+					return Round({ Contains(a, 0.0f) ? 1.0f : std::min(min, max), std::max(min, max) }, s_FunctionUlps, a.Continuous);
+				}
+				case ExpressionOp::Tanh:     return Increasing(a, a.Continuous, [](float v) { return std::tanh(v); });
+				default:
+					CV_ASSERT(false && "Invalid expression instruction!");
+					break;
+			}
+
+			return Entire();
+		}
+
+	}
+
+	Interval ExpressionInterval::Execute(const ExpressionProgram& program, const Interval* variables)
+	{
+		// sized to the program, clearing all MaxRegisters intervals would cost more than most programs take to run
+		thread_local std::vector<Interval> registers;
+		registers.resize(program.RegisterCount);
+
+		for (uint32_t i = 0; i < program.VariableCount; i++)
+			registers[i] = variables[i];
+		for (size_t i = 0; i < program.Constants.size(); i++)
+			registers[program.VariableCount + i] = Interval(program.Constants[i]);
+
+		for (const ExpressionInstruction& instruction : program.Instructions)
+			registers[instruction.Destination] = Utils::Execute(instruction.Op, registers[instruction.A], registers[instruction.B], instruction.A == instruction.B);
+
+		return registers[program.Result];
+	}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "ExpressionCompiler.h"
+
+namespace cv {
+
+	// bounds every value an expression takes while its inputs range over other intervals
+	struct Interval
+	{
+		float Min = 0.0f, Max = 0.0f;
+
+		// proven finite and continuous over the whole input range, false only means it couldn't be proven
+		bool Continuous = true;
+
+		// no input in the range gives a defined value
+		bool Empty = false;
+
+		Interval() = default;
+		explicit Interval(float value)
+			: Min(value), Max(value) {}
+		Interval(float min, float max)
+			: Min(min), Max(max) {}
+	};
+
+	class ExpressionInterval
+	{
+	public:
+		// runs the program on intervals instead of values, the bounds are rounded outwards so they always hold
+		// jumps (floor, sign, mod), poles (division by an interval containing 0, tan) and domain edges (sqrt, log) clear Continuous
+		static Interval Execute(const ExpressionProgram& program, const Interval* variables);
+	};
+
+}
@@ -0,0 +1,352 @@
+#include "cvpch.h"
+#include "ExpressionParser.h"
+
+namespace cv {
+
+	namespace Utils {
+
+		struct ExpressionFunction
+		{
+			const char* Name;
+			ExpressionOp Op;
+		};
+
+		static constexpr ExpressionFunction s_Functions[] = {
+			{ "abs",   ExpressionOp::Abs },
+			{ "sign",  ExpressionOp::Sign },
+			{ "floor", ExpressionOp::Floor },
+			{ "ceil",  ExpressionOp::Ceil },
+			{ "sqrt",  ExpressionOp::Sqrt },
+			{ "exp",   ExpressionOp::Exp },
+			{ "ln",    ExpressionOp::Log },
+			{ "log",   ExpressionOp::Log },
+			{ "log10", ExpressionOp::Log10 },
+			{ "sin",   ExpressionOp::Sin },
+			{ "cos",   ExpressionOp::Cos },
+			{ "tan",   ExpressionOp::Tan },
+			{ "asin",  ExpressionOp::Asin },
+			{ "acos",  ExpressionOp::Acos },
+			{ "atan",  ExpressionOp::Atan },
+			{ "sinh",  ExpressionOp::Sinh },
+			{ "cosh",  ExpressionOp::Cosh },
+			{ "tanh",  ExpressionOp::Tanh },
+			{ "pow",   ExpressionOp::Power },
+			{ "mod",   ExpressionOp::Modulo },
+			{ "min",   ExpressionOp::Min },
+			{ "max",   ExpressionOp::Max },
+			{ "atan2", ExpressionOp::Atan2 },
+		};
+
+		static bool IsConstant(const std::shared_ptr<ExpressionNode>& node, float value)
+		{
+			return node && node->Op == ExpressionOp::Constant && node->Value == value;
+		}
+
+		static bool IsIdentifierStart(char c)
+		{
+			return std::isalpha((unsigned char)c) || c == '_';
+		}
+
+		static bool IsIdentifierChar(char c)
+		{
+			return std::isalnum((unsigned char)c) || c == '_';
+		}
+
+	}
+
+	ExpressionParser::ExpressionParser(const std::string& source, const std::vector<std::string>& variables)
+		: m_Source(source), m_Variables(variables)
+	{
+	}
+
+	std::shared_ptr<ExpressionNode> ExpressionParser::Parse()
+	{
+		m_Position = 0;
+		m_Error.clear();
+
+		std::shared_ptr<ExpressionNode> root = ParseSum();
+		if (!root)
+			return nullptr;
+
+		SkipWhitespace();
+		if (m_Position < m_Source.size())
+			return Fail(std::string("Unexpected '") + m_Source[m_Position] + "'");
+
+		return root;
+	}
+
+	std::shared_ptr<ExpressionNode> ExpressionParser::MakeConstant(float value)
+	{
+		auto node = std::make_shared<ExpressionNode>();
+		node->Op = ExpressionOp::Constant;
+		node->Value = value;
+		return node;
+	}
+
+	std::shared_ptr<ExpressionNode> ExpressionParser::MakeVariable(uint32_t index)
+	{
+		auto node = std::make_shared<ExpressionNode>();
+		node->Op = ExpressionOp::Variable;
+		node->Variable = index;
+		return node;
+	}
+
+	std::shared_ptr<ExpressionNode> ExpressionParser::MakeNode(ExpressionOp op, std::shared_ptr<ExpressionNode> a, std::shared_ptr<ExpressionNode> b)
+	{
+		bool binary = GetExpressionOpOperandCount(op) == 2;
+
+		// constant folding
+		if (a->Op == ExpressionOp::Constant && (!binary || b->Op == ExpressionOp::Constant))
+			return MakeConstant(EvaluateExpressionOp(op, a->Value, binary ? b->Value : 0.0f));
+
+		// identities that hold for every finite and non-finite input, up to the sign of a zero result (x + 0 and 0 - x can
+		// give +0 where the folded node gives -0) and the rounding of a power turned into products
+		switch (op)
+		{
+			case ExpressionOp::Add:
+				if (Utils::IsConstant(a, 0.0f)) return b;
+				if (Utils::IsConstant(b, 0.0f)) return a;
+				break;
+			case ExpressionOp::Subtract:
+				if (Utils::IsConstant(b, 0.0f)) return a;
+				if (Utils::IsConstant(a, 0.0f)) return MakeNode(ExpressionOp::Negate, b);
+				break;
+			case ExpressionOp::Multiply:
+				if (Utils::IsConstant(a, 1.0f)) return b;
+				if (Utils::IsConstant(b, 1.0f)) return a;
+				if (Utils::IsConstant(a, -1.0f)) return MakeNode(ExpressionOp::Negate, b);
+				if (Utils::IsConstant(b, -1.0f)) return MakeNode(ExpressionOp::Negate, a);
+				break;
+			case ExpressionOp::Divide:
+				if (Utils::IsConstant(b, 1.0f)) return a;
+				break;
+			case ExpressionOp::Power:
+				// pow is by far the most expensive op, small integer powers are cheaper as products
+				if (Utils::IsConstant(b, 1.0f)) return a;
+				if (Utils::IsConstant(b, 2.0f)) return MakeNode(ExpressionOp::Multiply, a, a);
+				if (Utils::IsConstant(b, 3.0f)) return MakeNode(ExpressionOp::Multiply, MakeNode(ExpressionOp::Multiply, a, a), a);
+				// not exact either: sqrt gives -0 for -0 and NaN for -inf where pow gives +0 and +inf, neither ends up on a line
+				if (Utils::IsConstant(b, 0.5f)) return MakeNode(ExpressionOp::Sqrt, a);
+				if (Utils::IsConstant(b, -1.0f)) return MakeNode(ExpressionOp::Divide, MakeConstant(1.0f), a);
+				break;
+			case ExpressionOp::Negate:
+				if (a->Op == ExpressionOp::Negate) return a->Operands[0];
+				break;
+			default:
+				break;
+		}
+
+		auto node = std::make_shared<ExpressionNode>();
+		node->Op = op;
+		node->Operands[0] = a;
+		node->Operands[1] = b;
+		return node;
+	}
+
+	std::shared_ptr<ExpressionNode> ExpressionParser::ParseSum()
+	{
+		std::shared_ptr<ExpressionNode> left = ParseProduct();
+
+		while (left)
+		{
+			ExpressionOp op;
+			if (Match('+'))
+				op = ExpressionOp::Add;
+			else if (Match('-'))
+				op = ExpressionOp::Subtract;
+			else
+				break;
+
+			std::shared_ptr<ExpressionNode> right = ParseProduct();
+			if (!right)
+				return nullptr;
+
+			left = MakeNode(op, left, right);
+		}
+
+		return left;
+	}
+
+	std::shared_ptr<ExpressionNode> ExpressionParser::ParseProduct()
+	{
+		std::shared_ptr<ExpressionNode> left = ParseUnary();
+
+		while (left)
+		{
+			ExpressionOp op;
+			if (Match('*'))
+				op = ExpressionOp::Multiply;
+			else if (Match('/'))
+				op = ExpressionOp::Divide;
+			else if (Match('%'))
+				op = ExpressionOp::Modulo;
+			else if (StartsPrimary())
+				op = ExpressionOp::Multiply; // implicit, e.g. 2x or 3(x + 1)
+			else
+				break;
+
+			std::shared_ptr<ExpressionNode> right = ParseUnary();
+			if (!right)
+				return nullptr;
+
+			left = MakeNode(op, left, right);
+		}
+
+		return left;
+	}
+
+	std::shared_ptr<ExpressionNode> ExpressionParser::ParseUnary()
+	{
+		if (Match('-'))
+		{
+			std::shared_ptr<ExpressionNode> operand = ParseUnary();
+			return operand ? MakeNode(ExpressionOp::Negate, operand) : nullptr;
+		}
+
+		if (Match('+'))
+			return ParseUnary();
+
+		return ParsePower();
+	}
+
+	std::shared_ptr<ExpressionNode> ExpressionParser::ParsePower()
+	{
+		std::shared_ptr<ExpressionNode> base = ParsePrimary();
+		if (!base)
+			return nullptr;
+
+		if (Match('^'))
+		{
+			// right associative and binds tighter than unary minus on the left: -x^2 = -(x^2), 2^-x = 2^(-x)
+			std::shared_ptr<ExpressionNode> exponent = ParseUnary();
+			return exponent ? MakeNode(ExpressionOp::Power, base, exponent) : nullptr;
+		}
+
+		return base;
+	}
+
+	std::shared_ptr<ExpressionNode> ExpressionParser::ParsePrimary()
+	{
+		SkipWhitespace();
+
+		if (m_Position >= m_Source.size())
+			return Fail("Unexpected end of expression");
+
+		if (Match('('))
+		{
+			std::shared_ptr<ExpressionNode> inner = ParseSum();
+			if (!inner)
+				return nullptr;
+			if (!Match(')'))
+				return Fail("Expected ')'");
+			return inner;
+		}
+
+		char c = m_Source[m_Position];
+		if (std::isdigit((unsigned char)c) || c == '.')
+		{
+			const char* start = m_Source.c_str() + m_Position;
+			char* end = nullptr;
+			float value = std::strtof(start, &end);
+			if (end == start)
+				return Fail("Invalid number");
+
+			m_Position += end - start;
+			return MakeConstant(value);
+		}
+
+		if (Utils::IsIdentifierStart(c))
+			return ParseIdentifier();
+
+		return Fail(std::string("Unexpected '") + c + "'");
+	}
+
+	std::shared_ptr<ExpressionNode> ExpressionParser::ParseIdentifier()
+	{
+		size_t start = m_Position;
+		while (m_Position < m_Source.size() && Utils::IsIdentifierChar(m_Source[m_Position]))
+			m_Position++;
+
+		std::string name = m_Source.substr(start, m_Position - start);
+
+		for (uint32_t i = 0; i < m_Variables.size(); i++)
+		{
+			if (m_Variables[i] == name)
+				return MakeVariable(i);
+		}
+
+		if (name == "pi")
+			return MakeConstant(3.14159265358979f);
+		if (name == "tau")
+			return MakeConstant(6.28318530717959f);
+		if (name == "e")
+			return MakeConstant(2.71828182845905f);
+
+		for (const auto& function : Utils::s_Functions)
+		{
+			if (name != function.Name)
+				continue;
+
+			if (!Match('('))
+				return Fail("Expected '(' after " + name);
+
+			std::shared_ptr<ExpressionNode> a = ParseSum();
+			if (!a)
+				return nullptr;
+
+			std::shared_ptr<ExpressionNode> b;
+			if (GetExpressionOpOperandCount(function.Op) == 2)
+			{
+				if (!Match(','))
+					return Fail(name + " takes two arguments");
+
+				b = ParseSum();
+				if (!b)
+					return nullptr;
+			}
+
+			if (!Match(')'))
+				return Fail("Expected ')' after arguments of " + name);
+
+			return MakeNode(function.Op, a, b);
+		}
+
+		m_Position = start;
+		return Fail("Unknown identifier '" + name + "'");
+	}
+
+	void ExpressionParser::SkipWhitespace()
+	{
+		while (m_Position < m_Source.size() && std::isspace((unsigned char)m_Source[m_Position]))
+			m_Position++;
+	}
+
+	bool ExpressionParser::Match(char c)
+	{
+		SkipWhitespace();
+		if (m_Position < m_Source.size() && m_Source[m_Position] == c)
+		{
+			m_Position++;
+			return true;
+		}
+		return false;
+	}
+
+	bool ExpressionParser::StartsPrimary()
+	{
+		SkipWhitespace();
+		if (m_Position >= m_Source.size())
+			return false;
+
+		char c = m_Source[m_Position];
+		return c == '(' || c == '.' || std::isdigit((unsigned char)c) || Utils::IsIdentifierStart(c);
+	}
+
+	std::shared_ptr<ExpressionNode> ExpressionParser::Fail(const std::string& message)
+	{
+		if (m_Error.empty())
+			m_Error = message + " at position " + std::to_string(m_Position);
+		return nullptr;
+	}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "ExpressionAST.h"
+
+#include <string>
+#include <vector>
+
+namespace cv {
+
+	// recursive descent parser, folds constants and trivial identities while building the tree
+	class ExpressionParser
+	{
+	public:
+		ExpressionParser(const std::string& source, const std::vector<std::string>& variables);
+
+		std::shared_ptr<ExpressionNode> Parse();
+
+		const std::string& GetError() const { return m_Error; }
+
+		static std::shared_ptr<ExpressionNode> MakeConstant(float value);
+		static std::shared_ptr<ExpressionNode> MakeVariable(uint32_t index);
+		static std::shared_ptr<ExpressionNode> MakeNode(ExpressionOp op, std::shared_ptr<ExpressionNode> a, std::shared_ptr<ExpressionNode> b = nullptr);
+	private:
+		std::shared_ptr<ExpressionNode> ParseSum();
+		std::shared_ptr<ExpressionNode> ParseProduct();
+		std::shared_ptr<ExpressionNode> ParseUnary();
+		std::shared_ptr<ExpressionNode> ParsePower();
+		std::shared_ptr<ExpressionNode> ParsePrimary();
+		std::shared_ptr<ExpressionNode> ParseIdentifier();
+
+		void SkipWhitespace();
+		bool Match(char c);
+		bool StartsPrimary();
+
+		std::shared_ptr<ExpressionNode> Fail(const std::string& message);
+	private:
+		const std::string& m_Source;
+		const std::vector<std::string>& m_Variables;
+
+		size_t m_Position = 0;
+		std::string m_Error;
+	};
+
+}
@@ -0,0 +1,91 @@
+#include "cvpch.h"
+#include "ExpressionSIMD.h"
+
+#if CV_EXPRESSION_SIMD_X86 && defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+namespace cv {
+
+	namespace Utils {
+
+		using ExpressionKernel = bool(*)(const ExpressionInstruction& instruction, float* const* registers, size_t n);
+
+		static SIMDLevel DetectSIMDLevel()
+		{
+#if CV_EXPRESSION_SIMD_X86 && defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 0);
+			int maxLeaf = info[0];
+
+			__cpuid(info, 1);
+			bool sse41 = info[2] & (1 << 19);
+			bool fma = info[2] & (1 << 12);
+			bool osxsave = info[2] & (1 << 27);
+
+			// the os has to save the ymm registers as well, not just the cpu supporting them
+			bool avxState = osxsave && (_xgetbv(0) & 0x6) == 0x6;
+
+			bool avx2 = false;
+			if (maxLeaf >= 7)
+			{
+				__cpuidex(info, 7, 0);
+				avx2 = info[1] & (1 << 5);
+			}
+
+			if (avx2 && fma && avxState)
+				return SIMDLevel::AVX2;
+			if (sse41)
+				return SIMDLevel::SSE41;
+#elif CV_EXPRESSION_SIMD_X86
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+				return SIMDLevel::AVX2;
+			if (__builtin_cpu_supports("sse4.1"))
+				return SIMDLevel::SSE41;
+#endif
+			return SIMDLevel::Scalar;
+		}
+
+		static ExpressionKernel GetExpressionKernel(SIMDLevel level)
+		{
+			switch (level)
+			{
+#if CV_EXPRESSION_SIMD_X86
+				case SIMDLevel::SSE41: return SIMD::ExecuteSSE41;
+				case SIMDLevel::AVX2:  return SIMD::ExecuteAVX2;
+#endif
+				default:               break;
+			}
+
+			return nullptr;
+		}
+
+		static SIMDLevel s_SupportedLevel = DetectSIMDLevel();
+		static SIMDLevel s_Level = s_SupportedLevel;
+		static ExpressionKernel s_Kernel = GetExpressionKernel(s_Level);
+
+	}
+
+	SIMDLevel ExpressionSIMD::GetSupportedLevel()
+	{
+		return Utils::s_SupportedLevel;
+	}
+
+	SIMDLevel ExpressionSIMD::GetLevel()
+	{
+		return Utils::s_Level;
+	}
+
+	void ExpressionSIMD::SetLevel(SIMDLevel level)
+	{
+		Utils::s_Level = std::min(level, Utils::s_SupportedLevel);
+		Utils::s_Kernel = Utils::GetExpressionKernel(Utils::s_Level);
+	}
+
+	bool ExpressionSIMD::Execute(const ExpressionInstruction& instruction, float* const* registers, size_t n)
+	{
+		return Utils::s_Kernel && Utils::s_Kernel(instruction, registers, n);
+	}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ExpressionCompiler.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define CV_EXPRESSION_SIMD_X86 1
+#else
+	#define CV_EXPRESSION_SIMD_X86 0
+#endif
+
+namespace cv {
+
+	enum class SIMDLevel
+	{
+		Scalar = 0,
+		SSE41,
+		AVX2
+	};
+
+	// picks the widest instruction set the cpu supports at startup
+	class ExpressionSIMD
+	{
+	public:
+		// two AVX2 registers are processed per iteration, so the VM pads every row to this many values
+		static constexpr size_t Lanes = 16;
+
+		static SIMDLevel GetSupportedLevel();
+		static SIMDLevel GetLevel();
+
+		// clamped to the supported level, mostly for comparing against the scalar path
+		static void SetLevel(SIMDLevel level);
+
+		// runs one instruction over n values, n has to be a multiple of Lanes
+		// returns false for instructions without a vector kernel, those are left to the scalar path
+		static bool Execute(const ExpressionInstruction& instruction, float* const* registers, size_t n);
+	};
+
+	// the kernels live in their own translation units, which are the only ones compiled for the wider instruction sets
+	namespace SIMD {
+
+#if CV_EXPRESSION_SIMD_X86
+		bool ExecuteSSE41(const ExpressionInstruction& instruction, float* const* registers, size_t n);
+		bool ExecuteAVX2(const ExpressionInstruction& instruction, float* const* registers, size_t n);
+#endif
+
+	}
+
+}
@@ -0,0 +1,79 @@
+#include "ExpressionSIMD.h"
+
+#if CV_EXPRESSION_SIMD_X86
+
+#include "ExpressionSIMDKernels.h"
+
+#include <immintrin.h>
+
+// compiled with AVX2 and FMA enabled and without the precompiled header, see premake5.lua
+
+namespace cv::SIMD {
+
+	namespace {
+
+		struct AVX2
+		{
+			using Float = __m256;
+			using Int = __m256i;
+
+			static constexpr size_t Width = 8;
+			static constexpr bool HasFMA = true;
+
+			static Float Load(const float* data) { return _mm256_loadu_ps(data); }
+			static void Store(float* data, Float v) { _mm256_storeu_ps(data, v); }
+			static Float Set(float v) { return _mm256_set1_ps(v); }
+			static Int SetInt(int32_t v) { return _mm256_set1_epi32(v); }
+
+			static Float Add(Float a, Float b) { return _mm256_add_ps(a, b); }
+			static Float Sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+			static Float Mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+			static Float Div(Float a, Float b) { return _mm256_div_ps(a, b); }
+			static Float FMA(Float a, Float b, Float c) { return _mm256_fmadd_ps(a, b, c); }
+			static Float Min(Float a, Float b) { return _mm256_min_ps(a, b); }
+			static Float Max(Float a, Float b) { return _mm256_max_ps(a, b); }
+			static Float Sqrt(Float a) { return _mm256_sqrt_ps(a); }
+			static Float Floor(Float a) { return _mm256_floor_ps(a); }
+			static Float Ceil(Float a) { return _mm256_ceil_ps(a); }
+			static Float Round(Float a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+			static Float And(Float a, Float b) { return _mm256_and_ps(a, b); }
+			static Float AndNot(Float a, Float b) { return _mm256_andnot_ps(a, b); }
+			static Float Or(Float a, Float b) { return _mm256_or_ps(a, b); }
+			static Float Xor(Float a, Float b) { return _mm256_xor_ps(a, b); }
+
+			static Float LessThan(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+			static Float LessEqual(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+			static Float GreaterThan(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+			static Float GreaterEqual(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+			static Float IsNaN(Float a) { return _mm256_cmp_ps(a, a, _CMP_UNORD_Q); }
+			static Float Select(Float mask, Float a, Float b) { return _mm256_blendv_ps(b, a, mask); }
+			static int MoveMask(Float mask) { return _mm256_movemask_ps(mask); }
+
+			static Int ConvertToInt(Float a) { return _mm256_cvtps_epi32(a); }
+			static Int ConvertToIntTruncate(Float a) { return _mm256_cvttps_epi32(a); }
+			static Float ConvertToFloat(Int a) { return _mm256_cvtepi32_ps(a); }
+			static Int AsInt(Float a) { return _mm256_castps_si256(a); }
+			static Float AsFloat(Int a) { return _mm256_castsi256_ps(a); }
+
+			static Int IntAdd(Int a, Int b) { return _mm256_add_epi32(a, b); }
+			static Int IntSub(Int a, Int b) { return _mm256_sub_epi32(a, b); }
+			static Int IntAnd(Int a, Int b) { return _mm256_and_si256(a, b); }
+			static Int IntAndNot(Int a, Int b) { return _mm256_andnot_si256(a, b); }
+			static Int IntOr(Int a, Int b) { return _mm256_or_si256(a, b); }
+			static Int IntEqual(Int a, Int b) { return _mm256_cmpeq_epi32(a, b); }
+			template<int Count> static Int ShiftLeft(Int a) { return _mm256_slli_epi32(a, Count); }
+			template<int Count> static Int ShiftRight(Int a) { return _mm256_srli_epi32(a, Count); }
+			template<int Count> static Int ShiftRightArithmetic(Int a) { return _mm256_srai_epi32(a, Count); }
+		};
+
+	}
+
+	bool ExecuteAVX2(const ExpressionInstruction& instruction, float* const* registers, size_t n)
+	{
+		return ExecuteInstruction<AVX2>(instruction, registers, n);
+	}
+
+}
+
+#endif
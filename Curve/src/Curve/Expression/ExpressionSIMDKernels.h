@@ -0,0 +1,355 @@
+#pragma once
+
+#include "ExpressionCompiler.h"
+
+#include <math.h>
+#include <cstdint>
+#include <cstddef>
+
+// the vector kernels, written once against an instruction set wrapper V (see ExpressionSIMDSSE41.cpp and ExpressionSIMDAVX2.cpp)
+// only include this from the translation units compiled for that instruction set, and declare V in an anonymous namespace there:
+// that keeps every instantiation local, so the linker can never hand wide code to the generic parts of the program
+// for the same reason the scalar fallbacks call the C math functions instead of the inline std:: overloads
+
+namespace cv::SIMD {
+
+	template<typename V>
+	struct Math
+	{
+		using Float = typename V::Float;
+		using Int = typename V::Int;
+
+		// lanes that are not in valid are recomputed with the scalar libm function, which keeps the error bounded outside the fast range
+		template<typename Func>
+		static Float Fixup(Float valid, Float x, Float result, Func func)
+		{
+			int invalid = ~V::MoveMask(valid) & ((1 << V::Width) - 1);
+			if (!invalid)
+				return result;
+
+			alignas(32) float xs[V::Width], results[V::Width];
+			V::Store(xs, x);
+			V::Store(results, result);
+			for (size_t i = 0; i < V::Width; i++)
+			{
+				if (invalid & (1 << i))
+					results[i] = func(xs[i]);
+			}
+
+			return V::Load(results);
+		}
+
+		template<typename Func>
+		static Float Fixup(Float valid, Float a, Float b, Float result, Func func)
+		{
+			int invalid = ~V::MoveMask(valid) & ((1 << V::Width) - 1);
+			if (!invalid)
+				return result;
+
+			alignas(32) float as[V::Width], bs[V::Width], results[V::Width];
+			V::Store(as, a);
+			V::Store(bs, b);
+			V::Store(results, result);
+			for (size_t i = 0; i < V::Width; i++)
+			{
+				if (invalid & (1 << i))
+					results[i] = func(as[i], bs[i]);
+			}
+
+			return V::Load(results);
+		}
+
+		// exact rounding error of a + b, so that a + b == sum + error
+		static Float TwoSumError(Float a, Float b, Float sum)
+		{
+			Float bVirtual = V::Sub(sum, a);
+			Float aVirtual = V::Sub(sum, bVirtual);
+			return V::Add(V::Sub(a, aVirtual), V::Sub(b, bVirtual));
+		}
+
+		// exact rounding error of a * b, so that a * b == product + error
+		static Float TwoProductError(Float a, Float b, Float product)
+		{
+			if constexpr (V::HasFMA)
+				return V::FMA(a, b, V::Sub(V::Set(0.0f), product));
+			else
+			{
+				Float splitter = V::Set(4097.0f);
+
+				Float ca = V::Mul(a, splitter);
+				Float aHigh = V::Sub(ca, V::Sub(ca, a));
+				Float aLow = V::Sub(a, aHigh);
+
+				Float cb = V::Mul(b, splitter);
+				Float bHigh = V::Sub(cb, V::Sub(cb, b));
+				Float bLow = V::Sub(b, bHigh);
+
+				Float error = V::Sub(V::Mul(aHigh, bHigh), product);
+				error = V::Add(error, V::Mul(aHigh, bLow));
+				error = V::Add(error, V::Mul(aLow, bHigh));
+				return V::Add(error, V::Mul(aLow, bLow));
+			}
+		}
+
+		// cephes sinf/cosf polynomials, accurate to about 1 ulp for |x| <= 8192
+		// pi/4 is split into pieces of 10 significant bits, so every j * piece is exact even without fma and the reduction holds up near the zeros
+		static Float SinCosValid(Float x)
+		{
+			return V::LessEqual(V::AndNot(V::Set(-0.0f), x), V::Set(8192.0f));
+		}
+
+		static void SinCos(Float x, Float& sin, Float& cos)
+		{
+			Float signMask = V::Set(-0.0f);
+			Float ax = V::AndNot(signMask, x);
+			Float signSin = V::And(x, signMask);
+
+			Int j = V::ConvertToIntTruncate(V::Mul(ax, V::Set(1.27323954473516f)));
+			j = V::IntAnd(V::IntAdd(j, V::SetInt(1)), V::SetInt(~1));
+			Float y = V::ConvertToFloat(j);
+
+			Float swapSignSin = V::AsFloat(V::template ShiftLeft<29>(V::IntAnd(j, V::SetInt(4))));
+			Float signCos = V::AsFloat(V::template ShiftLeft<29>(V::IntAndNot(V::IntSub(j, V::SetInt(2)), V::SetInt(4))));
+			Float polynomialMask = V::AsFloat(V::IntEqual(V::IntAnd(j, V::SetInt(2)), V::SetInt(0)));
+			signSin = V::Xor(signSin, swapSignSin);
+
+			Float z = V::FMA(y, V::Set(-0.78515625f), ax);
+			z = V::FMA(y, V::Set(-2.4175643920898438e-4f), z);
+			z = V::FMA(y, V::Set(-1.5692785382270813e-7f), z);
+			z = V::FMA(y, V::Set(-3.035438567167148e-11f), z);
+			z = V::FMA(y, V::Set(-3.1116859848349943e-14f), z);
+			Float zz = V::Mul(z, z);
+
+			Float c = V::FMA(V::Set(2.443315711809948e-5f), zz, V::Set(-1.388731625493765e-3f));
+			c = V::FMA(c, zz, V::Set(4.166664568298827e-2f));
+			c = V::Mul(V::Mul(c, zz), zz);
+			c = V::FMA(zz, V::Set(-0.5f), c);
+			c = V::Add(c, V::Set(1.0f));
+
+			Float s = V::FMA(V::Set(-1.9515295891e-4f), zz, V::Set(8.3321608736e-3f));
+			s = V::FMA(s, zz, V::Set(-1.6666654611e-1f));
+			s = V::FMA(V::Mul(s, zz), z, z);
+
+			sin = V::Xor(V::Select(polynomialMask, s, c), signSin);
+			cos = V::Xor(V::Select(polynomialMask, c, s), signCos);
+		}
+
+		static Float Sin(Float x)
+		{
+			Float sin, cos;
+			SinCos(x, sin, cos);
+			return Fixup(SinCosValid(x), x, sin, [](float a) { return ::sinf(a); });
+		}
+
+		static Float Cos(Float x)
+		{
+			Float sin, cos;
+			SinCos(x, sin, cos);
+			return Fixup(SinCosValid(x), x, cos, [](float a) { return ::cosf(a); });
+		}
+
+		static Float Tan(Float x)
+		{
+			Float sin, cos;
+			SinCos(x, sin, cos);
+			return Fixup(SinCosValid(x), x, V::Div(sin, cos), [](float a) { return ::tanf(a); });
+		}
+
+		// cephes expf, exp(x + correction) where the correction is much smaller than x
+		// saturates to 0 and inf outside the float range, the scale is applied in two steps so results can go denormal
+		static Float ExpReduced(Float x, Float correction)
+		{
+			Float n = V::Round(V::Mul(x, V::Set(1.44269504088896341f)));
+
+			Float r = V::FMA(n, V::Set(-0.693359375f), x);
+			r = V::FMA(n, V::Set(2.12194440e-4f), r);
+			r = V::Add(r, correction);
+			Float rr = V::Mul(r, r);
+
+			Float y = V::FMA(V::Set(1.9875691500e-4f), r, V::Set(1.3981999507e-3f));
+			y = V::FMA(y, r, V::Set(8.3334519073e-3f));
+			y = V::FMA(y, r, V::Set(4.1665795894e-2f));
+			y = V::FMA(y, r, V::Set(1.6666665459e-1f));
+			y = V::FMA(y, r, V::Set(5.0000001201e-1f));
+			y = V::FMA(y, rr, r);
+			y = V::Add(y, V::Set(1.0f));
+
+			Int n1 = V::ConvertToInt(n);
+			Int n0 = V::template ShiftRightArithmetic<1>(n1);
+			n1 = V::IntSub(n1, n0);
+
+			Float scale0 = V::AsFloat(V::template ShiftLeft<23>(V::IntAdd(n0, V::SetInt(127))));
+			Float scale1 = V::AsFloat(V::template ShiftLeft<23>(V::IntAdd(n1, V::SetInt(127))));
+			Float result = V::Mul(V::Mul(y, scale0), scale1);
+
+			result = V::Select(V::GreaterThan(x, V::Set(88.72283935546875f)), V::Set(INFINITY), result);
+			return V::Select(V::LessThan(x, V::Set(-103.97207708f)), V::Set(0.0f), result);
+		}
+
+		static Float Exp(Float x)
+		{
+			return ExpReduced(x, V::Set(0.0f));
+		}
+
+		// cephes logf, log(x) = high + low + lowError where high = e * ln(2)'s leading bits is exact, only valid for normal positive x
+		static void LogReduced(Float x, Float& high, Float& low, Float& lowError)
+		{
+			Int bits = V::AsInt(x);
+			Float e = V::ConvertToFloat(V::IntSub(V::template ShiftRight<23>(bits), V::SetInt(126)));
+			Float m = V::AsFloat(V::IntOr(V::IntAnd(bits, V::SetInt(0x007fffff)), V::SetInt(0x3f000000)));
+
+			// m in [0.5, 1), moved to [sqrt(0.5), sqrt(2)) so the polynomial is centered around 1
+			Float small = V::LessThan(m, V::Set(0.707106781186547524f));
+			e = V::Sub(e, V::And(small, V::Set(1.0f)));
+			m = V::Add(V::Sub(m, V::Set(1.0f)), V::And(small, m));
+			Float mm = V::Mul(m, m);
+
+			Float y = V::FMA(V::Set(7.0376836292e-2f), m, V::Set(-1.1514610310e-1f));
+			y = V::FMA(y, m, V::Set(1.1676998740e-1f));
+			y = V::FMA(y, m, V::Set(-1.2420140846e-1f));
+			y = V::FMA(y, m, V::Set(1.4249322787e-1f));
+			y = V::FMA(y, m, V::Set(-1.6668057665e-1f));
+			y = V::FMA(y, m, V::Set(2.0000714765e-1f));
+			y = V::FMA(y, m, V::Set(-2.4999993993e-1f));
+			y = V::FMA(y, m, V::Set(3.3333331174e-1f));
+			y = V::Mul(V::Mul(y, m), mm);
+
+			y = V::FMA(e, V::Set(-2.12194440e-4f), y);
+			y = V::FMA(mm, V::Set(-0.5f), y);
+
+			high = V::Mul(e, V::Set(0.693359375f));
+			low = V::Add(m, y);
+			lowError = TwoSumError(m, y, low);
+		}
+
+		static Float LogValid(Float x)
+		{
+			return V::And(V::GreaterEqual(x, V::Set(1.17549435e-38f)), V::LessThan(x, V::Set(INFINITY)));
+		}
+
+		static Float Log(Float x)
+		{
+			Float high, low, lowError;
+			LogReduced(x, high, low, lowError);
+			return Fixup(LogValid(x), x, V::Add(low, high), [](float a) { return ::logf(a); });
+		}
+
+		static Float Log10(Float x)
+		{
+			Float high, low, lowError;
+			LogReduced(x, high, low, lowError);
+			return Fixup(LogValid(x), x, V::Mul(V::Add(low, high), V::Set(0.434294481903251827651f)), [](float a) { return ::log10f(a); });
+		}
+
+		// exp(b * log(a)) with log(a) and the product carried in extra precision, so their rounding doesn't get amplified by exp
+		// negative or special bases and results outside the exp range go through powf
+		static Float Pow(Float a, Float b)
+		{
+			Float high, low, lowError;
+			LogReduced(a, high, low, lowError);
+
+			Float yHigh = V::Mul(b, high);
+			Float yLow = V::Mul(b, low);
+			Float y = V::Add(yHigh, yLow);
+
+			Float correction = V::Add(TwoProductError(b, high, yHigh), TwoProductError(b, low, yLow));
+			correction = V::Add(correction, TwoSumError(yHigh, yLow, y));
+			correction = V::FMA(b, lowError, correction);
+
+			Float valid = V::And(LogValid(a), V::LessThan(V::AndNot(V::Set(-0.0f), b), V::Set(INFINITY)));
+			return Fixup(valid, a, b, ExpReduced(y, correction), [](float x, float y) { return ::powf(x, y); });
+		}
+
+		// std::fmin/fmax semantics, a nan operand is ignored
+		static Float Min(Float a, Float b)
+		{
+			return V::Select(V::IsNaN(b), a, V::Min(a, b));
+		}
+
+		static Float Max(Float a, Float b)
+		{
+			return V::Select(V::IsNaN(b), a, V::Max(a, b));
+		}
+
+		static Float Sign(Float a)
+		{
+			Float one = V::Set(1.0f);
+			return V::Sub(V::And(V::GreaterThan(a, V::Set(0.0f)), one), V::And(V::LessThan(a, V::Set(0.0f)), one));
+		}
+	};
+
+	// two registers per iteration, n is always a multiple of ExpressionSIMD::Lanes
+	template<typename V, typename Func>
+	static void ExecuteUnary(float* d, const float* a, size_t n, Func func)
+	{
+		for (size_t i = 0; i < n; i += 2 * V::Width)
+		{
+			typename V::Float a0 = V::Load(a + i);
+			typename V::Float a1 = V::Load(a + i + V::Width);
+			V::Store(d + i, func(a0));
+			V::Store(d + i + V::Width, func(a1));
+		}
+	}
+
+	template<typename V, typename Func>
+	static void ExecuteBinary(float* d, const float* a, const float* b, size_t n, Func func)
+	{
+		for (size_t i = 0; i < n; i += 2 * V::Width)
+		{
+			typename V::Float a0 = V::Load(a + i), b0 = V::Load(b + i);
+			typename V::Float a1 = V::Load(a + i + V::Width), b1 = V::Load(b + i + V::Width);
+			V::Store(d + i, func(a0, b0));
+			V::Store(d + i + V::Width, func(a1, b1));
+		}
+	}
+
+#define CV_SIMD_UNARY(op, expression) case ExpressionOp::op: ExecuteUnary<V>(D, A, n, [](Float a) { return expression; }); return true
+#define CV_SIMD_BINARY(op, expression) case ExpressionOp::op: ExecuteBinary<V>(D, A, B, n, [](Float a, Float b) { return expression; }); return true
+
+	template<typename V>
+	static bool ExecuteInstruction(const ExpressionInstruction& instruction, float* const* registers, size_t n)
+	{
+		using Float = typename V::Float;
+		using M = Math<V>;
+
+		float* D = registers[instruction.Destination];
+		const float* A = registers[instruction.A];
+		const float* B = registers[instruction.B];
+
+		// without fma the exact products in Pow cost more than powf itself
+		if (!V::HasFMA && instruction.Op == ExpressionOp::Power)
+			return false;
+
+		switch (instruction.Op)
+		{
+			CV_SIMD_BINARY(Add, V::Add(a, b));
+			CV_SIMD_BINARY(Subtract, V::Sub(a, b));
+			CV_SIMD_BINARY(Multiply, V::Mul(a, b));
+			CV_SIMD_BINARY(Divide, V::Div(a, b));
+			CV_SIMD_BINARY(Power, M::Pow(a, b));
+			CV_SIMD_BINARY(Modulo, V::Sub(a, V::Mul(b, V::Floor(V::Div(a, b)))));
+			CV_SIMD_BINARY(Min, M::Min(a, b));
+			CV_SIMD_BINARY(Max, M::Max(a, b));
+			CV_SIMD_UNARY(Negate, V::Xor(a, V::Set(-0.0f)));
+			CV_SIMD_UNARY(Abs, V::AndNot(V::Set(-0.0f), a));
+			CV_SIMD_UNARY(Sign, M::Sign(a));
+			CV_SIMD_UNARY(Floor, V::Floor(a));
+			CV_SIMD_UNARY(Ceil, V::Ceil(a));
+			CV_SIMD_UNARY(Sqrt, V::Sqrt(a));
+			CV_SIMD_UNARY(Exp, M::Exp(a));
+			CV_SIMD_UNARY(Log, M::Log(a));
+			CV_SIMD_UNARY(Log10, M::Log10(a));
+			CV_SIMD_UNARY(Sin, M::Sin(a));
+			CV_SIMD_UNARY(Cos, M::Cos(a));
+			CV_SIMD_UNARY(Tan, M::Tan(a));
+			default: break;
+		}
+
+		// inverse trigonometry and hyperbolics stay scalar
+		return false;
+	}
+
+#undef CV_SIMD_UNARY
+#undef CV_SIMD_BINARY
+
+}
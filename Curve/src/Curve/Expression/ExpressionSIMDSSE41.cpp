@@ -0,0 +1,79 @@
+#include "ExpressionSIMD.h"
+
+#if CV_EXPRESSION_SIMD_X86
+
+#include "ExpressionSIMDKernels.h"
+
+#include <immintrin.h>
+
+// compiled with SSE4.1 enabled and without the precompiled header, see premake5.lua
+
+namespace cv::SIMD {
+
+	namespace {
+
+		struct SSE41
+		{
+			using Float = __m128;
+			using Int = __m128i;
+
+			static constexpr size_t Width = 4;
+			static constexpr bool HasFMA = false;
+
+			static Float Load(const float* data) { return _mm_loadu_ps(data); }
+			static void Store(float* data, Float v) { _mm_storeu_ps(data, v); }
+			static Float Set(float v) { return _mm_set1_ps(v); }
+			static Int SetInt(int32_t v) { return _mm_set1_epi32(v); }
+
+			static Float Add(Float a, Float b) { return _mm_add_ps(a, b); }
+			static Float Sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+			static Float Mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+			static Float Div(Float a, Float b) { return _mm_div_ps(a, b); }
+			static Float FMA(Float a, Float b, Float c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+			static Float Min(Float a, Float b) { return _mm_min_ps(a, b); }
+			static Float Max(Float a, Float b) { return _mm_max_ps(a, b); }
+			static Float Sqrt(Float a) { return _mm_sqrt_ps(a); }
+			static Float Floor(Float a) { return _mm_floor_ps(a); }
+			static Float Ceil(Float a) { return _mm_ceil_ps(a); }
+			static Float Round(Float a) { return _mm_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+			static Float And(Float a, Float b) { return _mm_and_ps(a, b); }
+			static Float AndNot(Float a, Float b) { return _mm_andnot_ps(a, b); }
+			static Float Or(Float a, Float b) { return _mm_or_ps(a, b); }
+			static Float Xor(Float a, Float b) { return _mm_xor_ps(a, b); }
+
+			static Float LessThan(Float a, Float b) { return _mm_cmplt_ps(a, b); }
+			static Float LessEqual(Float a, Float b) { return _mm_cmple_ps(a, b); }
+			static Float GreaterThan(Float a, Float b) { return _mm_cmpgt_ps(a, b); }
+			static Float GreaterEqual(Float a, Float b) { return _mm_cmpge_ps(a, b); }
+			static Float IsNaN(Float a) { return _mm_cmpunord_ps(a, a); }
+			static Float Select(Float mask, Float a, Float b) { return _mm_blendv_ps(b, a, mask); }
+			static int MoveMask(Float mask) { return _mm_movemask_ps(mask); }
+
+			static Int ConvertToInt(Float a) { return _mm_cvtps_epi32(a); }
+			static Int ConvertToIntTruncate(Float a) { return _mm_cvttps_epi32(a); }
+			static Float ConvertToFloat(Int a) { return _mm_cvtepi32_ps(a); }
+			static Int AsInt(Float a) { return _mm_castps_si128(a); }
+			static Float AsFloat(Int a) { return _mm_castsi128_ps(a); }
+
+			static Int IntAdd(Int a, Int b) { return _mm_add_epi32(a, b); }
+			static Int IntSub(Int a, Int b) { return _mm_sub_epi32(a, b); }
+			static Int IntAnd(Int a, Int b) { return _mm_and_si128(a, b); }
+			static Int IntAndNot(Int a, Int b) { return _mm_andnot_si128(a, b); }
+			static Int IntOr(Int a, Int b) { return _mm_or_si128(a, b); }
+			static Int IntEqual(Int a, Int b) { return _mm_cmpeq_epi32(a, b); }
+			template<int Count> static Int ShiftLeft(Int a) { return _mm_slli_epi32(a, Count); }
+			template<int Count> static Int ShiftRight(Int a) { return _mm_srli_epi32(a, Count); }
+			template<int Count> static Int ShiftRightArithmetic(Int a) { return _mm_srai_epi32(a, Count); }
+		};
+
+	}
+
+	bool ExecuteSSE41(const ExpressionInstruction& instruction, float* const* registers, size_t n)
+	{
+		return ExecuteInstruction<SSE41>(instruction, registers, n);
+	}
+
+}
+
+#endif
@@ -0,0 +1,157 @@
+#include "cvpch.h"
+#include "ExpressionVM.h"
+#include "ExpressionSIMD.h"
+
+#define CV_EXPRESSION_UNARY(op, expression) case ExpressionOp::op: ExecuteUnary(D, A, n, [](auto a) { return expression; }); break
+#define CV_EXPRESSION_BINARY(op, expression) case ExpressionOp::op: ExecuteBinary(D, A, B, n, [](auto a, auto b) { return expression; }); break
+
+namespace cv {
+
+	namespace Utils {
+
+		// instructions always run over a multiple of the lane count, so neither the SIMD kernels nor the scalar loops need a tail
+		static constexpr size_t s_Lanes = ExpressionSIMD::Lanes;
+
+		static size_t PadToLanes(size_t count)
+		{
+			return (count + s_Lanes - 1) & ~(s_Lanes - 1);
+		}
+
+		// the compiler never assigns an instruction's destination to one of its operands, so the rows never alias
+		template<typename T, typename Func>
+		static void ExecuteUnary(T* __restrict d, const T* __restrict a, size_t n, Func func)
+		{
+			n = PadToLanes(n);
+			for (size_t i = 0; i < n; i++)
+				d[i] = func(a[i]);
+		}
+
+		template<typename T, typename Func>
+		static void ExecuteBinary(T* __restrict d, const T* __restrict a, const T* __restrict b, size_t n, Func func)
+		{
+			n = PadToLanes(n);
+			for (size_t i = 0; i < n; i++)
+				d[i] = func(a[i], b[i]);
+		}
+
+		// there are only SIMD kernels for floats, doubles always take the scalar loops
+		template<typename T>
+		static void ExecuteInstruction(const ExpressionInstruction& instruction, T* const* registers, size_t n)
+		{
+			if constexpr (std::is_same_v<T, float>)
+			{
+				if (ExpressionSIMD::Execute(instruction, registers, PadToLanes(n)))
+					return;
+			}
+
+			T* D = registers[instruction.Destination];
+			const T* A = registers[instruction.A];
+			const T* B = registers[instruction.B];
+
+			switch (instruction.Op)
+			{
+				CV_EXPRESSION_BINARY(Add, a + b);
+				CV_EXPRESSION_BINARY(Subtract, a - b);
+				CV_EXPRESSION_BINARY(Multiply, a * b);
+				CV_EXPRESSION_BINARY(Divide, a / b);
+				CV_EXPRESSION_BINARY(Power, std::pow(a, b));
+				CV_EXPRESSION_BINARY(Modulo, a - b * std::floor(a / b));
+				CV_EXPRESSION_BINARY(Min, std::fmin(a, b));
+				CV_EXPRESSION_BINARY(Max, std::fmax(a, b));
+				CV_EXPRESSION_BINARY(Atan2, std::atan2(a, b));
+				CV_EXPRESSION_UNARY(Negate, -a);
+				CV_EXPRESSION_UNARY(Abs, std::abs(a));
+				CV_EXPRESSION_UNARY(Sign, (decltype(a))((a > 0) - (a < 0)));
+				CV_EXPRESSION_UNARY(Floor, std::floor(a));
+				CV_EXPRESSION_UNARY(Ceil, std::ceil(a));
+				CV_EXPRESSION_UNARY(Sqrt, std::sqrt(a));
+				CV_EXPRESSION_UNARY(Exp, std::exp(a));
+				CV_EXPRESSION_UNARY(Log, std::log(a));
+				CV_EXPRESSION_UNARY(Log10, std::log10(a));
+				CV_EXPRESSION_UNARY(Sin, std::sin(a));
+				CV_EXPRESSION_UNARY(Cos, std::cos(a));
+				CV_EXPRESSION_UNARY(Tan, std::tan(a));
+				CV_EXPRESSION_UNARY(Asin, std::asin(a));
+				CV_EXPRESSION_UNARY(Acos, std::acos(a));
+				CV_EXPRESSION_UNARY(Atan, std::atan(a));
+				CV_EXPRESSION_UNARY(Sinh, std::sinh(a));
+				CV_EXPRESSION_UNARY(Cosh, std::cosh(a));
+				CV_EXPRESSION_UNARY(Tanh, std::tanh(a));
+				default:
+					CV_ASSERT(false && "Invalid expression instruction!");
+					break;
+			}
+		}
+
+		template<typename T>
+		static void Execute(const ExpressionProgram& program, const T* const* variables, T* output, size_t count)
+		{
+			if (count == 0)
+				return;
+
+			uint32_t firstTemporary = program.GetFirstTemporary();
+			size_t rowSize = PadToLanes(std::min(count, ExpressionVM::BlockSize));
+
+			// rows for constants and temporaries, followed by padded copies of the variables and the output for a partial last block
+			thread_local std::vector<T> scratch;
+			size_t rowCount = (size_t)(program.RegisterCount - program.VariableCount) + program.VariableCount + 1;
+			scratch.resize(rowCount * rowSize);
+
+			T* rows[ExpressionCompiler::MaxRegisters + 1];
+			for (size_t i = 0; i < rowCount; i++)
+				rows[i] = scratch.data() + i * rowSize;
+
+			T* registers[ExpressionCompiler::MaxRegisters];
+			for (uint32_t i = program.VariableCount; i < program.RegisterCount; i++)
+				registers[i] = rows[i - program.VariableCount];
+
+			// constants are broadcast once, temporaries are reused for every block
+			for (size_t i = 0; i < program.Constants.size(); i++)
+				std::fill_n(registers[program.VariableCount + i], rowSize, (T)program.Constants[i]);
+
+			T** tailRows = rows + (program.RegisterCount - program.VariableCount);
+			bool resultIsTemporary = program.Result >= firstTemporary;
+
+			for (size_t offset = 0; offset < count; offset += ExpressionVM::BlockSize)
+			{
+				size_t n = std::min(ExpressionVM::BlockSize, count - offset);
+				size_t paddedCount = PadToLanes(n);
+				bool partial = paddedCount != n;
+
+				for (uint32_t i = 0; i < program.VariableCount; i++)
+				{
+					if (partial)
+					{
+						std::copy_n(variables[i] + offset, n, tailRows[i]);
+						std::fill(tailRows[i] + n, tailRows[i] + paddedCount, T(0));
+						registers[i] = tailRows[i];
+					}
+					else
+						registers[i] = const_cast<T*>(variables[i] + offset);
+				}
+
+				// the result is always produced by the last instruction, so it can be written straight into the output
+				if (resultIsTemporary)
+					registers[program.Result] = partial ? tailRows[program.VariableCount] : output + offset;
+
+				for (const ExpressionInstruction& instruction : program.Instructions)
+					ExecuteInstruction(instruction, registers, paddedCount);
+
+				if (!resultIsTemporary || partial)
+					std::copy_n(registers[program.Result], n, output + offset);
+			}
+		}
+
+	}
+
+	void ExpressionVM::Execute(const ExpressionProgram& program, const float* const* variables, float* output, size_t count)
+	{
+		Utils::Execute(program, variables, output, count);
+	}
+
+	void ExpressionVM::Execute(const ExpressionProgram& program, const double* const* variables, double* output, size_t count)
+	{
+		Utils::Execute(program, variables, output, count);
+	}
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Curve/Core/Base.h"
+
+#include "ExpressionCompiler.h"
+
+namespace cv {
+
+	class ExpressionVM
+	{
+	public:
+		// every instruction runs over a whole block of samples before moving on to the next one
+		static constexpr size_t BlockSize = 256;
+
+		// variables holds VariableCount arrays of count values each, output must not alias them
+		static void Execute(const ExpressionProgram& program, const float* const* variables, float* output, size_t count);
+
+		// the same in double precision for deep zooms, always on the scalar path
+		static void Execute(const ExpressionProgram& program, const double* const* variables, double* output, size_t count);
+	};
+
+}
@@ -160,7 +160,8 @@ namespace cv {
 		VertexBuffer = 1 << 0,
 		IndexBuffer = 1 << 1,
 		StorageBuffer = 1 << 2,
-		StagingBuffer = 1 << 3
+		StagingBuffer = 1 << 3,
+		IndirectBuffer = 1 << 4 // holds DrawIndirectCommands, see Renderer::DrawIndirect
 	};
 
 	constexpr inline BufferType operator|(BufferType lhs, BufferType rhs)
@@ -220,7 +221,9 @@ namespace cv {
 		virtual void SetData(const void* data, size_t size) = 0;
 		virtual void SetData(int data, size_t size) = 0;
 
+		// only the mapped range is uploaded again on Unmap, the copy lands before the next submitted command buffer
 		virtual void* Map(size_t size) = 0;
+		virtual void* Map(size_t offset, size_t size) = 0;
 		virtual void Unmap() = 0;
 
 		virtual size_t GetSize() const = 0;
@@ -241,6 +244,7 @@ namespace cv {
 		void SetData(int data, size_t size) { m_Base->SetData(data, size); }
 
 		void* Map(size_t size) { return m_Base->Map(size); }
+		void* Map(size_t offset, size_t size) { return m_Base->Map(offset, size); }
 		void Unmap() { m_Base->Unmap(); }
 
 		size_t GetSize() const { return m_Base->GetSize(); }
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "Shader.h"
+#include "Buffer.h"
 #include "CommandBuffer.h"
 #include "NativeRendererObject.h"
 
+#include <type_traits>
+
 namespace cv {
 
 	enum class PrimitiveTopology
@@ -22,11 +25,21 @@ namespace cv {
 		virtual void PushConstants(CommandBuffer commandBuffer, ShaderStage shaderStage, size_t size, const void* data, size_t offset = 0) = 0;
 		virtual void SetLineWidth(CommandBuffer commandBuffer, float lineWidth) = 0;
 
+		virtual void BindDescriptor(CommandBuffer commandBuffer) const = 0;
+
 		template<typename T>
 		void PushConstants(CommandBuffer commandBuffer, ShaderStage shaderStage, const T& data, size_t offset = 0)
 		{
 			PushConstants(commandBuffer, shaderStage, sizeof(T), &data, offset);
 		}
+
+		template<BufferType Type>
+		std::enable_if_t<Type & StorageBuffer> UpdateDescriptor(Buffer<Type>* buffer, uint32_t binding, uint32_t index = 0)
+		{
+			UpdateDescriptor(buffer->GetBase(), binding, index);
+		}
+	private:
+		virtual void UpdateDescriptor(BufferBase* buffer, uint32_t binding, uint32_t index) = 0;
 	};
 
 }
@@ -5,9 +5,9 @@
 
 namespace cv {
 
-    Renderer* Renderer::Create(Window& window)
+    Renderer* Renderer::Create(Window& window, const RendererSpecification& spec)
     {
-        return new VulkanRenderer(window);
+        return new VulkanRenderer(window, spec);
     }
 
 }
@@ -17,22 +17,56 @@
 
 namespace cv {
 
+	// the layout of one draw in an indirect buffer, the same as VkDrawIndirectCommand
+	struct DrawIndirectCommand
+	{
+		uint32_t VertexCount;
+		uint32_t InstanceCount;
+		uint32_t FirstVertex;
+		uint32_t FirstInstance;
+	};
+
+	struct RendererSpecification
+	{
+		// no surface or swapchain, rendering only goes to framebuffers
+		bool Headless = false;
+	};
+
 	class Renderer : public NativeRendererObject
 	{
 	public:
 		virtual ~Renderer() = default;
 
-		static Renderer* Create(Window& window);
+		static Renderer* Create(Window& window, const RendererSpecification& spec = {});
 
 		virtual void BeginFrame() = 0;
 		virtual void EndFrame() = 0;
 
 		virtual Window& GetWindow() = 0;
+		virtual bool IsHeadless() const = 0;
 
-		virtual void Draw(CommandBuffer commandBuffer, size_t vertexCount, size_t vertexOffset = 0) const = 0;
+		// firstInstance shows up as gl_InstanceIndex, e.g. to look up per draw data in a storage buffer
+		virtual void Draw(CommandBuffer commandBuffer, size_t vertexCount, size_t vertexOffset = 0, uint32_t firstInstance = 0) const = 0;
 		virtual void DrawIndexed(CommandBuffer commandBuffer, size_t indexCount, size_t indexOffset = 0) const = 0;
 
+		// drawCount DrawIndirectCommands one after the other from offset (in bytes), in a single call
+		template<BufferType Type>
+		std::enable_if_t<Type & IndirectBuffer> DrawIndirect(CommandBuffer commandBuffer, const Buffer<Type>* buffer, size_t offset, uint32_t drawCount) const
+		{
+			DrawIndirect(commandBuffer, buffer->GetBase(), offset, drawCount);
+		}
+
+		// the same with the number of draws read from a uint at countOffset on the GPU, e.g. written by a compute shader
+		// without driver support for it all maxDrawCount draws are issued, the ones past the count have to draw nothing then
+		template<BufferType Type, BufferType CountType>
+		std::enable_if_t<(Type & IndirectBuffer) && (CountType & IndirectBuffer)> DrawIndirectCount(CommandBuffer commandBuffer, const Buffer<Type>* buffer, size_t offset, const Buffer<CountType>* countBuffer, size_t countOffset, uint32_t maxDrawCount) const
+		{
+			DrawIndirectCount(commandBuffer, buffer->GetBase(), offset, countBuffer->GetBase(), countOffset, maxDrawCount);
+		}
+
 		virtual void Dispatch(CommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) const = 0;
+		// orders compute shader writes against vertex input and other dispatches, both before and after the barrier
+		virtual void ComputeBarrier(CommandBuffer commandBuffer) const = 0;
 
 		virtual void BeginCommandBuffer(CommandBuffer commandBuffer) const = 0;
 		virtual void EndCommandBuffer(CommandBuffer commandBuffer) const = 0;
@@ -40,12 +74,17 @@ namespace cv {
 
 		virtual Swapchain* GetSwapchain() const = 0;
 
+		virtual uint32_t GetImageCount() const = 0;
+		virtual uint32_t GetImageIndex() const = 0;
+
 		virtual CommandBuffer AllocateCommandBuffer() const = 0;
 		virtual CommandBuffer BeginSingleTimeCommands() const = 0;
 		virtual void EndSingleTimeCommands(CommandBuffer commandBuffer) const = 0;
 
 		virtual Swapchain* CreateSwapchain(const SwapchainSpecification& spec) = 0;
 		virtual Shader* CreateShader(const std::filesystem::path& path) = 0;
+		// name is used in place of the filepath, e.g. for the binary cache
+		virtual Shader* CreateShader(const std::string& name, const std::string& source) = 0;
 		virtual GraphicsPipeline* CreateGraphicsPipeline(Shader* shader, PrimitiveTopology topology, const InputLayout& layout) = 0;
 		virtual GraphicsPipeline* CreateGraphicsPipeline(Shader* shader, PrimitiveTopology topology, const InputLayout& layout, Framebuffer* framebuffer) = 0;
 		virtual ComputePipeline* CreateComputePipeline(Shader* shader, const InputLayout& layout) = 0;
@@ -59,6 +98,8 @@ namespace cv {
 		}
 
 		virtual uint32_t GetCurrentFrameIndex() const = 0;
+		// buffers written in place are still read by the frames in flight, this waits for them before a buffer is rewritten wholesale
+		virtual void WaitForFramesInFlight() const = 0;
 
 		template<typename T>
 		T& GetNativeData() { return *reinterpret_cast<T*>(GetNativeData()); }
@@ -66,6 +107,9 @@ namespace cv {
 		const T& GetNativeData() const { return *reinterpret_cast<const T*>(GetNativeData()); }
 	private:
 		virtual BufferBase* CreateBufferBase(BufferType type, size_t size, const void* data = nullptr) = 0;
+
+		virtual void DrawIndirect(CommandBuffer commandBuffer, BufferBase* buffer, size_t offset, uint32_t drawCount) const = 0;
+		virtual void DrawIndirectCount(CommandBuffer commandBuffer, BufferBase* buffer, size_t offset, BufferBase* countBuffer, size_t countOffset, uint32_t maxDrawCount) const = 0;
 	};
 
 }
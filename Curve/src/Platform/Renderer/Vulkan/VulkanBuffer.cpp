@@ -66,21 +66,30 @@ namespace cv {
 				flags |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
 			if (type & StagingBuffer)
 				flags |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			if (type & IndirectBuffer)
+				flags |= VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
 
 			return flags;
 		}
 
-		static bool NeedsStagingBuffer(BufferType type)
+		// on unified memory the buffers the device reads are written in place, only indirect buffers keep a staging copy since
+		// a draw command torn by a write while a frame in flight reads it isn't bounded by anything
+		static bool NeedsStagingBuffer(BufferType type, bool unifiedMemory)
 		{
-			return (type & IndexBuffer) || (type & StorageBuffer);
+			if (unifiedMemory)
+				return type & IndirectBuffer;
+
+			return (type & IndexBuffer) || (type & StorageBuffer) || (type & IndirectBuffer);
 		}
 
-		static VkMemoryPropertyFlags GetBufferMemoryProperties(BufferType type)
+		static VkMemoryPropertyFlags GetBufferMemoryProperties(BufferType type, bool unifiedMemory)
 		{
 			VkMemoryPropertyFlags flags = 0;
 
-			if (NeedsStagingBuffer(type))
+			if (NeedsStagingBuffer(type, unifiedMemory))
 				flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+			else if (unifiedMemory && !(type & StagingBuffer))
+				flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 			else
 				flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
@@ -97,24 +106,26 @@ namespace cv {
 		m_Data = new BufferData();
 		m_Data->Size = size;
 
+		bool unifiedMemory = vkd.MemoryAllocator->IsUnifiedMemory();
+
 		Utils::CreateBuffer(
 			vkd.Device,
-			vkd.PhysicalDevice,
+			vkd.MemoryAllocator,
 			vkd.Allocator,
 			size,
 			Utils::GetBufferUsage(type),
-			Utils::GetBufferMemoryProperties(type),
+			Utils::GetBufferMemoryProperties(type, unifiedMemory),
 			m_Data->Buffer,
 			m_Data->Memory
 		);
 
-		if (Utils::NeedsStagingBuffer(type))
+		if (Utils::NeedsStagingBuffer(type, unifiedMemory))
 		{
 			m_StagingData = new BufferData();
 
 			Utils::CreateBuffer(
 				vkd.Device,
-				vkd.PhysicalDevice,
+				vkd.MemoryAllocator,
 				vkd.Allocator,
 				size,
 				VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
@@ -125,14 +136,7 @@ namespace cv {
 		}
 
 		if (data)
-		{
-			void* memory = Map(size);
-			memcpy(memory, data, size);
-			Unmap();
-
-			if (Utils::NeedsStagingBuffer(type))
-				Utils::CopyBuffer(m_Renderer, m_StagingData->Buffer, m_Data->Buffer, size);
-		}
+			SetData(data, size);
 	}
 
 	VulkanBuffer::~VulkanBuffer()
@@ -142,12 +146,12 @@ namespace cv {
 			auto& vkd = renderer->GetVulkanData();
 
 			vkDestroyBuffer(vkd.Device, bd->Buffer, vkd.Allocator);
-			vkFreeMemory(vkd.Device, bd->Memory, vkd.Allocator);
+			vkd.MemoryAllocator->Free(bd->Memory);
 
 			if (sd)
 			{
 				vkDestroyBuffer(vkd.Device, sd->Buffer, vkd.Allocator);
-				vkFreeMemory(vkd.Device, sd->Memory, vkd.Allocator);
+				vkd.MemoryAllocator->Free(sd->Memory);
 			}
 
 			delete bd;
@@ -183,33 +187,28 @@ namespace cv {
 
 	void* VulkanBuffer::Map(size_t size)
 	{
-		auto& vkd = m_Renderer->GetVulkanData();
+		return Map(0, size);
+	}
 
-		if (Utils::NeedsStagingBuffer(m_Type))
-		{
-			void* memory;
-			vkMapMemory(vkd.Device, m_StagingData->Memory, 0, size, 0, &memory);
-			return memory;
-		}
-		else
-		{
-			void* memory;
-			vkMapMemory(vkd.Device, m_Data->Memory, 0, size, 0, &memory);
-			return memory;
-		}
+	void* VulkanBuffer::Map(size_t offset, size_t size)
+	{
+		CV_ASSERT(offset + size <= m_Data->Size && "Mapped range is out of bounds!");
+		m_MapOffset = offset;
+		m_MapSize = size;
+
+		// host visible blocks stay mapped, vkMapMemory can't map two ranges of one block at once anyway
+		const BufferData* data = m_StagingData ? m_StagingData : m_Data;
+		return (uint8_t*)data->Memory.Mapped + offset;
 	}
 
 	void VulkanBuffer::Unmap()
 	{
 		auto& vkd = m_Renderer->GetVulkanData();
 
-		if (Utils::NeedsStagingBuffer(m_Type))
-		{
-			vkUnmapMemory(vkd.Device, m_StagingData->Memory);
-			Utils::CopyBuffer(m_Renderer, m_StagingData->Buffer, m_Data->Buffer, m_Data->Size);
-		}
-		else
-			vkUnmapMemory(vkd.Device, m_Data->Memory);
+		// recorded for the next submit, the staging memory can be written again right away only because the range is copied
+		// into the upload ring here (a range too big for the ring is copied out of the staging buffer and waited on instead)
+		if (m_StagingData)
+			vkd.UploadManager->CopyBuffer(m_StagingData->Buffer, (const uint8_t*)m_StagingData->Memory.Mapped + m_MapOffset, m_Data->Buffer, m_MapSize, m_MapOffset);
 	}
 
 	size_t VulkanBuffer::GetSize() const
@@ -19,6 +19,7 @@ namespace cv {
 		virtual void SetData(int data, size_t size) override;
 
 		virtual void* Map(size_t size) override;
+		virtual void* Map(size_t offset, size_t size) override;
 		virtual void Unmap() override;
 
 		virtual size_t GetSize() const override;
@@ -31,6 +32,9 @@ namespace cv {
 		BufferData* m_StagingData = nullptr;
 
 		BufferType m_Type;
+
+		// the range of the last Map, which is all Unmap has to copy to the device
+		size_t m_MapOffset = 0, m_MapSize = 0;
 	};
 
 }
@@ -88,7 +88,7 @@ namespace cv {
 		createInfo.layout = m_Data->PipelineLayout;
 		createInfo.stage = shaderStageInfo;
 		
-		result = vkCreateComputePipelines(vkd.Device, nullptr, 1, &createInfo, vkd.Allocator, &m_Data->Pipeline);
+		result = vkCreateComputePipelines(vkd.Device, vkd.PipelineCache, 1, &createInfo, vkd.Allocator, &m_Data->Pipeline);
 		VK_CHECK(result, "Failed to create Vulkan compute pipeline!");
 	}
 
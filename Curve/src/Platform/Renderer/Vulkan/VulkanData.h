@@ -1,6 +1,8 @@
 #pragma once
 
 #include "VulkanRenderer.h"
+#include "VulkanMemoryAllocator.h"
+#include "VulkanUploadManager.h"
 #include "Curve/Core/Base.h"
 #include "Curve/Core/Window.h"
 
@@ -23,10 +25,27 @@ namespace cv {
 		VkCommandPool CommandPool = nullptr;
 		VkDescriptorPool DescriptorPool = nullptr;
 
+		// shared by every pipeline, kept on disk between runs
+		VkPipelineCache PipelineCache = nullptr;
+
+		// every buffer and image is bound to memory from here
+		VulkanMemoryAllocator* MemoryAllocator = nullptr;
+
+		// copies staging memory into device local buffers ahead of the next submit
+		VulkanUploadManager* UploadManager = nullptr;
+
 		Swapchain* Swapchain = nullptr;
 
+		bool Headless = false;
+		VkFormat HeadlessImageFormat = VK_FORMAT_B8G8R8A8_UNORM;
+
 		VkSampleCountFlagBits MultisampleCount = VK_SAMPLE_COUNT_1_BIT;
 
+		// vkCmdDrawIndirectCount (core in 1.2, VK_KHR_draw_indirect_count before) is optional, nullptr without it
+		// the draws are split into calls of at most MaxDrawIndirectCount
+		PFN_vkCmdDrawIndirectCount CmdDrawIndirectCount = nullptr;
+		uint32_t MaxDrawIndirectCount = 1;
+
 		uint32_t CurrentFrameIndex = 0;
 
 		std::array<std::array<VkSemaphore, CV_MAX_SUBMITS_PER_FRAME>, CV_FRAMES_IN_FLIGHT> FrameSemaphores = {};
@@ -39,7 +58,10 @@ namespace cv {
 		std::array<uint32_t, CV_FRAMES_IN_FLIGHT> UsedFenceCount = {};
 		std::array<bool, CV_FRAMES_IN_FLIGHT> FrameSuccess = {};
 
+		// frees submitted while a frame index is current are moved to its pending queue once the frame is submitted and run
+		// the next time the index begins, after its fences are waited on, frees between two frames wait for the next one
 		std::array<std::vector<std::function<void(VulkanRenderer*)>>, CV_FRAMES_IN_FLIGHT> ResourceFreeQueue = {};
+		std::array<std::vector<std::function<void(VulkanRenderer*)>>, CV_FRAMES_IN_FLIGHT> PendingResourceFreeQueue = {};
 	};
 
 	struct QueueFamilyIndices
@@ -73,11 +95,11 @@ namespace cv {
 		std::vector<VkFramebuffer> Framebuffers;
 
 		VkImage DepthImage = nullptr;
-		VkDeviceMemory DepthImageMemory = nullptr;
+		VulkanAllocation DepthImageMemory = {};
 		VkImageView DepthImageView = nullptr;
 
 		VkImage ColorImage = nullptr;
-		VkDeviceMemory ColorImageMemory = nullptr;
+		VulkanAllocation ColorImageMemory = {};
 		VkImageView ColorImageView = nullptr;
 	};
 
@@ -95,7 +117,7 @@ namespace cv {
 	struct BufferData
 	{
 		VkBuffer Buffer = nullptr;
-		VkDeviceMemory Memory = nullptr;
+		VulkanAllocation Memory = {};
 		size_t Size = 0;
 	};
 
@@ -113,19 +135,19 @@ namespace cv {
 		uint32_t ImageIndex = 0;
 
 		std::vector<VkImage> Images;
-		std::vector<VkDeviceMemory> ImageMemorys;
+		std::vector<VulkanAllocation> ImageMemorys;
 		std::vector<VkImageView> ImageViews;
 
 		std::vector<std::vector<VkImage>> AttachmentImages;
-		std::vector<std::vector<VkDeviceMemory>> AttachmentImageMemorys;
+		std::vector<std::vector<VulkanAllocation>> AttachmentImageMemorys;
 		std::vector<std::vector<VkImageView>> AttachmentImageViews;
 
 		std::vector<VkImage> ColorImages;
-		std::vector<VkDeviceMemory> ColorImageMemorys;
+		std::vector<VulkanAllocation> ColorImageMemorys;
 		std::vector<VkImageView> ColorImageViews;
 
 		VkImage DepthImage = nullptr;
-		VkDeviceMemory DepthImageMemory = nullptr;
+		VulkanAllocation DepthImageMemory = {};
 		VkImageView DepthImageView = nullptr;
 
 		VkSampleCountFlagBits MSAASampleCount;
@@ -152,12 +174,10 @@ namespace cv {
 		QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surface);
 		SwapchainSupportDetails QuerySwapchainSupport(VkPhysicalDevice device, VkSurfaceKHR surface);
 
-		uint32_t FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
-
-		void CreateBuffer(VkDevice device, VkPhysicalDevice physicalDevice, const VkAllocationCallbacks* allocator, size_t size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
-		void CopyBuffer(CommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer, size_t bufferSize);
-		void CopyBuffer(VulkanRenderer* renderer, VkBuffer srcBuffer, VkBuffer dstBuffer, size_t bufferSize);
-		void CreateImage(VkDevice device, VkPhysicalDevice physicalDevice, const VkAllocationCallbacks* allocator, uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkSampleCountFlagBits samples, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
+		void CreateBuffer(VkDevice device, VulkanMemoryAllocator* memoryAllocator, const VkAllocationCallbacks* allocator, size_t size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VulkanAllocation& bufferMemory);
+		void CopyBuffer(CommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer, size_t bufferSize, size_t offset = 0);
+		void CopyBuffer(VulkanRenderer* renderer, VkBuffer srcBuffer, VkBuffer dstBuffer, size_t bufferSize, size_t offset = 0);
+		void CreateImage(VkDevice device, VulkanMemoryAllocator* memoryAllocator, const VkAllocationCallbacks* allocator, uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkSampleCountFlagBits samples, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VulkanAllocation& imageMemory);
 		VkImageView CreateImageView(VkDevice device, const VkAllocationCallbacks* allocator, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
 		void TransitionImageLayout(CommandBuffer commandBuffer, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
 		void TransitionImageLayout(VulkanRenderer* renderer, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
@@ -21,6 +21,16 @@ namespace cv {
 			}
 		}
 
+		static VkFormat GetDefaultColorFormat(VulkanRenderer* renderer)
+		{
+			auto& vkd = renderer->GetVulkanData();
+
+			if (vkd.Headless)
+				return vkd.HeadlessImageFormat;
+
+			return vkd.Swapchain->GetNativeData<SwapchainData>().ImageFormat;
+		}
+
 		static VkSampleCountFlagBits GetMaxUsableSampleCount(VulkanRenderer* renderer)
 		{
 			auto& vkd = renderer->GetVulkanData();
@@ -54,8 +64,8 @@ namespace cv {
 
 		auto& vkd = renderer->GetVulkanData();
 
-		Swapchain* swapchain = renderer->GetSwapchain();
-		m_Data->ImageCount = swapchain->GetImageCount();
+		VkFormat defaultFormat = Utils::GetDefaultColorFormat(renderer);
+		m_Data->ImageCount = renderer->GetImageCount();
 
 		if (spec.Multisample)
 			m_Data->MSAASampleCount = Utils::GetMaxUsableSampleCount(renderer);
@@ -96,7 +106,7 @@ namespace cv {
 				VkFormat format = Utils::AttachmentFormatToVkFormat(attachmentFormat);
 				if (format == (VkFormat)0 && attachmentFormat != AttachmentFormat::Depth)
 				{
-					format = swapchain->GetNativeData<SwapchainData>().ImageFormat;
+					format = defaultFormat;
 				}
 				else if (attachmentFormat == AttachmentFormat::Depth)
 				{
@@ -110,7 +120,7 @@ namespace cv {
 
 					Utils::CreateImage(
 						vkd.Device,
-						vkd.PhysicalDevice,
+						vkd.MemoryAllocator,
 						vkd.Allocator,
 						spec.Width,
 						spec.Height,
@@ -134,25 +144,25 @@ namespace cv {
 				{
 					Utils::CreateImage(
 						vkd.Device,
-						vkd.PhysicalDevice,
+						vkd.MemoryAllocator,
 						vkd.Allocator,
 						spec.Width, spec.Height,
 						format,
 						VK_IMAGE_TILING_OPTIMAL,
 						VK_SAMPLE_COUNT_1_BIT,
-						VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+						VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
 						VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 						m_Data->Images[i],
 						m_Data->ImageMemorys[i]
 					);
 
-					m_Data->ImageViews[i] = Utils::CreateImageView(vkd.Device, vkd.Allocator, m_Data->Images[i], swapchain->GetNativeData<SwapchainData>().ImageFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+					m_Data->ImageViews[i] = Utils::CreateImageView(vkd.Device, vkd.Allocator, m_Data->Images[i], defaultFormat, VK_IMAGE_ASPECT_COLOR_BIT);
 				}
 				else
 				{
 					Utils::CreateImage(
 						vkd.Device,
-						vkd.PhysicalDevice,
+						vkd.MemoryAllocator,
 						vkd.Allocator,
 						spec.Width,
 						spec.Height,
@@ -185,7 +195,7 @@ namespace cv {
 				VkFormat format = Utils::AttachmentFormatToVkFormat(attachmentFormat);
 				if (format == (VkFormat)0 && attachmentFormat != AttachmentFormat::Depth)
 				{
-					format = swapchain->GetNativeData<SwapchainData>().ImageFormat;
+					format = defaultFormat;
 				}
 				else if (attachmentFormat == AttachmentFormat::Depth)
 				{
@@ -298,7 +308,7 @@ namespace cv {
 
 				Utils::CreateImage(
 					vkd.Device,
-					vkd.PhysicalDevice,
+					vkd.MemoryAllocator,
 					vkd.Allocator,
 					spec.Width,
 					spec.Height,
@@ -388,9 +398,10 @@ namespace cv {
 		VkResult result = vkCreateSampler(vkd.Device, &samplerInfo, vkd.Allocator, &m_Data->Sampler);
 		VK_CHECK(result, "Failed to create Vulkan sampler!");
 
-		for (uint32_t i = 0; i < m_Data->ImageCount; i++)
+		if (!vkd.Headless)
 		{
-			m_Data->Descriptors[i] = ImGui_ImplVulkan_AddTexture(m_Data->Sampler, m_Data->ImageViews[i], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			for (uint32_t i = 0; i < m_Data->ImageCount; i++)
+				m_Data->Descriptors[i] = ImGui_ImplVulkan_AddTexture(m_Data->Sampler, m_Data->ImageViews[i], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 		}
 
 		m_Data->ClearValues.push_back(VkClearValue{ .color = { 0.0f, 0.0f, 0.0f, 1.0f} }); // main attachment
@@ -412,7 +423,7 @@ namespace cv {
 				for (uint32_t j = 0; j < fbd->ImageCount; j++)
 				{
 					vkDestroyImage(vkd.Device, fbd->AttachmentImages[i][j], vkd.Allocator);
-					vkFreeMemory(vkd.Device, fbd->AttachmentImageMemorys[i][j], vkd.Allocator);
+					vkd.MemoryAllocator->Free(fbd->AttachmentImageMemorys[i][j]);
 					vkDestroyImageView(vkd.Device, fbd->AttachmentImageViews[i][j], vkd.Allocator);
 				}
 			}
@@ -421,19 +432,19 @@ namespace cv {
 			{
 				vkDestroyImageView(vkd.Device, fbd->ColorImageViews[i], vkd.Allocator);
 				vkDestroyImage(vkd.Device, fbd->ColorImages[i], vkd.Allocator);
-				vkFreeMemory(vkd.Device, fbd->ColorImageMemorys[i], vkd.Allocator);
+				vkd.MemoryAllocator->Free(fbd->ColorImageMemorys[i]);
 			}
 
 			vkDestroyImageView(vkd.Device, fbd->DepthImageView, vkd.Allocator);
 			vkDestroyImage(vkd.Device, fbd->DepthImage, vkd.Allocator);
-			vkFreeMemory(vkd.Device, fbd->DepthImageMemory, vkd.Allocator);
+			vkd.MemoryAllocator->Free(fbd->DepthImageMemory);
 
 			for (uint32_t i = 0; i < fbd->ImageCount; i++)
 			{
 				vkDestroyFramebuffer(vkd.Device, fbd->Framebuffers[i], vkd.Allocator);
 				vkDestroyImageView(vkd.Device, fbd->ImageViews[i], vkd.Allocator);
 				vkDestroyImage(vkd.Device, fbd->Images[i], vkd.Allocator);
-				vkFreeMemory(vkd.Device, fbd->ImageMemorys[i], vkd.Allocator);
+				vkd.MemoryAllocator->Free(fbd->ImageMemorys[i]);
 			}
 
 			vkDestroyRenderPass(vkd.Device, fbd->RenderPass, vkd.Allocator);
@@ -445,7 +456,7 @@ namespace cv {
 	void VulkanFramebuffer::BeginRenderPass(CommandBuffer commandBuffer)
 	{
 		auto& vkd = m_Renderer->GetVulkanData();
-		m_Data->ImageIndex = m_Renderer->GetSwapchain()->GetImageIndex();
+		m_Data->ImageIndex = m_Renderer->GetImageIndex();
 
 		VkRenderPassBeginInfo renderPassInfo{};
 		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -476,8 +487,8 @@ namespace cv {
 		std::vector<VkImageView> tempImageViews;
 		for (VkImageView imageView : m_Data->ImageViews)
 			tempImageViews.push_back(imageView);
-		std::vector<VkDeviceMemory> tempDeviceMemorys;
-		for (VkDeviceMemory memory : m_Data->ImageMemorys)
+		std::vector<VulkanAllocation> tempDeviceMemorys;
+		for (VulkanAllocation memory : m_Data->ImageMemorys)
 			tempDeviceMemorys.push_back(memory);
 		std::vector<VkDescriptorSet> tempDescriptors;
 		for (VkDescriptorSet descriptor : m_Data->Descriptors)
@@ -491,11 +502,11 @@ namespace cv {
 
 			tempAttachments.push_back(tempImageAttachment);
 		}
-		std::vector<std::vector<VkDeviceMemory>> tempAttachmentMemorys;
-		for (std::vector<VkDeviceMemory> attachment : m_Data->AttachmentImageMemorys)
+		std::vector<std::vector<VulkanAllocation>> tempAttachmentMemorys;
+		for (std::vector<VulkanAllocation> attachment : m_Data->AttachmentImageMemorys)
 		{
-			std::vector<VkDeviceMemory> tempImageAttachment;
-			for (VkDeviceMemory memory : attachment)
+			std::vector<VulkanAllocation> tempImageAttachment;
+			for (VulkanAllocation memory : attachment)
 				tempImageAttachment.push_back(memory);
 
 			tempAttachmentMemorys.push_back(tempImageAttachment);
@@ -512,8 +523,8 @@ namespace cv {
 		std::vector<VkImage> tempColorImages;
 		for (VkImage colorImage : m_Data->ColorImages)
 			tempColorImages.push_back(colorImage);
-		std::vector<VkDeviceMemory> tempColorMemorys;
-		for (VkDeviceMemory memory : m_Data->ColorImageMemorys)
+		std::vector<VulkanAllocation> tempColorMemorys;
+		for (VulkanAllocation memory : m_Data->ColorImageMemorys)
 			tempColorMemorys.push_back(memory);
 		std::vector<VkImageView> tempColorImageViews;
 		for (VkImageView view : m_Data->ColorImageViews)
@@ -535,7 +546,7 @@ namespace cv {
 				for (uint32_t j = 0; j < imageCount; j++)
 				{
 					vkDestroyImage(vkd.Device, attachments[i][j], vkd.Allocator);
-					vkFreeMemory(vkd.Device, attachmentMemorys[i][j], vkd.Allocator);
+					vkd.MemoryAllocator->Free(attachmentMemorys[i][j]);
 					vkDestroyImageView(vkd.Device, attachmentViews[i][j], vkd.Allocator);
 				}
 			}
@@ -544,21 +555,22 @@ namespace cv {
 			{
 				vkDestroyImageView(vkd.Device, colorViews[i], vkd.Allocator);
 				vkDestroyImage(vkd.Device, colorImages[i], vkd.Allocator);
-				vkFreeMemory(vkd.Device, colorMemorys[i], vkd.Allocator);
+				vkd.MemoryAllocator->Free(colorMemorys[i]);
 			}
 
 			vkDestroyImageView(vkd.Device, depthView, vkd.Allocator);
 			vkDestroyImage(vkd.Device, depthImage, vkd.Allocator);
-			vkFreeMemory(vkd.Device, depthMemory, vkd.Allocator);
+			vkd.MemoryAllocator->Free(depthMemory);
 
 			for (uint32_t i = 0; i < imageCount; i++)
 			{
 				vkDestroyFramebuffer(vkd.Device, framebuffers[i], vkd.Allocator);
 				vkDestroyImageView(vkd.Device, views[i], vkd.Allocator);
 				vkDestroyImage(vkd.Device, images[i], vkd.Allocator);
-				vkFreeMemory(vkd.Device, memorys[i], vkd.Allocator);
+				vkd.MemoryAllocator->Free(memorys[i]);
 
-				ImGui_ImplVulkan_RemoveTexture(descriptors[i]);
+				if (descriptors[i])
+					ImGui_ImplVulkan_RemoveTexture(descriptors[i]);
 			}
 		});
 
@@ -574,14 +586,14 @@ namespace cv {
 		m_Data->Descriptors.clear();
 		m_Data->DepthImage = nullptr;
 		m_Data->DepthImageView = nullptr;
-		m_Data->DepthImageMemory = nullptr;
+		m_Data->DepthImageMemory = {};
 
-		Swapchain* swapchain = m_Renderer->GetSwapchain();
+		VkFormat defaultFormat = Utils::GetDefaultColorFormat(m_Renderer);
 
 		m_Specification.Width = width;
 		m_Specification.Height = height;
 
-		m_Data->ImageCount = swapchain->GetImageCount();
+		m_Data->ImageCount = m_Renderer->GetImageCount();
 
 		if (m_Specification.Multisample)
 			m_Data->MSAASampleCount = Utils::GetMaxUsableSampleCount(m_Renderer);
@@ -622,7 +634,7 @@ namespace cv {
 				VkFormat format = Utils::AttachmentFormatToVkFormat(attachmentFormat);
 				if (format == (VkFormat)0 && attachmentFormat != AttachmentFormat::Depth)
 				{
-					format = swapchain->GetNativeData<SwapchainData>().ImageFormat;
+					format = defaultFormat;
 				}
 				else if (attachmentFormat == AttachmentFormat::Depth)
 				{
@@ -636,7 +648,7 @@ namespace cv {
 
 					Utils::CreateImage(
 						vkd.Device,
-						vkd.PhysicalDevice,
+						vkd.MemoryAllocator,
 						vkd.Allocator,
 						m_Specification.Width,
 						m_Specification.Height,
@@ -660,25 +672,25 @@ namespace cv {
 				{
 					Utils::CreateImage(
 						vkd.Device,
-						vkd.PhysicalDevice,
+						vkd.MemoryAllocator,
 						vkd.Allocator,
 						m_Specification.Width, m_Specification.Height,
 						format,
 						VK_IMAGE_TILING_OPTIMAL,
 						VK_SAMPLE_COUNT_1_BIT,
-						VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+						VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
 						VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 						m_Data->Images[i],
 						m_Data->ImageMemorys[i]
 					);
 
-					m_Data->ImageViews[i] = Utils::CreateImageView(vkd.Device, vkd.Allocator, m_Data->Images[i], swapchain->GetNativeData<SwapchainData>().ImageFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+					m_Data->ImageViews[i] = Utils::CreateImageView(vkd.Device, vkd.Allocator, m_Data->Images[i], defaultFormat, VK_IMAGE_ASPECT_COLOR_BIT);
 				}
 				else
 				{
 					Utils::CreateImage(
 						vkd.Device,
-						vkd.PhysicalDevice,
+						vkd.MemoryAllocator,
 						vkd.Allocator,
 						m_Specification.Width,
 						m_Specification.Height,
@@ -711,7 +723,7 @@ namespace cv {
 				VkFormat format = Utils::AttachmentFormatToVkFormat(attachmentFormat);
 				if (format == (VkFormat)0 && attachmentFormat != AttachmentFormat::Depth)
 				{
-					format = swapchain->GetNativeData<SwapchainData>().ImageFormat;
+					format = defaultFormat;
 				}
 				else if (attachmentFormat == AttachmentFormat::Depth)
 				{
@@ -783,7 +795,7 @@ namespace cv {
 
 				Utils::CreateImage(
 					vkd.Device,
-					vkd.PhysicalDevice,
+					vkd.MemoryAllocator,
 					vkd.Allocator,
 					m_Specification.Width,
 					m_Specification.Height,
@@ -849,9 +861,10 @@ namespace cv {
 			VK_CHECK(result, "Failed to create Vulkan framebuffer!");
 		}
 
-		for (uint32_t i = 0; i < m_Data->ImageCount; i++)
+		if (!vkd.Headless)
 		{
-			m_Data->Descriptors[i] = ImGui_ImplVulkan_AddTexture(m_Data->Sampler, m_Data->ImageViews[i], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			for (uint32_t i = 0; i < m_Data->ImageCount; i++)
+				m_Data->Descriptors[i] = ImGui_ImplVulkan_AddTexture(m_Data->Sampler, m_Data->ImageViews[i], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 		}
 	}
 
@@ -870,7 +883,11 @@ namespace cv {
 
 	void VulkanFramebuffer::CopyAttachmentImageToBuffer(CommandBuffer commandBuffer, uint32_t attachmentIndex, Buffer<StagingBuffer>* buffer)
 	{
-		CV_ASSERT(attachmentIndex > 0 && "Can't copy main color attachment to buffer!");
+		if (attachmentIndex == 0)
+		{
+			CopyMainImageToBuffer(commandBuffer, buffer);
+			return;
+		}
 
 		attachmentIndex--; // account for first color attachment
 
@@ -1036,6 +1053,49 @@ namespace cv {
 		);
 	}
 
+	void VulkanFramebuffer::CopyMainImageToBuffer(CommandBuffer commandBuffer, Buffer<StagingBuffer>* buffer)
+	{
+		// the main image is either rendered to or resolved into, both leave it in shader read layout
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = m_Data->Images[m_Data->ImageIndex];
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+		barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+		vkCmdPipelineBarrier(
+			commandBuffer.As<VkCommandBuffer>(),
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0,
+			0, nullptr,
+			0, nullptr,
+			1, &barrier
+		);
+
+		VkBufferImageCopy region{};
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = 0;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+		region.imageExtent = { m_Specification.Width, m_Specification.Height, 1 };
+
+		vkCmdCopyImageToBuffer(
+			commandBuffer.As<VkCommandBuffer>(),
+			m_Data->Images[m_Data->ImageIndex],
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			buffer->GetNativeData<BufferData>().Buffer,
+			1, &region
+		);
+	}
+
 	void VulkanFramebuffer::CopyAttachmentImageToBuffer(uint32_t attachmentIndex, Buffer<StagingBuffer>* buffer)
 	{
 		CommandBuffer commandBuffer = m_Renderer->BeginSingleTimeCommands();	
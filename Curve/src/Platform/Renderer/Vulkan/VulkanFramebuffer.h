@@ -5,7 +5,6 @@
 
 #include <vector>
 
-enum VkSampleCountFlagBits;
 struct VkRenderPass_T; typedef VkRenderPass_T* VkRenderPass;
 
 namespace cv {
@@ -40,6 +39,8 @@ namespace cv {
 
 		virtual void* GetNativeData() override { return m_Data; }
 		virtual const void* GetNativeData() const override { return m_Data; }
+	private:
+		void CopyMainImageToBuffer(CommandBuffer commandBuffer, Buffer<StagingBuffer>* buffer);
 	private:
 		VulkanRenderer* m_Renderer = nullptr;
 		FramebufferSpecification m_Specification;
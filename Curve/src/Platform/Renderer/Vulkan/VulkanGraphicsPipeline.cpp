@@ -279,7 +279,7 @@ namespace cv {
 		pipelineInfo.renderPass = vkd.Swapchain->GetNativeData<SwapchainData>().RenderPass;
 		pipelineInfo.subpass = 0;
 
-		result = vkCreateGraphicsPipelines(vkd.Device, nullptr, 1, &pipelineInfo, vkd.Allocator, &m_Data->Pipeline);
+		result = vkCreateGraphicsPipelines(vkd.Device, vkd.PipelineCache, 1, &pipelineInfo, vkd.Allocator, &m_Data->Pipeline);
 		VK_CHECK(result, "Failed to create Vulkan graphics pipeline!");
 	}
 
@@ -497,7 +497,7 @@ namespace cv {
 		pipelineInfo.renderPass = framebuffer->GetNativeData<FramebufferData>().RenderPass;
 		pipelineInfo.subpass = 0;
 
-		result = vkCreateGraphicsPipelines(vkd.Device, nullptr, 1, &pipelineInfo, vkd.Allocator, &m_Data->Pipeline);
+		result = vkCreateGraphicsPipelines(vkd.Device, vkd.PipelineCache, 1, &pipelineInfo, vkd.Allocator, &m_Data->Pipeline);
 		VK_CHECK(result, "Failed to create Vulkan graphics pipeline!");
 	}
 
@@ -515,7 +515,12 @@ namespace cv {
 
 	void VulkanGraphicsPipeline::Bind(CommandBuffer commandBuffer) const
 	{
-		auto& scd = m_Renderer->GetVulkanData().Swapchain->GetNativeData<SwapchainData>();
+		// headless renderers have no swapchain, so only touch it for pipelines without a framebuffer
+		VkExtent2D extent{};
+		if (m_Framebuffer)
+			extent = { m_Framebuffer->GetWidth(), m_Framebuffer->GetHeight() };
+		else
+			extent = m_Renderer->GetVulkanData().Swapchain->GetNativeData<SwapchainData>().Extent;
 
 		VkCommandBuffer cmd = commandBuffer.As<VkCommandBuffer>();
 
@@ -524,26 +529,15 @@ namespace cv {
 		VkViewport viewport{};
 		viewport.x = 0.0f;
 		viewport.y = 0.0f;
-		if (m_Framebuffer)
-		{
-			viewport.width = (float)m_Framebuffer->GetWidth();
-			viewport.height = (float)m_Framebuffer->GetHeight();
-		}
-		else
-		{
-			viewport.width = (float)scd.Extent.width;
-			viewport.height = (float)scd.Extent.height;
-		}
+		viewport.width = (float)extent.width;
+		viewport.height = (float)extent.height;
 		viewport.minDepth = 0.0f;
 		viewport.maxDepth = 1.0f;
 		vkCmdSetViewport(cmd, 0, 1, &viewport);
 
 		VkRect2D scissor{};
 		scissor.offset = { 0, 0 };
-		if (m_Framebuffer)
-			scissor.extent = { m_Framebuffer->GetWidth(), m_Framebuffer->GetHeight() };
-		else
-			scissor.extent = scd.Extent;
+		scissor.extent = extent;
 		vkCmdSetScissor(cmd, 0, 1, &scissor);
 	}
 
@@ -557,4 +551,37 @@ namespace cv {
 		vkCmdSetLineWidth(commandBuffer.As<VkCommandBuffer>(), lineWidth);
 	}
 
+	void VulkanGraphicsPipeline::UpdateDescriptor(BufferBase* buffer, uint32_t binding, uint32_t index)
+	{
+		auto& vkd = m_Renderer->GetVulkanData();
+
+		VkDescriptorBufferInfo bufferInfo{};
+		bufferInfo.buffer = ((BufferData*)buffer->GetNativeData())->Buffer;
+		bufferInfo.range = buffer->GetSize();
+		bufferInfo.offset = 0;
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = m_Data->DescriptorSet;
+		write.dstBinding = binding;
+		write.dstArrayElement = index;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		write.descriptorCount = 1;
+		write.pBufferInfo = &bufferInfo;
+
+		vkUpdateDescriptorSets(vkd.Device, 1, &write, 0, nullptr);
+	}
+
+	void VulkanGraphicsPipeline::BindDescriptor(CommandBuffer commandBuffer) const
+	{
+		vkCmdBindDescriptorSets(
+			commandBuffer.As<VkCommandBuffer>(),
+			VK_PIPELINE_BIND_POINT_GRAPHICS,
+			m_Data->PipelineLayout,
+			0,
+			1, &m_Data->DescriptorSet,
+			0, nullptr
+		);
+	}
+
 }
@@ -19,6 +19,9 @@ namespace cv {
 		virtual void PushConstants(CommandBuffer commandBuffer, ShaderStage shaderStage, size_t size, const void* data, size_t offset = 0) override;
 		virtual void SetLineWidth(CommandBuffer commandBuffer, float lineWidth) override;
 
+		virtual void UpdateDescriptor(BufferBase* buffer, uint32_t binding, uint32_t index) override;
+		virtual void BindDescriptor(CommandBuffer commandBuffer) const override;
+
 		virtual void* GetNativeData() override { return m_Data; }
 		virtual const void* GetNativeData() const override { return m_Data; }
 	private:
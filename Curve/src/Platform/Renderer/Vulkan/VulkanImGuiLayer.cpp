@@ -8,7 +8,7 @@
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_vulkan.h>
 
-#include <glfw/glfw3.h>
+#include <GLFW/glfw3.h>
 
 namespace cv {
 
@@ -64,7 +64,7 @@ namespace cv {
 		initInfo.Device = vkd.Device;
 		initInfo.QueueFamily = Utils::FindQueueFamilies(vkd.PhysicalDevice, vkd.Surface).GraphicsFamily;
 		initInfo.Queue = vkd.GraphicsQueue;
-		initInfo.PipelineCache = nullptr;
+		initInfo.PipelineCache = vkd.PipelineCache;
 		initInfo.DescriptorPool = m_Data->DescriptorPool;
 		initInfo.RenderPass = swapchain->GetNativeData<SwapchainData>().RenderPass;
 		initInfo.Subpass = 0;
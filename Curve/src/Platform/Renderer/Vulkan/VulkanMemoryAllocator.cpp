@@ -0,0 +1,289 @@
+#include "cvpch.h"
+#include "VulkanMemoryAllocator.h"
+
+#include "VulkanRenderer.h"
+
+#include <bit>
+
+namespace cv {
+
+	static constexpr VkDeviceSize s_BlockSize = 64ull << 20;
+	static constexpr VkDeviceSize s_SlotBlockSize = 4ull << 20;
+
+	struct VulkanMemoryBlock
+	{
+		VkDeviceMemory Memory = nullptr;
+		VkDeviceSize Size = 0;
+		void* Mapped = nullptr;
+
+		uint32_t PoolIndex = 0;
+		bool Dedicated = false;
+
+		// slot blocks, SlotSize is 0 for the others
+		VkDeviceSize SlotSize = 0;
+		std::vector<uint32_t> FreeSlots;
+
+		// free-list blocks, offset to size
+		std::map<VkDeviceSize, VkDeviceSize> FreeRanges;
+		VkDeviceSize FreeSize = 0;
+	};
+
+	namespace Utils {
+
+		static uint32_t FindMemoryType(const VkPhysicalDeviceMemoryProperties& memProperties, uint32_t typeFilter, VkMemoryPropertyFlags properties)
+		{
+			for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
+			{
+				if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
+					return i;
+			}
+
+			CV_ASSERT(false && "Failed to find suitable memory type!");
+			return 0;
+		}
+
+		static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+
+		static VulkanAllocation MakeAllocation(VulkanMemoryBlock* block, VkDeviceSize offset, VkDeviceSize size)
+		{
+			VulkanAllocation allocation{};
+			allocation.Memory = block->Memory;
+			allocation.Offset = offset;
+			allocation.Size = size;
+			allocation.Mapped = block->Mapped ? (uint8_t*)block->Mapped + offset : nullptr;
+			allocation.Block = block;
+			return allocation;
+		}
+
+	}
+
+	VulkanMemoryAllocator::VulkanMemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice, const VkAllocationCallbacks* allocator)
+		: m_Device(device), m_Allocator(allocator)
+	{
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_MemoryProperties);
+
+		VkPhysicalDeviceProperties properties{};
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+		m_MaxDeviceAllocationCount = properties.limits.maxMemoryAllocationCount;
+
+		// discrete cards with resizable BAR have host visible VRAM as well, but reading it back over the bus is slow
+		bool integrated = properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU || properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU;
+		VkMemoryPropertyFlags unifiedFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+		for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++)
+		{
+			VkDeviceSize heapSize = m_MemoryProperties.memoryHeaps[m_MemoryProperties.memoryTypes[i].heapIndex].size;
+			m_BlockSizes[i] = std::min(s_BlockSize, std::bit_floor(std::max<VkDeviceSize>(heapSize / 8, s_SlotBlockSize)));
+
+			if (integrated && (m_MemoryProperties.memoryTypes[i].propertyFlags & unifiedFlags) == unifiedFlags)
+				m_UnifiedMemory = true;
+		}
+
+		m_Pools.resize(m_MemoryProperties.memoryTypeCount * 2);
+	}
+
+	VulkanMemoryAllocator::~VulkanMemoryAllocator()
+	{
+		for (Pool& pool : m_Pools)
+		{
+			for (auto& blocks : pool.SlotBlocks)
+			{
+				for (VulkanMemoryBlock* block : blocks)
+					DestroyBlock(block);
+			}
+
+			for (VulkanMemoryBlock* block : pool.FreeListBlocks)
+				DestroyBlock(block);
+		}
+	}
+
+	VulkanAllocation VulkanMemoryAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, VulkanResourceType type)
+	{
+		std::lock_guard lock(m_Mutex);
+
+		uint32_t memoryType = Utils::FindMemoryType(m_MemoryProperties, requirements.memoryTypeBits, properties);
+		uint32_t poolIndex = memoryType * 2 + (uint32_t)type;
+
+		// a slot is aligned to its own size, the alignment is a power of two so it only has to be part of the size class
+		VkDeviceSize slotSize = std::bit_ceil(std::max({ requirements.size, requirements.alignment, (VkDeviceSize)1 << s_MinSlotSizeLog2 }));
+		if (slotSize <= ((VkDeviceSize)1 << s_MaxSlotSizeLog2) && slotSize <= m_BlockSizes[memoryType] / 2)
+			return AllocateSlot(poolIndex, (uint32_t)std::countr_zero(slotSize) - s_MinSlotSizeLog2);
+
+		if (requirements.size > m_BlockSizes[memoryType] / 2)
+			return AllocateDedicated(poolIndex, requirements.size);
+
+		return AllocateRange(poolIndex, requirements.size, requirements.alignment);
+	}
+
+	void VulkanMemoryAllocator::Free(const VulkanAllocation& allocation)
+	{
+		VulkanMemoryBlock* block = allocation.Block;
+		if (!block)
+			return;
+
+		std::lock_guard lock(m_Mutex);
+
+		if (block->Dedicated)
+		{
+			DestroyBlock(block);
+			return;
+		}
+
+		Pool& pool = m_Pools[block->PoolIndex];
+		if (block->SlotSize > 0)
+		{
+			block->FreeSlots.push_back((uint32_t)(allocation.Offset / block->SlotSize));
+			if (block->FreeSlots.size() == block->Size / block->SlotSize)
+				ReleaseBlock(pool.SlotBlocks[std::countr_zero(block->SlotSize) - s_MinSlotSizeLog2], block);
+			return;
+		}
+
+		VkDeviceSize offset = allocation.Offset, size = allocation.Size;
+		block->FreeSize += size;
+
+		auto next = block->FreeRanges.lower_bound(offset);
+		if (next != block->FreeRanges.end() && offset + size == next->first)
+		{
+			size += next->second;
+			next = block->FreeRanges.erase(next);
+		}
+
+		auto range = block->FreeRanges.emplace_hint(next, offset, size);
+		if (range != block->FreeRanges.begin())
+		{
+			auto previous = std::prev(range);
+			if (previous->first + previous->second == offset)
+			{
+				previous->second += size;
+				block->FreeRanges.erase(range);
+			}
+		}
+
+		if (block->FreeSize == block->Size)
+			ReleaseBlock(pool.FreeListBlocks, block);
+	}
+
+	VulkanAllocation VulkanMemoryAllocator::AllocateSlot(uint32_t poolIndex, uint32_t sizeClass)
+	{
+		std::vector<VulkanMemoryBlock*>& blocks = m_Pools[poolIndex].SlotBlocks[sizeClass];
+		VkDeviceSize slotSize = (VkDeviceSize)1 << (sizeClass + s_MinSlotSizeLog2);
+
+		auto block = std::find_if(blocks.begin(), blocks.end(), [](VulkanMemoryBlock* block) { return !block->FreeSlots.empty(); });
+		if (block == blocks.end())
+		{
+			VulkanMemoryBlock* newBlock = CreateBlock(poolIndex, std::min(s_SlotBlockSize, m_BlockSizes[poolIndex / 2]));
+			newBlock->SlotSize = slotSize;
+
+			// handed out from the front of the block first
+			uint32_t slotCount = (uint32_t)(newBlock->Size / slotSize);
+			newBlock->FreeSlots.resize(slotCount);
+			for (uint32_t i = 0; i < slotCount; i++)
+				newBlock->FreeSlots[i] = slotCount - 1 - i;
+
+			blocks.push_back(newBlock);
+			block = blocks.end() - 1;
+		}
+
+		uint32_t slot = (*block)->FreeSlots.back();
+		(*block)->FreeSlots.pop_back();
+		return Utils::MakeAllocation(*block, slot * slotSize, slotSize);
+	}
+
+	VulkanAllocation VulkanMemoryAllocator::AllocateRange(uint32_t poolIndex, VkDeviceSize size, VkDeviceSize alignment)
+	{
+		std::vector<VulkanMemoryBlock*>& blocks = m_Pools[poolIndex].FreeListBlocks;
+
+		for (int attempt = 0; attempt < 2; attempt++)
+		{
+			for (VulkanMemoryBlock* block : blocks)
+			{
+				if (block->FreeSize < size)
+					continue;
+
+				for (auto it = block->FreeRanges.begin(); it != block->FreeRanges.end(); it++)
+				{
+					auto [offset, freeSize] = *it;
+					VkDeviceSize aligned = Utils::AlignUp(offset, alignment);
+					if (aligned + size > offset + freeSize)
+						continue;
+
+					// the padding in front stays free, it's merged back once the range before it is freed
+					block->FreeRanges.erase(it);
+					if (aligned > offset)
+						block->FreeRanges.emplace(offset, aligned - offset);
+					if (aligned + size < offset + freeSize)
+						block->FreeRanges.emplace(aligned + size, offset + freeSize - aligned - size);
+
+					block->FreeSize -= size;
+					return Utils::MakeAllocation(block, aligned, size);
+				}
+			}
+
+			VulkanMemoryBlock* block = CreateBlock(poolIndex, m_BlockSizes[poolIndex / 2]);
+			block->FreeRanges.emplace(0, block->Size);
+			block->FreeSize = block->Size;
+			blocks.push_back(block);
+		}
+
+		CV_ASSERT(false && "Failed to sub-allocate Vulkan memory!");
+		return {};
+	}
+
+	VulkanAllocation VulkanMemoryAllocator::AllocateDedicated(uint32_t poolIndex, VkDeviceSize size)
+	{
+		VulkanMemoryBlock* block = CreateBlock(poolIndex, size);
+		block->Dedicated = true;
+		return Utils::MakeAllocation(block, 0, size);
+	}
+
+	VulkanMemoryBlock* VulkanMemoryAllocator::CreateBlock(uint32_t poolIndex, VkDeviceSize size)
+	{
+		uint32_t memoryType = poolIndex / 2;
+		CV_ASSERT(m_DeviceAllocationCount < m_MaxDeviceAllocationCount && "Too many Vulkan memory allocations!");
+
+		VulkanMemoryBlock* block = new VulkanMemoryBlock();
+		block->Size = size;
+		block->PoolIndex = poolIndex;
+
+		VkMemoryAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = size;
+		allocInfo.memoryTypeIndex = memoryType;
+
+		VkResult result = vkAllocateMemory(m_Device, &allocInfo, m_Allocator, &block->Memory);
+		VK_CHECK(result, "Failed to allocate Vulkan memory!");
+		m_DeviceAllocationCount++;
+
+		if (m_MemoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+		{
+			result = vkMapMemory(m_Device, block->Memory, 0, VK_WHOLE_SIZE, 0, &block->Mapped);
+			VK_CHECK(result, "Failed to map Vulkan memory!");
+		}
+
+		return block;
+	}
+
+	void VulkanMemoryAllocator::DestroyBlock(VulkanMemoryBlock* block)
+	{
+		if (block->Mapped)
+			vkUnmapMemory(m_Device, block->Memory);
+
+		vkFreeMemory(m_Device, block->Memory, m_Allocator);
+		m_DeviceAllocationCount--;
+
+		delete block;
+	}
+
+	void VulkanMemoryAllocator::ReleaseBlock(std::vector<VulkanMemoryBlock*>& blocks, VulkanMemoryBlock* block)
+	{
+		if (blocks.size() <= 1)
+			return;
+
+		blocks.erase(std::find(blocks.begin(), blocks.end(), block));
+		DestroyBlock(block);
+	}
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <map>
+#include <array>
+#include <mutex>
+#include <vector>
+
+namespace cv {
+
+	struct VulkanMemoryBlock;
+
+	// buffers and images never share a block, so bufferImageGranularity doesn't have to be padded for
+	enum class VulkanResourceType
+	{
+		Buffer = 0,
+		Image
+	};
+
+	// a range of a VkDeviceMemory handed out by VulkanMemoryAllocator, bind the resource at Offset
+	struct VulkanAllocation
+	{
+		VkDeviceMemory Memory = nullptr;
+		VkDeviceSize Offset = 0;
+		VkDeviceSize Size = 0;
+
+		// the start of the range if the memory is host visible, blocks stay mapped for as long as they live
+		void* Mapped = nullptr;
+
+		VulkanMemoryBlock* Block = nullptr;
+	};
+
+	// sub-allocates device memory out of large blocks, so creating a buffer or an image doesn't cost a vkAllocateMemory and
+	// the amount of device allocations stays far below maxMemoryAllocationCount, there's a set of pools per memory type
+	// - requests up to s_MaxSlotSize are rounded up to a power of two size class, the blocks of a class are split into equal slots
+	// - bigger ones are placed first fit into free-list blocks, a freed range is merged with the free ones next to it
+	// - anything bigger than half a block gets a device allocation of its own
+	class VulkanMemoryAllocator
+	{
+	public:
+		VulkanMemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice, const VkAllocationCallbacks* allocator);
+		~VulkanMemoryAllocator();
+
+		VulkanAllocation Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, VulkanResourceType type);
+		void Free(const VulkanAllocation& allocation);
+
+		// the live vkAllocateMemory allocations
+		uint32_t GetDeviceAllocationCount() const { return m_DeviceAllocationCount; }
+
+		// integrated and CPU devices whose device local memory can be mapped, buffers can be written in place there
+		bool IsUnifiedMemory() const { return m_UnifiedMemory; }
+	private:
+		static constexpr uint32_t s_MinSlotSizeLog2 = 8;
+		static constexpr uint32_t s_MaxSlotSizeLog2 = 18;
+		static constexpr uint32_t s_SizeClassCount = s_MaxSlotSizeLog2 - s_MinSlotSizeLog2 + 1;
+
+		struct Pool
+		{
+			std::array<std::vector<VulkanMemoryBlock*>, s_SizeClassCount> SlotBlocks;
+			std::vector<VulkanMemoryBlock*> FreeListBlocks;
+		};
+
+		VulkanAllocation AllocateSlot(uint32_t poolIndex, uint32_t sizeClass);
+		VulkanAllocation AllocateRange(uint32_t poolIndex, VkDeviceSize size, VkDeviceSize alignment);
+		VulkanAllocation AllocateDedicated(uint32_t poolIndex, VkDeviceSize size);
+
+		VulkanMemoryBlock* CreateBlock(uint32_t poolIndex, VkDeviceSize size);
+		void DestroyBlock(VulkanMemoryBlock* block);
+
+		// a block that became empty is given back unless it's the last one of its kind, so a resize doesn't allocate it again
+		void ReleaseBlock(std::vector<VulkanMemoryBlock*>& blocks, VulkanMemoryBlock* block);
+	private:
+		VkDevice m_Device = nullptr;
+		const VkAllocationCallbacks* m_Allocator = nullptr;
+
+		VkPhysicalDeviceMemoryProperties m_MemoryProperties{};
+		uint32_t m_MaxDeviceAllocationCount = 0;
+		uint32_t m_DeviceAllocationCount = 0;
+		bool m_UnifiedMemory = false;
+
+		// per memory type, smaller for small heaps such as the host visible part of VRAM
+		std::array<VkDeviceSize, VK_MAX_MEMORY_TYPES> m_BlockSizes = {};
+
+		// m_Pools[memoryType * 2 + resourceType]
+		std::vector<Pool> m_Pools;
+
+		std::mutex m_Mutex;
+	};
+
+}
@@ -27,16 +27,53 @@ namespace cv {
 #endif
 
 	const static std::vector<const char*> s_DeviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+	const static std::vector<const char*> s_HeadlessDeviceExtensions = {};
 	const static std::vector<const char*> s_ValidationLayers = { "VK_LAYER_KHRONOS_validation" };
 
 	namespace Utils {
 
-		static std::vector<const char*> GetRequiredExtensions()
+		static const char* GetPipelineCachePath()
 		{
-			uint32_t glfwExtensionCount = 0;
-			const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+			return "assets/cache/vulkan_pipeline.cache";
+		}
+
+		// written in front of the cache data, a cache from another device or driver is thrown away instead of handed to the driver
+		struct PipelineCacheHeader
+		{
+			static constexpr uint32_t CurrentMagic = 0x43504356; // "VCPC"
+
+			uint32_t Magic = CurrentMagic;
+			uint32_t VendorID = 0;
+			uint32_t DeviceID = 0;
+			uint32_t DriverVersion = 0;
+			uint8_t CacheUUID[VK_UUID_SIZE] = {};
+			uint64_t DataSize = 0;
+		};
+
+		static PipelineCacheHeader GetPipelineCacheHeader(VkPhysicalDevice physicalDevice)
+		{
+			VkPhysicalDeviceProperties properties{};
+			vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+			PipelineCacheHeader header{};
+			header.VendorID = properties.vendorID;
+			header.DeviceID = properties.deviceID;
+			header.DriverVersion = properties.driverVersion;
+			memcpy(header.CacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+			return header;
+		}
+
+		static std::vector<const char*> GetRequiredExtensions(bool headless)
+		{
+			std::vector<const char*> extensions;
 
-			std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+			if (!headless)
+			{
+				uint32_t glfwExtensionCount = 0;
+				const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+
+				extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+			}
 
 			if (s_EnableValidationLayers)
 			{
@@ -141,10 +178,13 @@ namespace cv {
 					indices.GraphicsFamily = i;
 
 				VkBool32 presentSupport = VK_FALSE;
-				vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+				if (surface)
+					vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
 
 				if (presentSupport)
 					indices.PresentFamily = i;
+				else if (!surface)
+					indices.PresentFamily = indices.GraphicsFamily; // headless renderers never present
 
 				if (indices.IsComplete())
 					break;
@@ -155,7 +195,7 @@ namespace cv {
 			return indices;
 		}
 
-		static bool CheckDeviceExtensionSupport(VkPhysicalDevice device)
+		static bool CheckDeviceExtensionSupport(VkPhysicalDevice device, const std::vector<const char*>& deviceExtensions)
 		{
 			uint32_t extensionCount;
 			vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
@@ -165,7 +205,7 @@ namespace cv {
 
 			std::set<std::string> requiredExtensions;
 
-			for (const char* ext : s_DeviceExtensions)
+			for (const char* ext : deviceExtensions)
 				requiredExtensions.insert(std::string(ext));
 
 			for (const auto& extension : availableExtensions)
@@ -203,22 +243,7 @@ namespace cv {
 			return details;
 		}
 
-		uint32_t FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties)
-		{
-			VkPhysicalDeviceMemoryProperties memProperties;
-			vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
-
-			for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
-			{
-				if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
-					return i;
-			}
-
-			CV_ASSERT(false && "Failed to find suitable memory type!");
-			return 0;
-		}
-
-		void CreateBuffer(VkDevice device, VkPhysicalDevice physicalDevice, const VkAllocationCallbacks* allocator, size_t size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+		void CreateBuffer(VkDevice device, VulkanMemoryAllocator* memoryAllocator, const VkAllocationCallbacks* allocator, size_t size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VulkanAllocation& bufferMemory)
 		{
 			VkBufferCreateInfo bufferInfo{};
 			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -232,22 +257,15 @@ namespace cv {
 			VkMemoryRequirements memRequirements;
 			vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
 
-			VkMemoryAllocateInfo allocInfo{};
-			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-			allocInfo.allocationSize = memRequirements.size;
-			allocInfo.memoryTypeIndex = FindMemoryType(physicalDevice, memRequirements.memoryTypeBits, properties);
-
-			result = vkAllocateMemory(device, &allocInfo, allocator, &bufferMemory);
-			VK_CHECK(result, "Failed to allocate Vulkan memory!");
-
-			vkBindBufferMemory(device, buffer, bufferMemory, 0);
+			bufferMemory = memoryAllocator->Allocate(memRequirements, properties, VulkanResourceType::Buffer);
+			vkBindBufferMemory(device, buffer, bufferMemory.Memory, bufferMemory.Offset);
 		}
 
-		void CopyBuffer(CommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer, size_t bufferSize)
+		void CopyBuffer(CommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer, size_t bufferSize, size_t offset)
 		{
 			VkBufferCopy copyRegion{};
-			copyRegion.srcOffset = 0;
-			copyRegion.dstOffset = 0;
+			copyRegion.srcOffset = offset;
+			copyRegion.dstOffset = offset;
 			copyRegion.size = bufferSize;
 
 			vkCmdCopyBuffer(
@@ -258,14 +276,14 @@ namespace cv {
 			);
 		}
 
-		void CopyBuffer(VulkanRenderer* renderer, VkBuffer srcBuffer, VkBuffer dstBuffer, size_t bufferSize)
+		void CopyBuffer(VulkanRenderer* renderer, VkBuffer srcBuffer, VkBuffer dstBuffer, size_t bufferSize, size_t offset)
 		{
 			CommandBuffer commandBuffer = renderer->BeginSingleTimeCommands();
-			CopyBuffer(commandBuffer, srcBuffer, dstBuffer, bufferSize);
+			CopyBuffer(commandBuffer, srcBuffer, dstBuffer, bufferSize, offset);
 			renderer->EndSingleTimeCommands(commandBuffer);
 		}
 
-		void CreateImage(VkDevice device, VkPhysicalDevice physicalDevice, const VkAllocationCallbacks* allocator, uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkSampleCountFlagBits samples, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory)
+		void CreateImage(VkDevice device, VulkanMemoryAllocator* memoryAllocator, const VkAllocationCallbacks* allocator, uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkSampleCountFlagBits samples, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VulkanAllocation& imageMemory)
 		{
 			VkImageCreateInfo imageInfo{};
 			imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -288,15 +306,8 @@ namespace cv {
 			VkMemoryRequirements memRequirements;
 			vkGetImageMemoryRequirements(device, image, &memRequirements);
 
-			VkMemoryAllocateInfo allocInfo{};
-			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-			allocInfo.allocationSize = memRequirements.size;
-			allocInfo.memoryTypeIndex = FindMemoryType(physicalDevice, memRequirements.memoryTypeBits, properties);
-
-			result = vkAllocateMemory(device, &allocInfo, allocator, &imageMemory);
-			VK_CHECK(result, "Failed to allocate Vulkan memory!");
-
-			vkBindImageMemory(device, image, imageMemory, 0);
+			imageMemory = memoryAllocator->Allocate(memRequirements, properties, VulkanResourceType::Image);
+			vkBindImageMemory(device, image, imageMemory.Memory, imageMemory.Offset);
 		}
 
 		VkImageView CreateImageView(VkDevice device, const VkAllocationCallbacks* allocator, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags)
@@ -401,10 +412,10 @@ namespace cv {
 		{
 			QueueFamilyIndices indices = FindQueueFamilies(device, surface);
 
-			bool extensionsSupported = CheckDeviceExtensionSupport(device);
+			bool extensionsSupported = CheckDeviceExtensionSupport(device, surface ? s_DeviceExtensions : s_HeadlessDeviceExtensions);
 
-			bool swapchainAdequate = false;
-			if (extensionsSupported)
+			bool swapchainAdequate = surface == nullptr;
+			if (extensionsSupported && surface)
 			{
 				SwapchainSupportDetails swapChainSupport = QuerySwapchainSupport(device, surface);
 				swapchainAdequate = !swapChainSupport.Formats.empty() && !swapChainSupport.PresentModes.empty();
@@ -420,7 +431,9 @@ namespace cv {
 				supportedFeatures.samplerAnisotropy &&
 				supportedFeatures.wideLines &&
 				supportedFeatures.fragmentStoresAndAtomics &&
-				supportedFeatures.independentBlend;
+				supportedFeatures.independentBlend &&
+				supportedFeatures.multiDrawIndirect &&
+				supportedFeatures.drawIndirectFirstInstance;
 		}
 
 		static VkSampleCountFlagBits GetMaxUsableSampleCount(VkPhysicalDevice device)
@@ -452,27 +465,35 @@ namespace cv {
 
 	}
 
-	VulkanRenderer::VulkanRenderer(Window& window)
-		: m_Window(window)
+	VulkanRenderer::VulkanRenderer(Window& window, const RendererSpecification& spec)
+		: m_Window(window), m_Specification(spec)
 	{
 		CV_TAG("Renderer:Vulkan");
 
 		m_VkD = new VulkanData();
+		m_VkD->Headless = spec.Headless;
 
 		CreateInstance();
 		SetupDebugMessenger();
-		CreateSurface();
+		if (!m_VkD->Headless)
+			CreateSurface();
 		PickPhysicalDevice();
 		CreateLogicalDevice();
+		m_VkD->MemoryAllocator = new VulkanMemoryAllocator(m_VkD->Device, m_VkD->PhysicalDevice, m_VkD->Allocator);
 		CreateCommandPool();
 		CreateDescriptorPool();
 		CreateSyncObjects();
+		CreatePipelineCache();
+		m_VkD->UploadManager = new VulkanUploadManager(this);
 
-		SwapchainSpecification spec{};
-		spec.Attachments = { AttachmentFormat::Default, AttachmentFormat::Depth };
-		spec.Multisample = true;
+		if (!m_VkD->Headless)
+		{
+			SwapchainSpecification swapchainSpec{};
+			swapchainSpec.Attachments = { AttachmentFormat::Default, AttachmentFormat::Depth };
+			swapchainSpec.Multisample = true;
 
-		m_VkD->Swapchain = CreateSwapchain(spec);
+			m_VkD->Swapchain = CreateSwapchain(swapchainSpec);
+		}
 
 		VkPhysicalDeviceProperties properties{};
 		vkGetPhysicalDeviceProperties(m_VkD->PhysicalDevice, &properties);
@@ -484,12 +505,23 @@ namespace cv {
 
 		delete m_VkD->Swapchain;
 
+		for (auto& queue : m_VkD->PendingResourceFreeQueue)
+		{
+			for (auto& func : queue)
+				func(this);
+		}
+
 		for (auto& queue : m_VkD->ResourceFreeQueue)
 		{
 			for (auto& func : queue)
 				func(this);
 		}
 
+		delete m_VkD->UploadManager;
+
+		SavePipelineCache();
+		vkDestroyPipelineCache(m_VkD->Device, m_VkD->PipelineCache, m_VkD->Allocator);
+
 		for (size_t i = 0; i < CV_FRAMES_IN_FLIGHT; i++)
 		{
 			for (size_t j = 0; j < CV_MAX_SUBMITS_PER_FRAME; j++)
@@ -502,8 +534,11 @@ namespace cv {
 		vkDestroyDescriptorPool(m_VkD->Device, m_VkD->DescriptorPool, m_VkD->Allocator);
 		vkDestroyCommandPool(m_VkD->Device, m_VkD->CommandPool, m_VkD->Allocator);
 
+		delete m_VkD->MemoryAllocator;
+
 		vkDestroyDevice(m_VkD->Device, m_VkD->Allocator);
-		vkDestroySurfaceKHR(m_VkD->Instance, m_VkD->Surface, m_VkD->Allocator);
+		if (m_VkD->Surface)
+			vkDestroySurfaceKHR(m_VkD->Instance, m_VkD->Surface, m_VkD->Allocator);
 
 		if (s_EnableValidationLayers)
 			Utils::DestroyDebugUtilsMessengerEXT(m_VkD->Instance, m_VkD->DebugMessenger, m_VkD->Allocator);
@@ -521,17 +556,64 @@ namespace cv {
 
 		m_VkD->FrameSuccess[m_VkD->CurrentFrameIndex] = true;
 
-		uint32_t imageIndex;
-		if (!m_VkD->Swapchain->AcquireNextImage(imageIndex))
+		if (m_VkD->Headless)
 		{
-			m_VkD->FrameSuccess[m_VkD->CurrentFrameIndex] = false;
+			auto& inUseFences = m_VkD->InUseFences[m_VkD->CurrentFrameIndex];
+
+			if (!inUseFences.empty())
+			{
+				vkWaitForFences(m_VkD->Device, (uint32_t)inUseFences.size(), inUseFences.data(), VK_TRUE, std::numeric_limits<uint64_t>::max());
+				vkResetFences(m_VkD->Device, (uint32_t)inUseFences.size(), inUseFences.data());
+			}
+
+			m_VkD->InUseSemaphores[m_VkD->CurrentFrameIndex].clear();
+			inUseFences.clear();
+
+			m_VkD->UploadManager->BeginFrame();
+			RunResourceFrees();
 			return;
 		}
+
+		// waits for the frame's fences even if the swapchain has to be recreated
+		uint32_t imageIndex;
+		bool acquired = m_VkD->Swapchain->AcquireNextImage(imageIndex);
+		m_VkD->UploadManager->BeginFrame();
+		RunResourceFrees();
+
+		if (!acquired)
+			m_VkD->FrameSuccess[m_VkD->CurrentFrameIndex] = false;
 	}
 
 	void VulkanRenderer::EndFrame()
 	{
-		if (m_VkD->FrameSuccess[m_VkD->CurrentFrameIndex])
+		// uploads after the last submit are on the GPU by the next frame
+		m_VkD->UploadManager->Flush();
+
+		if (m_VkD->Headless)
+		{
+			// nothing presents, so the last submit's semaphore is consumed by an empty submit instead
+			auto& inUseSemaphores = m_VkD->InUseSemaphores[m_VkD->CurrentFrameIndex];
+
+			if (!inUseSemaphores.empty())
+			{
+				std::vector<VkPipelineStageFlags> waitStages(inUseSemaphores.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
+				VkSubmitInfo submitInfo{};
+				submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+				submitInfo.waitSemaphoreCount = (uint32_t)inUseSemaphores.size();
+				submitInfo.pWaitSemaphores = inUseSemaphores.data();
+				submitInfo.pWaitDstStageMask = waitStages.data();
+
+				VkFence fence = GetNextFrameFence();
+
+				VkResult result = vkQueueSubmit(m_VkD->GraphicsQueue, 1, &submitInfo, fence);
+				VK_CHECK(result, "Failed to submit to Vulkan queue!");
+
+				m_VkD->InUseFences[m_VkD->CurrentFrameIndex].push_back(fence);
+				inUseSemaphores.clear();
+			}
+		}
+		else if (m_VkD->FrameSuccess[m_VkD->CurrentFrameIndex])
 		{
 			auto& scd = m_VkD->Swapchain->GetNativeData<SwapchainData>();
 
@@ -554,18 +636,41 @@ namespace cv {
 			}
 		}
 
-		for (auto& func : m_VkD->ResourceFreeQueue[m_VkD->CurrentFrameIndex])
-		{
-			func(this);
-		}
-		m_VkD->ResourceFreeQueue[m_VkD->CurrentFrameIndex].clear();
+		// the GPU may still use these until the frame's fences and upload batches are signaled
+		auto& queue = m_VkD->ResourceFreeQueue[m_VkD->CurrentFrameIndex];
+		auto& pendingQueue = m_VkD->PendingResourceFreeQueue[m_VkD->CurrentFrameIndex];
+		pendingQueue.insert(pendingQueue.end(), std::make_move_iterator(queue.begin()), std::make_move_iterator(queue.end()));
+		queue.clear();
 
 		m_VkD->CurrentFrameIndex = (m_VkD->CurrentFrameIndex + 1) % CV_FRAMES_IN_FLIGHT;
 	}
 
-	void VulkanRenderer::Draw(CommandBuffer commandBuffer, size_t vertexCount, size_t vertexOffset) const
+	void VulkanRenderer::Draw(CommandBuffer commandBuffer, size_t vertexCount, size_t vertexOffset, uint32_t firstInstance) const
 	{
-		vkCmdDraw(commandBuffer.As<VkCommandBuffer>(), (uint32_t)vertexCount, 1, (uint32_t)vertexOffset, 0);
+		vkCmdDraw(commandBuffer.As<VkCommandBuffer>(), (uint32_t)vertexCount, 1, (uint32_t)vertexOffset, firstInstance);
+	}
+
+	void VulkanRenderer::DrawIndirect(CommandBuffer commandBuffer, BufferBase* buffer, size_t offset, uint32_t drawCount) const
+	{
+		VkBuffer indirectBuffer = ((BufferData*)buffer->GetNativeData())->Buffer;
+		for (uint32_t first = 0; first < drawCount; first += m_VkD->MaxDrawIndirectCount)
+		{
+			uint32_t count = std::min(drawCount - first, m_VkD->MaxDrawIndirectCount);
+			vkCmdDrawIndirect(commandBuffer.As<VkCommandBuffer>(), indirectBuffer, offset + first * sizeof(DrawIndirectCommand), count, sizeof(DrawIndirectCommand));
+		}
+	}
+
+	void VulkanRenderer::DrawIndirectCount(CommandBuffer commandBuffer, BufferBase* buffer, size_t offset, BufferBase* countBuffer, size_t countOffset, uint32_t maxDrawCount) const
+	{
+		if (!m_VkD->CmdDrawIndirectCount)
+		{
+			DrawIndirect(commandBuffer, buffer, offset, maxDrawCount);
+			return;
+		}
+
+		VkBuffer indirectBuffer = ((BufferData*)buffer->GetNativeData())->Buffer;
+		VkBuffer indirectCountBuffer = ((BufferData*)countBuffer->GetNativeData())->Buffer;
+		m_VkD->CmdDrawIndirectCount(commandBuffer.As<VkCommandBuffer>(), indirectBuffer, offset, indirectCountBuffer, countOffset, std::min(maxDrawCount, m_VkD->MaxDrawIndirectCount), sizeof(DrawIndirectCommand));
 	}
 
 	void VulkanRenderer::DrawIndexed(CommandBuffer commandBuffer, size_t indexCount, size_t indexOffset) const
@@ -578,6 +683,25 @@ namespace cv {
 		vkCmdDispatch(commandBuffer.As<VkCommandBuffer>(), groupCountX, groupCountY, groupCountZ);
 	}
 
+	void VulkanRenderer::ComputeBarrier(CommandBuffer commandBuffer) const
+	{
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+		VkPipelineStageFlags stages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+
+		vkCmdPipelineBarrier(
+			commandBuffer.As<VkCommandBuffer>(),
+			stages, stages,
+			0,
+			1, &barrier,
+			0, nullptr,
+			0, nullptr
+		);
+	}
+
 	void VulkanRenderer::BeginCommandBuffer(CommandBuffer commandBuffer) const
 	{
 		VkCommandBufferBeginInfo beginInfo{};
@@ -596,6 +720,8 @@ namespace cv {
 
 	void VulkanRenderer::SubmitCommandBuffer(CommandBuffer commandBuffer) const
 	{
+		m_VkD->UploadManager->Flush();
+
 		if (m_VkD->FrameSuccess[m_VkD->CurrentFrameIndex])
 		{
 			VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
@@ -630,6 +756,22 @@ namespace cv {
 		return m_VkD->Swapchain;
 	}
 
+	uint32_t VulkanRenderer::GetImageCount() const
+	{
+		if (m_VkD->Headless)
+			return CV_FRAMES_IN_FLIGHT;
+
+		return m_VkD->Swapchain->GetImageCount();
+	}
+
+	uint32_t VulkanRenderer::GetImageIndex() const
+	{
+		if (m_VkD->Headless)
+			return m_VkD->CurrentFrameIndex;
+
+		return m_VkD->Swapchain->GetImageIndex();
+	}
+
 	CommandBuffer VulkanRenderer::AllocateCommandBuffer() const
 	{
 		VkCommandBufferAllocateInfo allocInfo{};
@@ -690,6 +832,11 @@ namespace cv {
 		return new VulkanShader(this, path);
 	}
 
+	Shader* VulkanRenderer::CreateShader(const std::string& name, const std::string& source)
+	{
+		return new VulkanShader(this, name, source);
+	}
+
 	GraphicsPipeline* VulkanRenderer::CreateGraphicsPipeline(Shader* shader, PrimitiveTopology topology, const InputLayout& layout)
 	{
 		return new VulkanGraphicsPipeline(this, shader, topology, layout);
@@ -720,6 +867,17 @@ namespace cv {
 		return m_VkD->CurrentFrameIndex;
 	}
 
+	void VulkanRenderer::WaitForFramesInFlight() const
+	{
+		// only unified memory writes buffers in place, everywhere else the writes go through the upload manager's copies
+		if (!m_VkD->MemoryAllocator->IsUnifiedMemory())
+			return;
+
+		// every frame submits to the graphics queue
+		VkResult result = vkQueueWaitIdle(m_VkD->GraphicsQueue);
+		VK_CHECK(result, "An error occurred while waiting for Vulkan queue!");
+	}
+
 	VkSemaphore VulkanRenderer::GetNextFrameSemaphore() const
 	{
 		uint32_t index = m_VkD->UsedSemaphoreCount[m_VkD->CurrentFrameIndex];
@@ -739,6 +897,15 @@ namespace cv {
 		m_VkD->ResourceFreeQueue[m_VkD->CurrentFrameIndex].push_back(func);
 	}
 
+	void VulkanRenderer::RunResourceFrees()
+	{
+		// the frees of the last frame with this index, its fences and upload batches have been waited on
+		auto& queue = m_VkD->PendingResourceFreeQueue[m_VkD->CurrentFrameIndex];
+		for (auto& func : queue)
+			func(this);
+		queue.clear();
+	}
+
 	BufferBase* VulkanRenderer::CreateBufferBase(BufferType type, size_t size, const void* data)
 	{
 		return new VulkanBuffer(this, type, size, data);
@@ -758,7 +925,7 @@ namespace cv {
 		instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 		instanceInfo.pApplicationInfo = &appInfo;
 
-		std::vector<const char*> extensions = Utils::GetRequiredExtensions();
+		std::vector<const char*> extensions = Utils::GetRequiredExtensions(m_VkD->Headless);
 		instanceInfo.enabledExtensionCount = (uint32_t)extensions.size();
 		instanceInfo.ppEnabledExtensionNames = extensions.data();
 
@@ -834,6 +1001,10 @@ namespace cv {
 		}
 
 		CV_ASSERT(m_VkD->PhysicalDevice && "Failed to find a suitable GPU!");
+
+		VkPhysicalDeviceProperties properties{};
+		vkGetPhysicalDeviceProperties(m_VkD->PhysicalDevice, &properties);
+		CV_INFO("Using Vulkan device: ", properties.deviceName, m_VkD->Headless ? " (headless)" : "");
 	}
 
 	void VulkanRenderer::CreateLogicalDevice()
@@ -859,15 +1030,51 @@ namespace cv {
 		deviceFeatures.sampleRateShading = VK_TRUE;
 		deviceFeatures.fragmentStoresAndAtomics = VK_TRUE;
 		deviceFeatures.independentBlend = VK_TRUE;
+		deviceFeatures.multiDrawIndirect = VK_TRUE;
+		deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
+
+		VkPhysicalDeviceProperties properties{};
+		vkGetPhysicalDeviceProperties(m_VkD->PhysicalDevice, &properties);
+		m_VkD->MaxDrawIndirectCount = properties.limits.maxDrawIndirectCount;
+
+		std::vector<const char*> deviceExtensions = m_VkD->Headless ? s_HeadlessDeviceExtensions : s_DeviceExtensions;
+
+		// the instance asking for 1.3 doesn't raise the device's version, the 1.2 feature struct may only be chained on a 1.2
+		// device, older ones can still have the extension, without either the draws fall back to vkCmdDrawIndirect
+		VkPhysicalDeviceVulkan12Features deviceFeatures12{};
+		deviceFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+		bool vulkan12 = properties.apiVersion >= VK_API_VERSION_1_2;
+		const char* drawIndirectCountName = nullptr;
+		if (vulkan12)
+		{
+			VkPhysicalDeviceVulkan12Features supportedFeatures12{};
+			supportedFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+			VkPhysicalDeviceFeatures2 supportedFeatures{};
+			supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			supportedFeatures.pNext = &supportedFeatures12;
+			vkGetPhysicalDeviceFeatures2(m_VkD->PhysicalDevice, &supportedFeatures);
+
+			deviceFeatures12.drawIndirectCount = supportedFeatures12.drawIndirectCount;
+			if (supportedFeatures12.drawIndirectCount)
+				drawIndirectCountName = "vkCmdDrawIndirectCount";
+		}
+		else if (Utils::CheckDeviceExtensionSupport(m_VkD->PhysicalDevice, { VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME }))
+		{
+			deviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+			drawIndirectCountName = "vkCmdDrawIndirectCountKHR";
+		}
 
 		VkDeviceCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		createInfo.pNext = vulkan12 ? &deviceFeatures12 : nullptr;
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 		createInfo.pEnabledFeatures = &deviceFeatures;
 
-		createInfo.enabledExtensionCount = (uint32_t)s_DeviceExtensions.size();
-		createInfo.ppEnabledExtensionNames = s_DeviceExtensions.data();
+		createInfo.enabledExtensionCount = (uint32_t)deviceExtensions.size();
+		createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
 		if (s_EnableValidationLayers)
 		{
@@ -882,6 +1089,10 @@ namespace cv {
 		VkResult result = vkCreateDevice(m_VkD->PhysicalDevice, &createInfo, m_VkD->Allocator, &m_VkD->Device);
 		VK_CHECK(result, "Failed to create Vulkan device!");
 
+		// loaded instead of linked, the loader's export isn't there for the extension and can't be called on older devices
+		if (drawIndirectCountName)
+			m_VkD->CmdDrawIndirectCount = (PFN_vkCmdDrawIndirectCount)vkGetDeviceProcAddr(m_VkD->Device, drawIndirectCountName);
+
 		vkGetDeviceQueue(m_VkD->Device, indices.GraphicsFamily, 0, &m_VkD->GraphicsQueue);
 		vkGetDeviceQueue(m_VkD->Device, indices.PresentFamily, 0, &m_VkD->PresentQueue);
 	}
@@ -944,4 +1155,87 @@ namespace cv {
 		}
 	}
 
+	void VulkanRenderer::CreatePipelineCache()
+	{
+		Utils::PipelineCacheHeader expectedHeader = Utils::GetPipelineCacheHeader(m_VkD->PhysicalDevice);
+
+		std::vector<uint8_t> data;
+		std::ifstream in(Utils::GetPipelineCachePath(), std::ios::in | std::ios::binary | std::ios::ate);
+		if (in.is_open())
+		{
+			uint64_t fileSize = (uint64_t)std::max<std::streamoff>(in.tellg(), 0);
+			in.seekg(0, std::ios::beg);
+
+			Utils::PipelineCacheHeader header{};
+			in.read((char*)&header, sizeof(header));
+
+			// the size is checked against the file before anything is allocated for it, a corrupted one could ask for any amount
+			bool valid = in.gcount() == sizeof(header)
+				&& header.DataSize == fileSize - sizeof(header)
+				&& header.Magic == expectedHeader.Magic
+				&& header.VendorID == expectedHeader.VendorID
+				&& header.DeviceID == expectedHeader.DeviceID
+				&& header.DriverVersion == expectedHeader.DriverVersion
+				&& memcmp(header.CacheUUID, expectedHeader.CacheUUID, VK_UUID_SIZE) == 0;
+
+			if (valid)
+			{
+				data.resize(header.DataSize);
+				in.read((char*)data.data(), (std::streamsize)data.size());
+				if ((uint64_t)in.gcount() != header.DataSize)
+					data.clear();
+			}
+		}
+
+		VkPipelineCacheCreateInfo cacheInfo{};
+		cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		cacheInfo.initialDataSize = data.size();
+		cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+		VkResult result = vkCreatePipelineCache(m_VkD->Device, &cacheInfo, m_VkD->Allocator, &m_VkD->PipelineCache);
+		if (result != VK_SUCCESS && !data.empty())
+		{
+			// the driver rejected the data after all, starting over with an empty cache
+			cacheInfo.initialDataSize = 0;
+			cacheInfo.pInitialData = nullptr;
+			result = vkCreatePipelineCache(m_VkD->Device, &cacheInfo, m_VkD->Allocator, &m_VkD->PipelineCache);
+		}
+		VK_CHECK(result, "Failed to create Vulkan pipeline cache!");
+	}
+
+	void VulkanRenderer::SavePipelineCache()
+	{
+		size_t size = 0;
+		VkResult result = vkGetPipelineCacheData(m_VkD->Device, m_VkD->PipelineCache, &size, nullptr);
+		if (result != VK_SUCCESS || size == 0)
+			return;
+
+		std::vector<uint8_t> data(size);
+		result = vkGetPipelineCacheData(m_VkD->Device, m_VkD->PipelineCache, &size, data.data());
+		if (result != VK_SUCCESS)
+			return;
+
+		Utils::PipelineCacheHeader header = Utils::GetPipelineCacheHeader(m_VkD->PhysicalDevice);
+		header.DataSize = size;
+
+		// written next to it and renamed, so a run that dies halfway doesn't leave a cut off cache behind
+		std::filesystem::path path = Utils::GetPipelineCachePath();
+		std::filesystem::path tempPath = path;
+		tempPath += ".tmp";
+
+		std::error_code error;
+		std::filesystem::create_directories(path.parent_path(), error);
+
+		std::ofstream out(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!out.is_open())
+			return;
+
+		out.write((const char*)&header, sizeof(header));
+		out.write((const char*)data.data(), (std::streamsize)size);
+		out.close();
+
+		if (out)
+			std::filesystem::rename(tempPath, path, error);
+	}
+
 }
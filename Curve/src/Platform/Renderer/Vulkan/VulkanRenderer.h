@@ -13,18 +13,20 @@ namespace cv {
 	class VulkanRenderer : public Renderer
 	{
 	public:
-		VulkanRenderer(Window& window);
+		VulkanRenderer(Window& window, const RendererSpecification& spec = {});
 		virtual ~VulkanRenderer();
 
 		virtual void BeginFrame() override;
 		virtual void EndFrame() override;
 
 		virtual Window& GetWindow() override { return m_Window; }
+		virtual bool IsHeadless() const override { return m_Specification.Headless; }
 
-		virtual void Draw(CommandBuffer commandBuffer, size_t vertexCount, size_t vertexOffset = 0) const override;
+		virtual void Draw(CommandBuffer commandBuffer, size_t vertexCount, size_t vertexOffset = 0, uint32_t firstInstance = 0) const override;
 		virtual void DrawIndexed(CommandBuffer commandBuffer, size_t indexCount, size_t indexOffset = 0) const override;
 
 		virtual void Dispatch(CommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) const override;
+		virtual void ComputeBarrier(CommandBuffer commandBuffer) const override;
 
 		virtual void BeginCommandBuffer(CommandBuffer commandBuffer) const override;
 		virtual void EndCommandBuffer(CommandBuffer commandBuffer) const override;
@@ -32,12 +34,16 @@ namespace cv {
 
 		virtual Swapchain* GetSwapchain() const override;
 
+		virtual uint32_t GetImageCount() const override;
+		virtual uint32_t GetImageIndex() const override;
+
 		virtual CommandBuffer AllocateCommandBuffer() const override;
 		virtual CommandBuffer BeginSingleTimeCommands() const override;
 		virtual void EndSingleTimeCommands(CommandBuffer commandBuffer) const override;
 
 		virtual Swapchain* CreateSwapchain(const SwapchainSpecification& spec) override;
 		virtual Shader* CreateShader(const std::filesystem::path& path) override;
+		virtual Shader* CreateShader(const std::string& name, const std::string& source) override;
 		virtual GraphicsPipeline* CreateGraphicsPipeline(Shader* shader, PrimitiveTopology topology, const InputLayout& layout) override;
 		virtual GraphicsPipeline* CreateGraphicsPipeline(Shader* shader, PrimitiveTopology topology, const InputLayout& layout, Framebuffer* framebuffer) override;
 		virtual ComputePipeline* CreateComputePipeline(Shader* shader, const InputLayout& layout) override;
@@ -45,6 +51,7 @@ namespace cv {
 		virtual ImGuiLayer* CreateImGuiLayer() override;
 
 		virtual uint32_t GetCurrentFrameIndex() const override;
+		virtual void WaitForFramesInFlight() const override;
 
 		virtual void* GetNativeData() override { return m_VkD; }
 		virtual const void* GetNativeData() const override { return m_VkD; }
@@ -57,6 +64,9 @@ namespace cv {
 	private:
 		virtual BufferBase* CreateBufferBase(BufferType type, size_t size, const void* data) override;
 
+		virtual void DrawIndirect(CommandBuffer commandBuffer, BufferBase* buffer, size_t offset, uint32_t drawCount) const override;
+		virtual void DrawIndirectCount(CommandBuffer commandBuffer, BufferBase* buffer, size_t offset, BufferBase* countBuffer, size_t countOffset, uint32_t maxDrawCount) const override;
+
 		void CreateInstance();
 		void SetupDebugMessenger();
 		void CreateSurface();
@@ -65,8 +75,14 @@ namespace cv {
 		void CreateCommandPool();
 		void CreateDescriptorPool();
 		void CreateSyncObjects();
+
+		void CreatePipelineCache();
+		void SavePipelineCache();
+
+		void RunResourceFrees();
 	private:
 		Window& m_Window;
+		RendererSpecification m_Specification;
 		VulkanData* m_VkD = nullptr;
 	};
 
@@ -2,27 +2,202 @@
 #include "VulkanShader.h"
 
 #include "VulkanData.h"
+#include "Curve/Core/JobSystem.h"
 
 #include <shaderc/shaderc.hpp>
 #include <spirv_cross/spirv_cross.hpp>
 #include <spirv_cross/spirv_glsl.hpp>
 
+#include <iomanip>
+
 namespace cv {
 
 	namespace Utils {
 
-		static const char* GetCacheDirectory()
+		// shaders built from source at runtime get a directory of their own, a new one shows up for every expression
+		static const char* GetCacheDirectory(bool generated)
 		{
-			return "assets/cache/shader";
+			return generated ? "assets/cache/shader/generated" : "assets/cache/shader";
 		}
 
-		static void CreateCacheDirectory()
+		static constexpr size_t s_MaxGeneratedBinaries = 256;
+
+		static void CreateCacheDirectory(bool generated)
 		{
-			std::string cacheDir = GetCacheDirectory();
+			std::string cacheDir = GetCacheDirectory(generated);
 			if (!std::filesystem::exists(cacheDir))
 				std::filesystem::create_directories(cacheDir);
 		}
 
+		static constexpr shaderc_env_version s_TargetEnvironment = shaderc_env_version_vulkan_1_0;
+#ifdef CV_DEBUG
+		static constexpr bool s_GenerateDebugInfo = true;
+		static constexpr shaderc_optimization_level s_OptimizationLevel = shaderc_optimization_level_zero;
+#else
+		static constexpr bool s_GenerateDebugInfo = false;
+		static constexpr shaderc_optimization_level s_OptimizationLevel = shaderc_optimization_level_performance;
+#endif
+
+		static shaderc::CompileOptions GetCompileOptions()
+		{
+			shaderc::CompileOptions options;
+			options.SetTargetEnvironment(shaderc_target_env_vulkan, s_TargetEnvironment);
+			options.SetOptimizationLevel(s_OptimizationLevel);
+			if (s_GenerateDebugInfo)
+				options.SetGenerateDebugInfo();
+
+			return options;
+		}
+
+		// FNV-1a, the key only has to change whenever the binary would
+		static uint64_t Hash(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+		{
+			const uint8_t* bytes = (const uint8_t*)data;
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= bytes[i];
+				hash *= 1099511628211ull;
+			}
+
+			return hash;
+		}
+
+		// everything besides the source that goes into a binary: the stage, the compile options and the SPIR-V shaderc emits
+		static uint64_t GetCompileHash(shaderc_shader_kind kind)
+		{
+			unsigned int spvVersion = 0, spvRevision = 0;
+			shaderc_get_spv_version(&spvVersion, &spvRevision);
+
+			uint32_t key[] = { (uint32_t)kind, (uint32_t)s_TargetEnvironment, (uint32_t)s_OptimizationLevel, (uint32_t)s_GenerateDebugInfo, spvVersion, spvRevision };
+			return Hash(key, sizeof(key));
+		}
+
+		static bool ReadCachedBinary(const std::filesystem::path& path, std::vector<uint32_t>& binary)
+		{
+			std::ifstream in(path, std::ios::in | std::ios::binary);
+			if (!in.is_open())
+				return false;
+
+			in.seekg(0, std::ios::end);
+			auto size = in.tellg();
+			in.seekg(0, std::ios::beg);
+			if (size <= 0 || size % sizeof(uint32_t) != 0)
+				return false;
+
+			binary.resize(size / sizeof(uint32_t));
+			in.read((char*)binary.data(), size);
+
+			// a truncated or foreign file is compiled again instead
+			return in && binary[0] == 0x07230203;
+		}
+
+		// drops the least recently used binaries once there are more than maxCount, a hit touches its file
+		static void TrimCacheDirectory(const std::filesystem::path& directory, size_t maxCount)
+		{
+			std::error_code error;
+			std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> binaries;
+			for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+			{
+				if (entry.path().extension() == ".spv")
+					binaries.emplace_back(entry.last_write_time(error), entry.path());
+			}
+
+			if (binaries.size() <= maxCount)
+				return;
+
+			std::sort(binaries.begin(), binaries.end());
+			for (size_t i = 0; i < binaries.size() - maxCount; i++)
+				std::filesystem::remove(binaries[i].second, error);
+		}
+
+		static void WriteCachedBinary(const std::filesystem::path& path, const std::string& prefix, const std::string& suffix, const std::vector<uint32_t>& binary)
+		{
+			// written next to it and renamed, so a shader loading the same binary on another thread never reads half a file
+			std::stringstream tempName;
+			tempName << path.filename().string() << "." << std::this_thread::get_id() << ".tmp";
+			std::filesystem::path tempPath = path.parent_path() / tempName.str();
+
+			std::ofstream out(tempPath, std::ios::out | std::ios::binary);
+			if (!out.is_open())
+				return;
+
+			out.write((const char*)binary.data(), binary.size() * sizeof(uint32_t));
+			out.close();
+
+			std::error_code error;
+			std::filesystem::rename(tempPath, path, error);
+			if (error)
+			{
+				std::filesystem::remove(tempPath, error);
+				return;
+			}
+
+			// binaries of older versions of the shader are never loaded again, the prefix holds the full path and the build
+			// configuration so other shaders and other configurations keep theirs
+			for (const auto& entry : std::filesystem::directory_iterator(path.parent_path(), error))
+			{
+				std::string name = entry.path().filename().string();
+				if (entry.path() != path && name.size() > prefix.size() + suffix.size() && name.starts_with(prefix) && name.ends_with(suffix))
+					std::filesystem::remove(entry.path(), error);
+			}
+		}
+
+		// the binary is cached under a hash of the preprocessed source and everything else that affects it, so an edited
+		// shader or a different build configuration never loads a stale binary
+		static std::vector<uint32_t> CompileOrGetStage(const std::string& source, shaderc_shader_kind kind, const std::filesystem::path& filepath, const char* extension, bool generated)
+		{
+			shaderc::Compiler compiler;
+			shaderc::CompileOptions options = GetCompileOptions();
+			std::string name = filepath.string();
+
+			shaderc::PreprocessedSourceCompilationResult preprocessed = compiler.PreprocessGlsl(source, kind, name.c_str(), options);
+			if (preprocessed.GetCompilationStatus() != shaderc_compilation_status_success)
+			{
+				std::cerr << preprocessed.GetErrorMessage() << std::endl;
+				CV_ASSERT(false);
+			}
+
+			std::string preprocessedSource(preprocessed.cbegin(), preprocessed.cend());
+			uint64_t compileHash = GetCompileHash(kind);
+			uint64_t shaderHash = Hash(name.data(), name.size(), compileHash);
+			uint64_t hash = Hash(preprocessedSource.data(), preprocessedSource.size(), compileHash);
+
+			std::stringstream prefix;
+			prefix << filepath.filename().string() << "." << std::hex << std::setw(16) << std::setfill('0') << shaderHash << ".";
+			std::string suffix = std::string(".") + extension + ".spv";
+
+			std::stringstream cachedName;
+			cachedName << prefix.str() << std::hex << std::setw(16) << std::setfill('0') << hash << suffix;
+			std::filesystem::path cacheDirectory = GetCacheDirectory(generated);
+			std::filesystem::path cachedPath = cacheDirectory / cachedName.str();
+
+			std::vector<uint32_t> binary;
+			if (ReadCachedBinary(cachedPath, binary))
+			{
+				if (generated)
+				{
+					std::error_code error;
+					std::filesystem::last_write_time(cachedPath, std::filesystem::file_time_type::clock::now(), error);
+				}
+
+				return binary;
+			}
+
+			shaderc::SpvCompilationResult module = compiler.CompileGlslToSpv(preprocessedSource, kind, name.c_str(), options);
+			if (module.GetCompilationStatus() != shaderc_compilation_status_success)
+			{
+				std::cerr << module.GetErrorMessage() << std::endl;
+				CV_ASSERT(false);
+			}
+
+			binary = std::vector<uint32_t>(module.cbegin(), module.cend());
+			WriteCachedBinary(cachedPath, prefix.str(), suffix, binary);
+			if (generated)
+				TrimCacheDirectory(cacheDirectory, s_MaxGeneratedBinaries);
+
+			return binary;
+		}
+
 		static VkShaderStageFlags GetVkShaderStageFromCurveStage(ShaderStage stage)
 		{
 			switch (stage)
@@ -44,6 +219,13 @@ namespace cv {
 		Reload();
 	}
 
+	VulkanShader::VulkanShader(VulkanRenderer* renderer, const std::string& name, const std::string& source)
+		: m_Renderer(renderer), m_Filepath(name), m_Source(source)
+	{
+		m_Data = new ShaderData();
+		Reload();
+	}
+
 	VulkanShader::~VulkanShader()
 	{
 		m_Renderer->SubmitResourceFree([vertexModule = m_Data->VertexModule, fragmentModule = m_Data->FragmentModule, computeModule = m_Data->ComputeModule, data = m_Data](VulkanRenderer* renderer)
@@ -63,23 +245,30 @@ namespace cv {
 
 	void VulkanShader::Reload()
 	{
-		auto& vkd = m_Renderer->GetVulkanData();
-
-		m_Renderer->SubmitResourceFree([vertexModule = m_Data->VertexModule, fragmentModule = m_Data->FragmentModule, computeModule = m_Data->ComputeModule](VulkanRenderer* renderer)
+		// nothing to free on the first load, which also keeps construction off the renderer's free queue (shaders may be created on other threads)
+		if (m_Data->VertexModule || m_Data->FragmentModule || m_Data->ComputeModule)
 		{
-			auto& vkd = renderer->GetVulkanData();
-
-			if (vertexModule)
-				vkDestroyShaderModule(vkd.Device, vertexModule, vkd.Allocator);
-			if (fragmentModule)
-				vkDestroyShaderModule(vkd.Device, fragmentModule, vkd.Allocator);
-			if (computeModule)
-				vkDestroyShaderModule(vkd.Device, computeModule, vkd.Allocator);
-		});
+			m_Renderer->SubmitResourceFree([vertexModule = m_Data->VertexModule, fragmentModule = m_Data->FragmentModule, computeModule = m_Data->ComputeModule](VulkanRenderer* renderer)
+			{
+				auto& vkd = renderer->GetVulkanData();
+
+				if (vertexModule)
+					vkDestroyShaderModule(vkd.Device, vertexModule, vkd.Allocator);
+				if (fragmentModule)
+					vkDestroyShaderModule(vkd.Device, fragmentModule, vkd.Allocator);
+				if (computeModule)
+					vkDestroyShaderModule(vkd.Device, computeModule, vkd.Allocator);
+			});
+
+			m_Data->VertexModule = nullptr;
+			m_Data->FragmentModule = nullptr;
+			m_Data->ComputeModule = nullptr;
+		}
 
-		Utils::CreateCacheDirectory();
+		Utils::CreateCacheDirectory(!m_Source.empty());
 
-		std::string source = ReadFile(m_Filepath);
+		// read again every time, an edited file hashes to another cache entry and is compiled
+		std::string source = m_Source.empty() ? ReadFile(m_Filepath) : m_Source;
 
 		bool isCompute;
 		std::array<std::string, 2> shaders = PreProcess(source, isCompute);
@@ -92,143 +281,36 @@ namespace cv {
 
 	void VulkanShader::CompileOrGetVulkanBinaries(const std::array<std::string, 2>& sources, bool isCompute)
 	{
-		shaderc::Compiler compiler;
-		shaderc::CompileOptions options;
-		options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_0);
-		const bool debug =
-#ifdef CV_DEBUG
-			true;
-#else
-			false;
-#endif
-		if (debug)
-		{
-			options.SetGenerateDebugInfo();
-			options.SetOptimizationLevel(shaderc_optimization_level_zero);
-		}
-		else
+		struct Stage
 		{
-			options.SetOptimizationLevel(shaderc_optimization_level_performance);
-		}
-
+			const std::string* Source;
+			shaderc_shader_kind Kind;
+			const char* Extension;
+			const char* Name;
+			std::vector<uint32_t>* Binary;
+		};
+
+		std::vector<Stage> stages;
 		if (isCompute)
 		{
-			std::filesystem::path cacheDirectory = Utils::GetCacheDirectory();
-
-			std::filesystem::path shaderFilePath = m_Filepath;
-			std::filesystem::path cachedPath = cacheDirectory / (shaderFilePath.filename().string() + ".cached_vulkan.comp.spv");
-
-			std::ifstream in(cachedPath, std::ios::in | std::ios::binary);
-			if (in.is_open())
-			{
-				in.seekg(0, std::ios::end);
-				auto size = in.tellg();
-				in.seekg(0, std::ios::beg);
-
-				m_Data->ComputeData.resize(size / sizeof(uint32_t));
-				in.read((char*)m_Data->ComputeData.data(), size);
-			}
-			else
-			{
-				shaderc::SpvCompilationResult module = compiler.CompileGlslToSpv(sources[0], shaderc_glsl_compute_shader, shaderFilePath.string().c_str(), options);
-				if (module.GetCompilationStatus() != shaderc_compilation_status_success)
-				{
-					std::cerr << module.GetErrorMessage() << std::endl;
-					CV_ASSERT(false);
-				}
-
-				m_Data->ComputeData = std::vector<uint32_t>(module.cbegin(), module.cend());
-
-				std::ofstream out(cachedPath, std::ios::out | std::ios::binary);
-				if (out.is_open())
-				{
-					out.write((char*)m_Data->ComputeData.data(), m_Data->ComputeData.size() * sizeof(uint32_t));
-					out.flush();
-					out.close();
-				}
-			}
-
-			Reflect("Compute Shader", m_Data->ComputeData);
+			stages.push_back({ &sources[0], shaderc_glsl_compute_shader, "comp", "Compute Shader", &m_Data->ComputeData });
 		}
 		else
 		{
-			{ // vertex shader
-				std::filesystem::path cacheDirectory = Utils::GetCacheDirectory();
-
-				std::filesystem::path shaderFilePath = m_Filepath;
-				std::filesystem::path cachedPath = cacheDirectory / (shaderFilePath.filename().string() + ".cached_vulkan.vert.spv");
-
-				std::ifstream in(cachedPath, std::ios::in | std::ios::binary);
-				if (in.is_open())
-				{
-					in.seekg(0, std::ios::end);
-					auto size = in.tellg();
-					in.seekg(0, std::ios::beg);
-
-					m_Data->VertexData.resize(size / sizeof(uint32_t));
-					in.read((char*)m_Data->VertexData.data(), size);
-				}
-				else
-				{
-					shaderc::SpvCompilationResult module = compiler.CompileGlslToSpv(sources[0], shaderc_glsl_vertex_shader, shaderFilePath.string().c_str(), options);
-					if (module.GetCompilationStatus() != shaderc_compilation_status_success)
-					{
-						std::cerr << module.GetErrorMessage() << std::endl;
-						CV_ASSERT(false);
-					}
-
-					m_Data->VertexData = std::vector<uint32_t>(module.cbegin(), module.cend());
-
-					std::ofstream out(cachedPath, std::ios::out | std::ios::binary);
-					if (out.is_open())
-					{
-						out.write((char*)m_Data->VertexData.data(), m_Data->VertexData.size() * sizeof(uint32_t));
-						out.flush();
-						out.close();
-					}
-				}
-			}
-			{ // fragment shader
-				std::filesystem::path cacheDirectory = Utils::GetCacheDirectory();
-
-				std::filesystem::path shaderFilePath = m_Filepath;
-				std::filesystem::path cachedPath = cacheDirectory / (shaderFilePath.filename().string() + ".cached_vulkan.frag.spv");
-
-				std::ifstream in(cachedPath, std::ios::in | std::ios::binary);
-				if (in.is_open())
-				{
-					in.seekg(0, std::ios::end);
-					auto size = in.tellg();
-					in.seekg(0, std::ios::beg);
-
-					m_Data->FragmentData.resize(size / sizeof(uint32_t));
-					in.read((char*)m_Data->FragmentData.data(), size);
-				}
-				else
-				{
-					shaderc::SpvCompilationResult module = compiler.CompileGlslToSpv(sources[1], shaderc_glsl_fragment_shader, shaderFilePath.string().c_str(), options);
-					if (module.GetCompilationStatus() != shaderc_compilation_status_success)
-					{
-						std::cerr << module.GetErrorMessage() << std::endl;
-						CV_ASSERT(false);
-					}
-
-					m_Data->FragmentData = std::vector<uint32_t>(module.cbegin(), module.cend());
-
-					std::ofstream out(cachedPath, std::ios::out | std::ios::binary);
-					if (out.is_open())
-					{
-						out.write((char*)m_Data->FragmentData.data(), m_Data->FragmentData.size() * sizeof(uint32_t));
-						out.flush();
-						out.close();
-					}
-				}
-			}
-
-			Reflect("Vertex Shader", m_Data->VertexData);
-			Reflect("Fragment Shader", m_Data->FragmentData);
+			stages.push_back({ &sources[0], shaderc_glsl_vertex_shader, "vert", "Vertex Shader", &m_Data->VertexData });
+			stages.push_back({ &sources[1], shaderc_glsl_fragment_shader, "frag", "Fragment Shader", &m_Data->FragmentData });
 		}
 
+		// the stages don't share anything, each one gets a worker; that's as far as it goes, shaders created one after another
+		// on the same thread still compile one after another
+		JobSystem::ParallelFor(stages.size(), 1, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+				*stages[i].Binary = Utils::CompileOrGetStage(*stages[i].Source, stages[i].Kind, m_Filepath, stages[i].Extension, !m_Source.empty());
+		});
+
+		for (const Stage& stage : stages)
+			Reflect(stage.Name, *stage.Binary);
 	}
 
 	void VulkanShader::CreateShaderModules(bool isCompute)
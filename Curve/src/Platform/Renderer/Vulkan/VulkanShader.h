@@ -11,6 +11,7 @@ namespace cv {
 	{
 	public:
 		VulkanShader(VulkanRenderer* renderer, const std::filesystem::path& filepath);
+		VulkanShader(VulkanRenderer* renderer, const std::string& name, const std::string& source);
 		virtual ~VulkanShader();
 		
 		virtual void Reload() override;
@@ -31,6 +32,7 @@ namespace cv {
 	private:
 		VulkanRenderer* m_Renderer = nullptr;
 		std::filesystem::path m_Filepath;
+		std::string m_Source; // only set for shaders created from source
 		ShaderData* m_Data = nullptr;
 
 		bool m_IsCompute = false;
@@ -126,11 +126,11 @@ namespace cv {
 
 			vkDestroyImageView(vkd.Device, scd->DepthImageView, vkd.Allocator);
 			vkDestroyImage(vkd.Device, scd->DepthImage, vkd.Allocator);
-			vkFreeMemory(vkd.Device, scd->DepthImageMemory, vkd.Allocator);
+			vkd.MemoryAllocator->Free(scd->DepthImageMemory);
 
 			vkDestroyImageView(vkd.Device, scd->ColorImageView, vkd.Allocator);
 			vkDestroyImage(vkd.Device, scd->ColorImage, vkd.Allocator);
-			vkFreeMemory(vkd.Device, scd->ColorImageMemory, vkd.Allocator);
+			vkd.MemoryAllocator->Free(scd->ColorImageMemory);
 
 			for (VkImageView view : scd->ImageViews)
 				vkDestroyImageView(vkd.Device, view, vkd.Allocator);
@@ -269,7 +269,7 @@ namespace cv {
 
 		Utils::CreateImage(
 			vkd.Device,
-			vkd.PhysicalDevice,
+			vkd.MemoryAllocator,
 			vkd.Allocator,
 			extent.width,
 			extent.height,
@@ -403,7 +403,7 @@ namespace cv {
 
 		Utils::CreateImage(
 			vkd.Device,
-			vkd.PhysicalDevice,
+			vkd.MemoryAllocator,
 			vkd.Allocator,
 			m_Data->Extent.width,
 			m_Data->Extent.height,
@@ -465,10 +465,10 @@ namespace cv {
 		std::vector<VkImageView> oldImageViews = m_Data->ImageViews;
 		std::vector<VkFramebuffer> oldFramebuffers = m_Data->Framebuffers;
 		VkImage oldDepthImage = m_Data->DepthImage;
-		VkDeviceMemory oldDepthImageMemory = m_Data->DepthImageMemory;
+		VulkanAllocation oldDepthImageMemory = m_Data->DepthImageMemory;
 		VkImageView oldDepthImageView = m_Data->DepthImageView;
 		VkImage oldColorImage = m_Data->ColorImage;
-		VkDeviceMemory oldColorImageMemory = m_Data->ColorImageMemory;
+		VulkanAllocation oldColorImageMemory = m_Data->ColorImageMemory;
 		VkImageView oldColorImageView = m_Data->ColorImageView;
 
 		CreateSwapchain(oldSwapchain);
@@ -507,11 +507,11 @@ namespace cv {
 
 			vkDestroyImageView(vkd.Device, oldColorImageView, vkd.Allocator);
 			vkDestroyImage(vkd.Device, oldColorImage, vkd.Allocator);
-			vkFreeMemory(vkd.Device, oldColorImageMemory, vkd.Allocator);
+			vkd.MemoryAllocator->Free(oldColorImageMemory);
 
 			vkDestroyImageView(vkd.Device, oldDepthImageView, vkd.Allocator);
 			vkDestroyImage(vkd.Device, oldDepthImage, vkd.Allocator);
-			vkFreeMemory(vkd.Device, oldDepthImageMemory, vkd.Allocator);
+			vkd.MemoryAllocator->Free(oldDepthImageMemory);
 
 			for (VkFramebuffer framebuffer : oldFramebuffers)
 				vkDestroyFramebuffer(vkd.Device, framebuffer, vkd.Allocator);
@@ -0,0 +1,236 @@
+#include "cvpch.h"
+#include "VulkanUploadManager.h"
+
+#include "VulkanData.h"
+
+#include <bit>
+
+namespace cv {
+
+	static constexpr size_t s_InitialRingSize = 1 << 20;
+	static constexpr size_t s_MaxRingSize = 16 << 20;
+
+	// keeps the ranges in the ring aligned for memcpy
+	static constexpr size_t s_RingAlignment = 16;
+
+	VulkanUploadManager::VulkanUploadManager(VulkanRenderer* renderer)
+		: m_Renderer(renderer)
+	{
+	}
+
+	VulkanUploadManager::~VulkanUploadManager()
+	{
+		auto& vkd = m_Renderer->GetVulkanData();
+
+		for (UploadFrame& frame : m_Frames)
+		{
+			DestroyRing(frame.CurrentRing);
+			for (const Ring& ring : frame.RetiredRings)
+				DestroyRing(ring);
+
+			for (VkFence fence : frame.Fences)
+				vkDestroyFence(vkd.Device, fence, vkd.Allocator);
+			if (!frame.CommandBuffers.empty())
+				vkFreeCommandBuffers(vkd.Device, vkd.CommandPool, (uint32_t)frame.CommandBuffers.size(), frame.CommandBuffers.data());
+		}
+	}
+
+	void VulkanUploadManager::CopyBuffer(VkBuffer srcBuffer, const void* srcMemory, VkBuffer dstBuffer, size_t size, size_t offset)
+	{
+		if (size == 0)
+			return;
+
+		VkBuffer ringBuffer;
+		size_t ringOffset;
+		void* ringMemory = AllocateRing(size, ringBuffer, ringOffset);
+		if (!ringMemory)
+		{
+			// the copies recorded so far have to land first, they may cover the same range
+			Flush();
+			Utils::CopyBuffer(m_Renderer, srcBuffer, dstBuffer, size, offset);
+			return;
+		}
+
+		memcpy(ringMemory, srcMemory, size);
+
+		VkBufferCopy region{};
+		region.srcOffset = ringOffset;
+		region.dstOffset = offset;
+		region.size = size;
+		m_PendingCopies.push_back({ ringBuffer, dstBuffer, region });
+	}
+
+	void VulkanUploadManager::Flush()
+	{
+		if (m_PendingCopies.empty())
+			return;
+
+		auto& vkd = m_Renderer->GetVulkanData();
+		UploadFrame& frame = m_Frames[vkd.CurrentFrameIndex];
+
+		if (frame.UsedBatchCount == frame.CommandBuffers.size())
+		{
+			VkFenceCreateInfo fenceInfo{};
+			fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+			VkFence fence = nullptr;
+			VkResult result = vkCreateFence(vkd.Device, &fenceInfo, vkd.Allocator, &fence);
+			VK_CHECK(result, "Failed to create Vulkan fence!");
+
+			frame.CommandBuffers.push_back(m_Renderer->AllocateCommandBuffer().As<VkCommandBuffer>());
+			frame.Fences.push_back(fence);
+		}
+
+		VkCommandBuffer commandBuffer = frame.CommandBuffers[frame.UsedBatchCount];
+		VkFence fence = frame.Fences[frame.UsedBatchCount];
+		frame.UsedBatchCount++;
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		VK_CHECK(result, "Failed to begin Vulkan command buffer!");
+
+		// the frames submitted before may still read the ranges or write them from a compute shader
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		// copies in the order they were recorded, one command per run between the same buffers, a range written again
+		// later in the frame waits for the first write so the later one wins
+		std::vector<VkBufferCopy> regions;
+		std::unordered_map<VkBuffer, std::vector<VkBufferCopy>> writtenRanges;
+		for (size_t i = 0; i < m_PendingCopies.size(); i++)
+		{
+			const PendingCopy& copy = m_PendingCopies[i];
+
+			std::vector<VkBufferCopy>& written = writtenRanges[copy.DstBuffer];
+			bool overlaps = std::any_of(written.begin(), written.end(), [&](const VkBufferCopy& range)
+			{
+				return range.dstOffset < copy.Region.dstOffset + copy.Region.size && copy.Region.dstOffset < range.dstOffset + range.size;
+			});
+
+			if (overlaps)
+			{
+				const PendingCopy& previous = m_PendingCopies[i - 1];
+				if (!regions.empty())
+					vkCmdCopyBuffer(commandBuffer, previous.SrcBuffer, previous.DstBuffer, (uint32_t)regions.size(), regions.data());
+				regions.clear();
+
+				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+				writtenRanges.clear();
+			}
+
+			regions.push_back(copy.Region);
+			writtenRanges[copy.DstBuffer].push_back(copy.Region);
+
+			bool lastOfRun = i + 1 == m_PendingCopies.size() || m_PendingCopies[i + 1].DstBuffer != copy.DstBuffer || m_PendingCopies[i + 1].SrcBuffer != copy.SrcBuffer;
+			if (lastOfRun)
+			{
+				vkCmdCopyBuffer(commandBuffer, copy.SrcBuffer, copy.DstBuffer, (uint32_t)regions.size(), regions.data());
+				regions.clear();
+			}
+		}
+		m_PendingCopies.clear();
+
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		result = vkEndCommandBuffer(commandBuffer);
+		VK_CHECK(result, "Failed to end Vulkan command buffer!");
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+
+		result = vkQueueSubmit(vkd.GraphicsQueue, 1, &submitInfo, fence);
+		VK_CHECK(result, "Failed to submit to Vulkan queue!");
+	}
+
+	void VulkanUploadManager::BeginFrame()
+	{
+		auto& vkd = m_Renderer->GetVulkanData();
+		UploadFrame& frame = m_Frames[vkd.CurrentFrameIndex];
+
+		// submitted ahead of the frame's own work, so they're normally done by the time its fences are
+		if (frame.UsedBatchCount > 0)
+		{
+			vkWaitForFences(vkd.Device, frame.UsedBatchCount, frame.Fences.data(), VK_TRUE, std::numeric_limits<uint64_t>::max());
+			vkResetFences(vkd.Device, frame.UsedBatchCount, frame.Fences.data());
+			frame.UsedBatchCount = 0;
+		}
+
+		for (const Ring& ring : frame.RetiredRings)
+			DestroyRing(ring);
+		frame.RetiredRings.clear();
+
+		frame.RingOffset = 0;
+	}
+
+	VulkanUploadManager::Ring VulkanUploadManager::CreateRing(size_t size)
+	{
+		auto& vkd = m_Renderer->GetVulkanData();
+
+		Ring ring{};
+		ring.Size = size;
+
+		Utils::CreateBuffer(
+			vkd.Device,
+			vkd.MemoryAllocator,
+			vkd.Allocator,
+			size,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			ring.Buffer,
+			ring.Memory
+		);
+
+		return ring;
+	}
+
+	void VulkanUploadManager::DestroyRing(const Ring& ring)
+	{
+		if (!ring.Buffer)
+			return;
+
+		auto& vkd = m_Renderer->GetVulkanData();
+
+		vkDestroyBuffer(vkd.Device, ring.Buffer, vkd.Allocator);
+		vkd.MemoryAllocator->Free(ring.Memory);
+	}
+
+	void* VulkanUploadManager::AllocateRing(size_t size, VkBuffer& ringBuffer, size_t& ringOffset)
+	{
+		auto& vkd = m_Renderer->GetVulkanData();
+		UploadFrame& frame = m_Frames[vkd.CurrentFrameIndex];
+
+		size_t offset = (frame.RingOffset + s_RingAlignment - 1) & ~(s_RingAlignment - 1);
+		if (offset + size > frame.CurrentRing.Size)
+		{
+			// grows to the size of everything uploaded this frame, the rest of the old ring isn't used any more
+			size_t ringSize = std::bit_ceil(std::max({ frame.CurrentRing.Size * 2, offset + size, s_InitialRingSize }));
+			if (ringSize > s_MaxRingSize)
+				return nullptr;
+
+			if (frame.CurrentRing.Buffer)
+				frame.RetiredRings.push_back(frame.CurrentRing);
+
+			frame.CurrentRing = CreateRing(ringSize);
+			offset = 0;
+		}
+
+		frame.RingOffset = offset + size;
+		ringBuffer = frame.CurrentRing.Buffer;
+		ringOffset = offset;
+		return (uint8_t*)frame.CurrentRing.Memory.Mapped + offset;
+	}
+
+}
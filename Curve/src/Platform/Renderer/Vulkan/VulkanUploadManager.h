@@ -0,0 +1,73 @@
+#pragma once
+
+#include "VulkanMemoryAllocator.h"
+#include "Curve/Core/Base.h"
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <vector>
+
+namespace cv {
+
+	class VulkanRenderer;
+
+	// batches the copies from staging memory into device local buffers, so an Unmap doesn't stall the queue until its copy is done
+	// the written range is copied into a ring of host visible memory per frame in flight and the copy out of it is recorded into
+	// a command buffer that's submitted right ahead of the next frame submit, the ring of a frame is only written again once its
+	// fence is signaled, so the staging memory of a buffer can be written again right away
+	class VulkanUploadManager
+	{
+	public:
+		VulkanUploadManager(VulkanRenderer* renderer);
+		~VulkanUploadManager();
+
+		// copies size bytes from srcMemory, the mapped memory of srcBuffer at offset, to dstBuffer at offset,
+		// a range that doesn't fit into the ring is copied out of srcBuffer right away and waited on instead
+		void CopyBuffer(VkBuffer srcBuffer, const void* srcMemory, VkBuffer dstBuffer, size_t size, size_t offset);
+
+		// submits the copies recorded so far, everything submitted after this sees them
+		void Flush();
+
+		// once the fences of the current frame are waited on, frees its ring for writing again
+		void BeginFrame();
+	private:
+		struct PendingCopy
+		{
+			VkBuffer SrcBuffer, DstBuffer;
+			VkBufferCopy Region;
+		};
+
+		struct Ring
+		{
+			VkBuffer Buffer = nullptr;
+			VulkanAllocation Memory;
+			size_t Size = 0;
+		};
+
+		struct UploadFrame
+		{
+			Ring CurrentRing;
+			size_t RingOffset = 0;
+
+			// rings the frame outgrew, copies recorded this frame may still read from them
+			std::vector<Ring> RetiredRings;
+
+			std::vector<VkCommandBuffer> CommandBuffers;
+			std::vector<VkFence> Fences;
+			uint32_t UsedBatchCount = 0;
+		};
+
+		Ring CreateRing(size_t size);
+		void DestroyRing(const Ring& ring);
+
+		// the host memory for size bytes in the ring of the current frame, nullptr if it would grow past s_MaxRingSize
+		void* AllocateRing(size_t size, VkBuffer& ringBuffer, size_t& ringOffset);
+	private:
+		VulkanRenderer* m_Renderer = nullptr;
+
+		std::array<UploadFrame, CV_FRAMES_IN_FLIGHT> m_Frames;
+		std::vector<PendingCopy> m_PendingCopies;
+	};
+
+}
@@ -1,16 +1,23 @@
 #type vertex
 #version 450 core
 
-layout(location = 0) in vec4 a_Position;
-layout(location = 1) in vec4 a_Color;
-layout(location = 2) in int a_LineIndex;
-layout(location = 3) in int a_Pad1;
-layout(location = 4) in int a_Pad2;
-layout(location = 5) in int a_Pad3;
+layout(location = 0) in vec2 a_Position;
 
 layout(location = 0) out vec4 v_Color;
 layout(location = 1) out flat int v_LineIndex;
 
+struct Line
+{
+	vec4 Color;
+	int LineIndex;
+	int Padding[3];
+};
+
+// every line is drawn with its index as the first instance
+layout(std430, binding = 0) readonly buffer LineStyles {
+	Line b_Lines[];
+};
+
 layout(push_constant) uniform Camera
 {
 	mat4 ViewProjection;
@@ -18,10 +25,10 @@ layout(push_constant) uniform Camera
 
 void main()
 {
-	int x = a_Pad1 + a_Pad2 + a_Pad3;
-	v_Color = a_Color;
-	v_LineIndex = a_LineIndex;
-	gl_Position = u_Camera.ViewProjection * a_Position;
+	Line line = b_Lines[gl_InstanceIndex];
+	v_Color = line.Color;
+	v_LineIndex = line.LineIndex;
+	gl_Position = u_Camera.ViewProjection * vec4(a_Position, 0.0, 1.0);
 }
 
 #type fragment
@@ -0,0 +1,159 @@
+#include "CurveSampler.h"
+#include "SegmentRefinement.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace cv {
+
+	namespace Utils {
+
+		struct CurvePoint
+		{
+			float T;
+			glm::vec2 Position;
+		};
+
+		// both ends are past the same edge of the visible region, so the segment can't cross it unless it bulges back in between
+		static bool IsOutside(const glm::vec2& a, const glm::vec2& b, const CurveSamplerSpecification& spec)
+		{
+			return (a.x < spec.Min.x && b.x < spec.Min.x) || (a.x > spec.Max.x && b.x > spec.Max.x) ||
+				(a.y < spec.Min.y && b.y < spec.Min.y) || (a.y > spec.Max.y && b.y > spec.Max.y);
+		}
+
+		static void Evaluate(const CurveFunction& function, std::vector<CurvePoint>& points)
+		{
+			thread_local std::vector<float> ts, xs, ys;
+			ts.resize(points.size());
+			xs.resize(points.size());
+			ys.resize(points.size());
+
+			for (size_t i = 0; i < points.size(); i++)
+				ts[i] = points[i].T;
+
+			function(ts.data(), xs.data(), ys.data(), ts.size());
+
+			for (size_t i = 0; i < points.size(); i++)
+				points[i].Position = { xs[i], ys[i] };
+		}
+
+	}
+
+	size_t CurveSampler::Sample(const CurveFunction& function, const CurveSamplerSpecification& spec, std::vector<glm::vec2>& samples)
+	{
+		if (spec.MaxT <= spec.MinT || spec.MaxSamples < 2 || spec.SegmentPixels <= 0.0f)
+			return 0;
+
+		thread_local std::vector<Utils::CurvePoint> pilot, points;
+		thread_local std::vector<glm::vec2> steps;
+		thread_local std::vector<float> lengths;
+		thread_local std::vector<SegmentState> states;
+
+		size_t pilotCount = std::max<size_t>(spec.PilotSamples, 2);
+		pilot.resize(pilotCount);
+		for (size_t i = 0; i < pilotCount; i++)
+			pilot[i].T = i == pilotCount - 1 ? spec.MaxT : spec.MinT + (spec.MaxT - spec.MinT) * (float)i / (float)(pilotCount - 1);
+
+		Utils::Evaluate(function, pilot);
+
+		// screen space length and turning angle of every pilot step, undefined and off screen steps don't count
+		steps.resize(pilotCount - 1);
+		for (size_t i = 1; i < pilotCount; i++)
+		{
+			const glm::vec2& a = pilot[i - 1].Position;
+			const glm::vec2& b = pilot[i].Position;
+
+			bool counts = IsFinitePoint(a) && IsFinitePoint(b) && !Utils::IsOutside(a, b, spec);
+			steps[i - 1] = counts ? (b - a) * spec.PixelsPerUnit : glm::vec2(0.0f);
+		}
+
+		auto turn = [&](size_t i)
+		{
+			const glm::vec2& a = steps[i];
+			const glm::vec2& b = steps[i + 1];
+			if (a == glm::vec2(0.0f) || b == glm::vec2(0.0f))
+				return 0.0f;
+
+			return std::abs(std::atan2(a.x * b.y - a.y * b.x, glm::dot(a, b)));
+		};
+
+		// an arc of length l turning by an angle a needs sqrt(l * a / (8 * tolerance)) chords to stay within the tolerance, which
+		// adds up over the pilot steps, so placing the points evenly along this measure puts them as far apart as the curve allows
+		// SegmentPixels still caps the spacing on straight stretches, so the refinement gets to see features the pilot missed
+		lengths.resize(pilotCount);
+		lengths[0] = 0.0f;
+		for (size_t i = 0; i < steps.size(); i++)
+		{
+			float length = glm::length(steps[i]);
+			float angle = ((i > 0 ? turn(i - 1) : 0.0f) + (i + 1 < steps.size() ? turn(i) : 0.0f)) * 0.5f;
+			float chords = std::max(std::sqrt(length * angle / (8.0f * spec.PixelTolerance)), length / spec.SegmentPixels);
+			lengths[i + 1] = lengths[i] + (length > 0.0f ? chords : 0.0f);
+		}
+
+		float total = lengths.back();
+		size_t segments = (size_t)std::min(std::ceil(total), (float)(spec.MaxSamples - 1));
+		float spacing = segments > 0 ? total / (float)segments : std::numeric_limits<float>::infinity();
+
+		// the parameter of every initial point is interpolated within its pilot step, the ends of stretches that didn't
+		// count are kept as well, so no initial segment jumps over a gap or an excursion off screen
+		points.clear();
+		points.push_back({ spec.MinT });
+
+		float target = spacing;
+		for (size_t i = 1; i < pilotCount && points.size() < spec.MaxSamples; i++)
+		{
+			float a = lengths[i - 1], b = lengths[i];
+			for (; target < b && points.size() < spec.MaxSamples; target += spacing)
+			{
+				float t = pilot[i - 1].T + (target - a) / (b - a) * (pilot[i].T - pilot[i - 1].T);
+				if (t > points.back().T)
+					points.push_back({ t });
+			}
+
+			bool last = i == pilotCount - 1;
+			bool edge = !last && (b == a) != (lengths[i + 1] == b);
+			if ((last || edge) && pilot[i].T > points.back().T)
+				points.push_back({ pilot[i].T });
+		}
+
+		Utils::Evaluate(function, points);
+		states.assign(points.size() - 1, SegmentState::Open);
+
+		auto getMidpoint = [](const Utils::CurvePoint& start, const Utils::CurvePoint& end)
+		{
+			return Utils::CurvePoint{ (start.T + end.T) * 0.5f };
+		};
+
+		auto evaluate = [&](std::vector<Utils::CurvePoint>& midpoints)
+		{
+			Utils::Evaluate(function, midpoints);
+		};
+
+		auto test = [&](const Utils::CurvePoint& start, const Utils::CurvePoint& middle, const Utils::CurvePoint& end, size_t pointCount)
+		{
+			const glm::vec2& a = start.Position;
+			const glm::vec2& b = end.Position;
+
+			bool outside = Utils::IsOutside(a, b, spec) && Utils::IsOutside(a, middle.Position, spec);
+			bool split = pointCount < spec.MaxSamples && !outside && !IsFlatSegment(a, middle.Position, b, spec.PixelsPerUnit, spec.PixelTolerance);
+
+			return split ? SegmentState::Open : SegmentState::Closed;
+		};
+
+		RefineSegments(points, states, spec.MaxDepth, getMidpoint, evaluate, test);
+
+		size_t first = samples.size();
+		samples.reserve(samples.size() + points.size());
+		for (const Utils::CurvePoint& point : points)
+		{
+			if (IsFinitePoint(point.Position))
+				samples.push_back(point.Position);
+			else
+				samples.push_back({ point.Position.x, std::numeric_limits<float>::quiet_NaN() });
+		}
+
+		return samples.size() - first;
+	}
+
+}
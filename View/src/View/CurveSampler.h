@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <functional>
+
+namespace cv {
+
+	// evaluates the points of a parametric curve for a whole batch of parameters at once
+	using CurveFunction = std::function<void(const float* t, float* x, float* y, size_t count)>;
+
+	struct CurveSamplerSpecification
+	{
+		float MinT = 0.0f, MaxT = 1.0f;
+		glm::vec2 PixelsPerUnit = { 1.0f, 1.0f };
+		size_t MaxSamples = 100'000;
+
+		// the visible region, pieces of the curve that stay on one side outside of it are kept coarse
+		glm::vec2 Min = { -1.0f, -1.0f }, Max = { 1.0f, 1.0f };
+
+		// uniform steps over the parameter range that measure how long the curve is on screen
+		uint32_t PilotSamples = 512;
+
+		// the initial points are at most SegmentPixels apart, then segments are split until the midpoint is within PixelTolerance of the chord
+		float SegmentPixels = 64.0f;
+		float PixelTolerance = 0.5f;
+		uint32_t MaxDepth = 10;
+	};
+
+	class CurveSampler
+	{
+	public:
+		// appends the samples to the back of samples, returns the amount of samples added
+		// the points are spread by arc length on screen rather than by the parameter, so a curve that speeds up (spirals, lissajous
+		// figures) doesn't need the step of its fastest part everywhere, points where the curve is undefined come out with a NaN y
+		static size_t Sample(const CurveFunction& function, const CurveSamplerSpecification& spec, std::vector<glm::vec2>& samples);
+	};
+
+}
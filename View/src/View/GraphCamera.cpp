@@ -1,22 +1,27 @@
 #include "GraphCamera.h"
 
+#include <array>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
 namespace cv {
 
 	GraphCamera::GraphCamera(float width, float height)
-		: m_ViewMatrix(1.0f)
+		: m_ViewMatrix(1.0)
 	{
 		OnResize(width, height);
 	}
 
-	GraphCamera::GraphCamera(float left, float right, float bottom, float top)
-		: m_ViewMatrix(1.0f)
+	GraphCamera::GraphCamera(double left, double right, double bottom, double top)
+		: m_ViewMatrix(1.0)
 	{
 		SetProjection(left, right, bottom, top);
 		RecalculateViewMatrix();
 	}
 
-	GraphCamera::GraphCamera(float left, float right, float bottom, float top, float near, float far)
-		: m_ViewMatrix(1.0f)
+	GraphCamera::GraphCamera(double left, double right, double bottom, double top, double near, double far)
+		: m_ViewMatrix(1.0)
 	{
 		SetProjection(left, right, bottom, top, near, far);
 		RecalculateViewMatrix();
@@ -25,13 +30,13 @@ namespace cv {
 	bool GraphCamera::OnUpdate(Timestep ts, bool ignoreInput)
 	{
 		glm::vec2 mousePosition = Input::GetMousePosition();
-		glm::vec2 delta = m_MousePosition - mousePosition;
+		glm::dvec2 delta = m_MousePosition - mousePosition;
 		m_MousePosition = mousePosition;
 
 		if (!ignoreInput && Input::IsMouseButtonDown(MouseButton::ButtonLeft))
 		{
 			delta *= m_ZoomLevel;
-			SetPosition(m_Position - glm::vec3(-delta.x * 0.005f, delta.y * 0.005f, 0.0f));
+			SetPosition(m_Position - glm::dvec3(-delta.x * 0.005, delta.y * 0.005, 0.0));
 			return true;
 		}
 		return false;
@@ -46,8 +51,9 @@ namespace cv {
 		{
 			dispatcher.Dispatch<MouseScrolledEvent>([this, &changed](MouseScrolledEvent& event)
 			{
-				m_ZoomLevel -= event.GetYOffset() * 0.25f;
-				m_ZoomLevel = std::max(m_ZoomLevel, 0.25f);
+				// by a factor per notch, so it takes the same amount of scrolling to go from 1 to 1e-3 as from 1e-9 to 1e-12
+				m_ZoomLevel *= std::pow(0.8, (double)event.GetYOffset());
+				m_ZoomLevel = std::clamp(m_ZoomLevel, MinZoomLevel, MaxZoomLevel);
 				SetProjection(-m_AspectRatio * m_ZoomLevel, m_AspectRatio * m_ZoomLevel, -m_ZoomLevel, m_ZoomLevel);
 
 				changed = true;
@@ -60,26 +66,64 @@ namespace cv {
 
 	void GraphCamera::OnResize(float width, float height)
 	{
-		m_AspectRatio = width / height;
+		m_AspectRatio = (double)width / (double)height;
 		SetProjection(-m_AspectRatio * m_ZoomLevel, m_AspectRatio * m_ZoomLevel, -m_ZoomLevel, m_ZoomLevel);
 	}
 
-	void GraphCamera::SetProjection(float left, float right, float bottom, float top)
+	void GraphCamera::SetProjection(double left, double right, double bottom, double top)
 	{
-		m_ProjectionMatrix = glm::ortho(left, right, top, bottom, -1.0f, 1.0f);
+		m_ProjectionMatrix = glm::ortho(left, right, top, bottom, -1.0, 1.0);
 		m_ViewProjectionMatrix = m_ProjectionMatrix * m_ViewMatrix;
 	}
 
-	void GraphCamera::SetProjection(float left, float right, float bottom, float top, float near, float far)
+	void GraphCamera::SetProjection(double left, double right, double bottom, double top, double near, double far)
 	{
 		m_ProjectionMatrix = glm::ortho(left, right, top, bottom, near, far);
 		m_ViewProjectionMatrix = m_ProjectionMatrix * m_ViewMatrix;
 	}
 
+	glm::mat4 GraphCamera::GetViewProjectionMatrix(const glm::dvec2& origin) const
+	{
+		glm::dvec3 position = m_Position - glm::dvec3(origin, 0.0);
+		glm::dmat4 transform = glm::translate(glm::dmat4(1.0), position)
+			* glm::rotate(glm::dmat4(1.0), glm::radians((double)m_Rotation), glm::dvec3(0, 0, 1));
+
+		return glm::mat4(m_ProjectionMatrix * glm::inverse(transform));
+	}
+
+	glm::dvec4 GraphCamera::GetBounds() const
+	{
+		std::array corners = {
+			glm::dvec4(-1.0, -1.0, 0.0, 1.0),
+			glm::dvec4(-1.0,  1.0, 0.0, 1.0),
+			glm::dvec4( 1.0, -1.0, 0.0, 1.0),
+			glm::dvec4( 1.0,  1.0, 0.0, 1.0)
+		};
+
+		glm::dvec4 bounds = {
+			std::numeric_limits<double>::max(), -std::numeric_limits<double>::max(),
+			std::numeric_limits<double>::max(), -std::numeric_limits<double>::max()
+		};
+
+		glm::dmat4 inverse = glm::inverse(m_ViewProjectionMatrix);
+		for (const glm::dvec4& corner : corners)
+		{
+			glm::dvec4 position = inverse * corner;
+			position /= position.w;
+
+			bounds.x = std::min(bounds.x, position.x);
+			bounds.y = std::max(bounds.y, position.x);
+			bounds.z = std::min(bounds.z, position.y);
+			bounds.w = std::max(bounds.w, position.y);
+		}
+
+		return bounds;
+	}
+
 	void GraphCamera::RecalculateViewMatrix()
 	{
-		glm::mat4 transform = glm::translate(glm::mat4(1.0f), m_Position)
-			* glm::rotate(glm::mat4(1.0f), glm::radians(m_Rotation), glm::vec3(0, 0, 1));
+		glm::dmat4 transform = glm::translate(glm::dmat4(1.0), m_Position)
+			* glm::rotate(glm::dmat4(1.0), glm::radians((double)m_Rotation), glm::dvec3(0, 0, 1));
 
 		m_ViewMatrix = glm::inverse(transform);
 		m_ViewProjectionMatrix = m_ProjectionMatrix * m_ViewMatrix;
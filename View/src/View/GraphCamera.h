@@ -8,46 +8,57 @@
 
 namespace cv {
 
+	// kept in double precision so it can zoom in far enough that floats can't tell neighbouring pixels apart any more,
+	// the GPU only ever gets a view projection relative to an origin close to the view, see GetViewProjectionMatrix
 	class GraphCamera
 	{
 	public:
+		static constexpr double MinZoomLevel = 1e-12;
+		static constexpr double MaxZoomLevel = 1e12;
+
 		GraphCamera() = default;
 		GraphCamera(float width, float height);
-		GraphCamera(float left, float right, float bottom, float top);
-		GraphCamera(float left, float right, float bottom, float top, float near, float far);
+		GraphCamera(double left, double right, double bottom, double top);
+		GraphCamera(double left, double right, double bottom, double top, double near, double far);
 
 		bool OnUpdate(Timestep ts, bool ignoreInput = false);
 		bool OnEvent(Event& event, bool ignoreInput = false);
 
 		void OnResize(float width, float height);
 
-		void SetProjection(float left, float right, float bottom, float top);
-		void SetProjection(float left, float right, float bottom, float top, float near, float far);
+		void SetProjection(double left, double right, double bottom, double top);
+		void SetProjection(double left, double right, double bottom, double top, double near, double far);
 
-		const glm::vec3& GetPosition() const { return m_Position; }
-		void SetPosition(const glm::vec3& position) { m_Position = position; RecalculateViewMatrix(); }
+		const glm::dvec3& GetPosition() const { return m_Position; }
+		void SetPosition(const glm::dvec3& position) { m_Position = position; RecalculateViewMatrix(); }
 
 		float GetRotation() const { return m_Rotation; }
 		void SetRotation(float degrees) { m_Rotation = degrees; RecalculateViewMatrix(); }
 
-		float GetZoomLevel() const { return m_ZoomLevel; }
+		double GetZoomLevel() const { return m_ZoomLevel; }
+
+		const glm::dmat4& GetProjectionMatrix() const { return m_ProjectionMatrix; }
+		const glm::dmat4& GetViewMatrix() const { return m_ViewMatrix; }
+		const glm::dmat4& GetViewProjectionMatrix() const { return m_ViewProjectionMatrix; }
+
+		// for positions given relative to origin, worked out in double so only the small offsets get rounded to float
+		glm::mat4 GetViewProjectionMatrix(const glm::dvec2& origin) const;
 
-		const glm::mat4& GetProjectionMatrix() const { return m_ProjectionMatrix; }
-		const glm::mat4& GetViewMatrix() const { return m_ViewMatrix; }
-		const glm::mat4& GetViewProjectionMatrix() const { return m_ViewProjectionMatrix; }
+		// the visible world rectangle as (minX, maxX, minY, maxY)
+		glm::dvec4 GetBounds() const;
 	private:
 		void RecalculateViewMatrix();
 	private:
-		glm::mat4 m_ViewMatrix;
-		glm::mat4 m_ProjectionMatrix;
-		glm::mat4 m_ViewProjectionMatrix;
+		glm::dmat4 m_ViewMatrix;
+		glm::dmat4 m_ProjectionMatrix;
+		glm::dmat4 m_ViewProjectionMatrix;
 
 		glm::vec2 m_MousePosition = { 0.0f, 0.0f };
 
-		float m_AspectRatio;
-		float m_ZoomLevel = 1.0f;
+		double m_AspectRatio;
+		double m_ZoomLevel = 1.0;
 
-		glm::vec3 m_Position{ 0.0f, 0.0f, 0.0f };
+		glm::dvec3 m_Position{ 0.0, 0.0, 0.0 };
 		float m_Rotation = 0.0f;
 	};
 
@@ -0,0 +1,307 @@
+#include "ImplicitSampler.h"
+
+#include <Curve/Core/JobSystem.h>
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <unordered_map>
+
+namespace cv {
+
+	namespace Utils {
+
+		// positions are in leaf cells from spec.Min, corners go counter clockwise from the lower left one
+		struct ImplicitCell
+		{
+			int32_t X, Y, Size;
+			float Values[4];
+		};
+
+		// both ends sit on an edge of the leaf grid, neighbouring segments are joined through the edge they share
+		struct ImplicitSegment
+		{
+			uint64_t Edges[2];
+			glm::vec2 Points[2];
+		};
+
+		struct ImplicitGrid
+		{
+			glm::vec2 Min;
+			glm::vec2 CellSize; // of a leaf cell
+
+			glm::vec2 ToWorld(int32_t x, int32_t y) const { return Min + glm::vec2((float)x, (float)y) * CellSize; }
+		};
+
+		static uint64_t EdgeKey(int32_t x, int32_t y, bool vertical)
+		{
+			return ((uint64_t)(uint32_t)x << 33) | ((uint64_t)(uint32_t)y << 1) | (uint64_t)vertical;
+		}
+
+		static bool HasSignChange(const ImplicitCell& cell)
+		{
+			for (float value : cell.Values)
+			{
+				if (!std::isfinite(value))
+					return false;
+			}
+
+			bool positive = cell.Values[0] > 0.0f;
+			return (cell.Values[1] > 0.0f) != positive || (cell.Values[2] > 0.0f) != positive || (cell.Values[3] > 0.0f) != positive;
+		}
+
+		static void March(const ImplicitCell& cell, const ImplicitGrid& grid, std::vector<ImplicitSegment>& segments)
+		{
+			// edges always run from their lower/left corner, so both cells sharing an edge put the crossing at the same point
+			static constexpr int s_EdgeCorners[4][2] = { { 0, 1 }, { 1, 2 }, { 3, 2 }, { 0, 3 } };
+
+			int32_t x = cell.X, y = cell.Y;
+			glm::vec2 corners[4] = { grid.ToWorld(x, y), grid.ToWorld(x + 1, y), grid.ToWorld(x + 1, y + 1), grid.ToWorld(x, y + 1) };
+			uint64_t keys[4] = { EdgeKey(x, y, false), EdgeKey(x + 1, y, true), EdgeKey(x, y + 1, false), EdgeKey(x, y, true) };
+			const float* v = cell.Values;
+
+			int crossings[4];
+			int crossingCount = 0;
+			for (int e = 0; e < 4; e++)
+			{
+				if ((v[s_EdgeCorners[e][0]] > 0.0f) != (v[s_EdgeCorners[e][1]] > 0.0f))
+					crossings[crossingCount++] = e;
+			}
+
+			auto crossing = [&](int e)
+			{
+				int a = s_EdgeCorners[e][0], b = s_EdgeCorners[e][1];
+				float t = v[a] / (v[a] - v[b]);
+				return corners[a] + t * (corners[b] - corners[a]);
+			};
+
+			auto emit = [&](int e0, int e1)
+			{
+				segments.push_back({ { keys[e0], keys[e1] }, { crossing(e0), crossing(e1) } });
+			};
+
+			if (crossingCount == 2)
+				emit(crossings[0], crossings[1]);
+			else if (crossingCount == 4)
+			{
+				// a saddle, the average of the corners decides which pair of opposite corners is connected
+				float center = (v[0] + v[1] + v[2] + v[3]) * 0.25f;
+				if ((center > 0.0f) == (v[0] > 0.0f))
+				{
+					emit(0, 1);
+					emit(2, 3);
+				}
+				else
+				{
+					emit(3, 0);
+					emit(1, 2);
+				}
+			}
+		}
+
+		// breadth first, so every level of the cells is evaluated as one batch
+		static void Subdivide(const ImplicitFunction& function, const ImplicitIntervalFunction& bounds, const ImplicitGrid& grid, const ImplicitCell* first, size_t count, std::vector<ImplicitSegment>& segments)
+		{
+			thread_local std::vector<ImplicitCell> cells, parents;
+			thread_local std::vector<float> xs, ys, fs;
+
+			cells.assign(first, first + count);
+			while (!cells.empty())
+			{
+				parents.clear();
+				xs.clear();
+				ys.clear();
+
+				for (const ImplicitCell& cell : cells)
+				{
+					bool signChange = HasSignChange(cell);
+					bool leaf = cell.Size == 1;
+
+					if (bounds && (!signChange || leaf))
+					{
+						glm::vec2 min = grid.ToWorld(cell.X, cell.Y), max = grid.ToWorld(cell.X + cell.Size, cell.Y + cell.Size);
+						Interval f = bounds(Interval(min.x, max.x), Interval(min.y, max.y));
+
+						// a cell without a sign change may still hold a loop that misses its corners
+						bool mayContainCurve = !f.Empty && f.Min <= 0.0f && f.Max >= 0.0f;
+						if (!signChange && !mayContainCurve)
+							continue;
+
+						// a sign change across a pole or a jump isn't part of the curve
+						if (leaf && !f.Continuous)
+							continue;
+					}
+					else if (!signChange)
+						continue;
+
+					if (leaf)
+					{
+						if (signChange)
+							March(cell, grid, segments);
+						continue;
+					}
+
+					// the four edge midpoints and the center
+					static constexpr int32_t s_Midpoints[5][2] = { { 1, 0 }, { 2, 1 }, { 1, 2 }, { 0, 1 }, { 1, 1 } };
+
+					int32_t half = cell.Size / 2;
+					for (const auto& midpoint : s_Midpoints)
+					{
+						glm::vec2 position = grid.ToWorld(cell.X + midpoint[0] * half, cell.Y + midpoint[1] * half);
+						xs.push_back(position.x);
+						ys.push_back(position.y);
+					}
+					parents.push_back(cell);
+				}
+
+				cells.clear();
+				if (parents.empty())
+					break;
+
+				fs.resize(xs.size());
+				function(xs.data(), ys.data(), fs.data(), xs.size());
+
+				for (size_t i = 0; i < parents.size(); i++)
+				{
+					const ImplicitCell& parent = parents[i];
+					const float* v = parent.Values;
+					const float* m = fs.data() + i * 5; // bottom, right, top, left, center
+					int32_t half = parent.Size / 2;
+
+					cells.push_back({ parent.X,        parent.Y,        half, { v[0], m[0], m[4], m[3] } });
+					cells.push_back({ parent.X + half, parent.Y,        half, { m[0], v[1], m[1], m[4] } });
+					cells.push_back({ parent.X + half, parent.Y + half, half, { m[4], m[1], v[2], m[2] } });
+					cells.push_back({ parent.X,        parent.Y + half, half, { m[3], m[4], m[2], v[3] } });
+				}
+			}
+		}
+
+		// joins the segments that share an edge into polylines, closed loops end with their first point again
+		static size_t Stitch(const std::vector<ImplicitSegment>& segments, size_t maxSamples, std::vector<glm::vec2>& samples)
+		{
+			std::unordered_map<uint64_t, std::array<int32_t, 2>> edges;
+			edges.reserve(segments.size() * 2);
+			for (int32_t s = 0; s < (int32_t)segments.size(); s++)
+			{
+				for (uint64_t edge : segments[s].Edges)
+				{
+					auto& links = edges.try_emplace(edge, std::array<int32_t, 2>{ -1, -1 }).first->second;
+					if (links[0] == -1)
+						links[0] = s;
+					else if (links[1] == -1)
+						links[1] = s;
+				}
+			}
+
+			std::vector<bool> visited(segments.size(), false);
+			std::vector<glm::vec2> forward, backward;
+
+			// walks away from segment start through edge, collecting the far end of every segment on the way
+			auto walk = [&](int32_t start, uint64_t edge, std::vector<glm::vec2>& points)
+			{
+				points.clear();
+
+				int32_t current = start;
+				while (true)
+				{
+					const auto& links = edges[edge];
+					int32_t next = links[0] == current ? links[1] : links[0];
+					if (next == -1)
+						return;
+
+					if (visited[next])
+					{
+						if (next == start)
+							points.push_back(segments[start].Points[segments[start].Edges[0] == edge ? 0 : 1]);
+						return;
+					}
+
+					visited[next] = true;
+					int end = segments[next].Edges[0] == edge ? 1 : 0;
+					points.push_back(segments[next].Points[end]);
+					edge = segments[next].Edges[end];
+					current = next;
+				}
+			};
+
+			size_t first = samples.size();
+			for (int32_t s = 0; s < (int32_t)segments.size(); s++)
+			{
+				if (visited[s])
+					continue;
+
+				visited[s] = true;
+				walk(s, segments[s].Edges[1], forward);
+				walk(s, segments[s].Edges[0], backward);
+
+				size_t pointCount = backward.size() + 2 + forward.size();
+				if (samples.size() - first + pointCount + 1 > maxSamples)
+					break;
+
+				samples.insert(samples.end(), backward.rbegin(), backward.rend());
+				samples.push_back(segments[s].Points[0]);
+				samples.push_back(segments[s].Points[1]);
+				samples.insert(samples.end(), forward.begin(), forward.end());
+				samples.push_back({ samples.back().x, std::numeric_limits<float>::quiet_NaN() });
+			}
+
+			return samples.size() - first;
+		}
+
+	}
+
+	size_t ImplicitSampler::Sample(const ImplicitFunction& function, const ImplicitIntervalFunction& bounds, const ImplicitSamplerSpecification& spec, std::vector<glm::vec2>& samples)
+	{
+		if (spec.Max.x <= spec.Min.x || spec.Max.y <= spec.Min.y || spec.CellPixels <= 0.0f)
+			return 0;
+
+		Utils::ImplicitGrid grid;
+		grid.Min = spec.Min;
+		grid.CellSize = spec.CellPixels / spec.PixelsPerUnit;
+
+		int32_t cellSize = 1 << std::min(spec.Levels, 16u);
+		int32_t columns = (int32_t)std::min(std::ceil((spec.Max.x - spec.Min.x) / (grid.CellSize.x * (float)cellSize)), 4096.0f);
+		int32_t rows = (int32_t)std::min(std::ceil((spec.Max.y - spec.Min.y) / (grid.CellSize.y * (float)cellSize)), 4096.0f);
+
+		// the corners of the initial grid are evaluated once and shared by the cells around them
+		std::vector<float> xs, ys, fs;
+		for (int32_t y = 0; y <= rows; y++)
+		{
+			for (int32_t x = 0; x <= columns; x++)
+			{
+				glm::vec2 position = grid.ToWorld(x * cellSize, y * cellSize);
+				xs.push_back(position.x);
+				ys.push_back(position.y);
+			}
+		}
+
+		fs.resize(xs.size());
+		function(xs.data(), ys.data(), fs.data(), xs.size());
+
+		std::vector<Utils::ImplicitCell> cells;
+		cells.reserve((size_t)columns * rows);
+		for (int32_t y = 0; y < rows; y++)
+		{
+			for (int32_t x = 0; x < columns; x++)
+			{
+				size_t corner = (size_t)y * (columns + 1) + x;
+				cells.push_back({ x * cellSize, y * cellSize, cellSize, { fs[corner], fs[corner + 1], fs[corner + columns + 2], fs[corner + columns + 1] } });
+			}
+		}
+
+		static constexpr size_t s_GrainSize = 4;
+		std::vector<std::vector<Utils::ImplicitSegment>> chunkSegments((cells.size() + s_GrainSize - 1) / s_GrainSize);
+		JobSystem::ParallelFor(cells.size(), s_GrainSize, [&](size_t begin, size_t end)
+		{
+			Utils::Subdivide(function, bounds, grid, cells.data() + begin, end - begin, chunkSegments[begin / s_GrainSize]);
+		});
+
+		std::vector<Utils::ImplicitSegment> segments;
+		for (const auto& chunk : chunkSegments)
+			segments.insert(segments.end(), chunk.begin(), chunk.end());
+
+		return Utils::Stitch(segments, spec.MaxSamples, samples);
+	}
+
+}
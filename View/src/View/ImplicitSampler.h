@@ -0,0 +1,37 @@
+#pragma once
+
+#include <Curve/Expression/ExpressionInterval.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <functional>
+
+namespace cv {
+
+	// evaluates f(x, y) for a whole batch of points at once, the curve is where f changes sign
+	using ImplicitFunction = std::function<void(const float* x, const float* y, float* f, size_t count)>;
+
+	// bounds f over a box, lets the sampler skip boxes the curve can't pass through and find loops smaller than a cell
+	using ImplicitIntervalFunction = std::function<Interval(const Interval& x, const Interval& y)>;
+
+	struct ImplicitSamplerSpecification
+	{
+		glm::vec2 Min = { -1.0f, -1.0f }, Max = { 1.0f, 1.0f };
+		glm::vec2 PixelsPerUnit = { 1.0f, 1.0f };
+		size_t MaxSamples = 100'000;
+
+		// leaf cells are square on screen and at most CellPixels wide, the initial grid is 2^Levels leaf cells per cell
+		float CellPixels = 4.0f;
+		uint32_t Levels = 4;
+	};
+
+	class ImplicitSampler
+	{
+	public:
+		// appends the curve as polylines separated by samples with a NaN y, returns the amount of samples added
+		// only cells with a sign change at their corners (or an interval containing 0) are subdivided, in parallel on the job system
+		static size_t Sample(const ImplicitFunction& function, const ImplicitIntervalFunction& bounds, const ImplicitSamplerSpecification& spec, std::vector<glm::vec2>& samples);
+	};
+
+}
@@ -0,0 +1,95 @@
+#include "LineComputeGenerator.h"
+
+#include <Curve/Expression/ExpressionGLSL.h>
+
+#include <sstream>
+
+namespace cv {
+
+	std::string LineComputeGenerator::Generate(const std::vector<const Expression*>& expressions, uint32_t sampleCount)
+	{
+		std::ostringstream oss;
+
+		oss <<
+			"#type compute\n"
+			"#version 450 core\n"
+			"\n"
+			"struct Line\n"
+			"{\n"
+			"\tint VertexOffset;\n"
+			"\tint VertexCount;\n"
+			"\tint LineIndex;\n"
+			"};\n"
+			"\n"
+			"struct DrawCommand\n"
+			"{\n"
+			"\tuint VertexCount;\n"
+			"\tuint InstanceCount;\n"
+			"\tuint FirstVertex;\n"
+			"\tuint FirstInstance;\n"
+			"};\n"
+			"\n"
+			"layout(std430, binding = 0) buffer LineBuffer {\n"
+			"\tvec2 b_Vertices[];\n"
+			"};\n"
+			"\n"
+			"layout(std430, binding = 1) buffer LineData {\n"
+			"\tLine b_Lines[];\n"
+			"};\n"
+			"\n"
+			"layout(std430, binding = 2) buffer DrawBuffer {\n"
+			"\tDrawCommand b_Draws[];\n"
+			"};\n"
+			"\n"
+			"layout(push_constant) uniform Range {\n"
+			"\tfloat MinX;\n"
+			"\tfloat MaxX;\n"
+			"\tvec2 Origin;\n"
+			"} u_Range;\n"
+			"\n"
+			"layout(local_size_x = " << WorkGroupSize << ", local_size_y = 1, local_size_z = 1) in;\n"
+			"\n"
+			"const uint c_SampleCount = " << sampleCount << "u;\n"
+			"\n";
+
+		oss << ExpressionGLSL::GetPrelude() << "\n";
+
+		for (size_t i = 0; i < expressions.size(); i++)
+			oss << ExpressionGLSL::GenerateFunction(*expressions[i], "Line" + std::to_string(i)) << "\n";
+
+		oss <<
+			"float LineFunc(float x, uint line)\n"
+			"{\n"
+			"\tswitch (line)\n"
+			"\t{\n";
+		for (size_t i = 0; i < expressions.size(); i++)
+			oss << "\t\tcase " << i << "u: return Line" << i << "(x);\n";
+		oss <<
+			"\t}\n"
+			"\treturn 0.0;\n"
+			"}\n"
+			"\n";
+
+		oss <<
+			"void main()\n"
+			"{\n"
+			"\tuint index = gl_GlobalInvocationID.x;\n"
+			"\tif (index >= c_SampleCount)\n"
+			"\t\treturn;\n"
+			"\n"
+			"\tuint line = gl_WorkGroupID.y;\n"
+			"\tif (index == 0u)\n"
+			"\t{\n"
+			"\t\tb_Draws[line] = DrawCommand(uint(b_Lines[line].VertexCount), 1u, uint(b_Lines[line].VertexOffset), uint(b_Lines[line].LineIndex));\n"
+			"\t}\n"
+			"\n"
+			"\tfloat x = mix(u_Range.MinX, u_Range.MaxX, float(index) / float(c_SampleCount - 1u));\n"
+			"\n"
+			"\tuint vertex = uint(b_Lines[line].VertexOffset) + index;\n"
+			"\tb_Vertices[vertex] = vec2(x, LineFunc(x, line)) - u_Range.Origin;\n"
+			"}\n";
+
+		return oss.str();
+	}
+
+}
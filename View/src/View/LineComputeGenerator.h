@@ -0,0 +1,32 @@
+#pragma once
+
+#include <Curve/Expression/Expression.h>
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+namespace cv {
+
+	// per line data read by the generated shader, has to match the layout of Line in the generated source
+	// color and id come from the line styles when the vertices are drawn
+	struct LineComputeData
+	{
+		int VertexOffset;
+		int VertexCount; // drawn, 0 for a line that's sampled on the CPU for now
+		int LineIndex; // the line's style
+	};
+
+	class LineComputeGenerator
+	{
+	public:
+		// every workgroup row (gl_WorkGroupID.y) samples one of the expressions at sampleCount uniformly spaced x values
+		// the vertices are written relative to the origin in the push constants, like the ones sampled on the CPU
+		// every line also writes its own DrawIndirectCommand into the draw buffer, a line sampled on the CPU writes an empty one
+		static std::string Generate(const std::vector<const Expression*>& expressions, uint32_t sampleCount);
+
+		static constexpr uint32_t WorkGroupSize = 256;
+	};
+
+}
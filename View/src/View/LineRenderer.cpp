@@ -1,10 +1,39 @@
 #include "LineRenderer.h"
+#include "LineComputeGenerator.h"
+
+#include <Curve/Core/JobSystem.h>
 
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <cmath>
+#include <sstream>
+
 namespace cv {
 
-	static constexpr size_t s_MaxVertices = 100'000;
+	static constexpr size_t s_MaxLines = 4096;
+
+	// GPU sampled lines live at the start of the vertex buffer, one fixed size slot per line
+	static constexpr size_t s_MaxComputeLines = 256;
+	static constexpr size_t s_ComputeSamplesPerLine = 1024;
+	static constexpr size_t s_ComputeVertexOffset = 0;
+
+	// the rings of streamed lines come right after them
+	static constexpr size_t s_MaxStreamVertices = 262'144;
+	static constexpr size_t s_StreamVertexOffset = s_ComputeVertexOffset + s_MaxComputeLines * s_ComputeSamplesPerLine;
+
+	// the CPU sampled lines share the rest, which grows (at least doubling) whenever they don't fit any more
+	static constexpr size_t s_LineVertexOffset = s_StreamVertexOffset + s_MaxStreamVertices;
+	static constexpr size_t s_InitialLineVertices = 1 << 18;
+	static constexpr size_t s_MaxLineVertices = 1 << 26;
+	static constexpr size_t s_MaxVerticesPerLine = 1 << 20;
+
+	static constexpr size_t s_InitialLineDraws = 1024;
+
+	// smaller series are quick enough to scan on every redraw, bigger ones get a min/max pyramid next to them
+	static constexpr size_t s_SeriesPyramidThreshold = 1 << 24;
+
+	// the GPU lines are sampled in float, once a pixel is only a few ulps of the coordinates wide they go back to the CPU
+	static constexpr double s_ComputePixelPrecision = 16.0 * std::numeric_limits<float>::epsilon();
 
 	LineRenderer::LineRenderer(Renderer* renderer)
 		: m_Renderer(renderer)
@@ -13,11 +42,17 @@ namespace cv {
 		
 		InputLayout layout{};
 		layout.VertexLayout = {
-			{ ShaderDataType::Float3, "a_Position" },
-			{ ShaderDataType::Float4, "a_Color" },
-			{ ShaderDataType::Int,    "a_LineIndex" }
+			{ ShaderDataType::Float2, "a_Position" }
 		};
 
+		ShaderResourceInfo lineStyleResource{};
+		lineStyleResource.Binding = 0;
+		lineStyleResource.ResourceCount = 1;
+		lineStyleResource.ResourceType = ShaderResourceType::StorageBuffer;
+		lineStyleResource.Stage = ShaderStage::Vertex;
+
+		layout.ShaderResources.push_back(lineStyleResource);
+
 		PushConstantInfo cameraPushConstant{};
 		cameraPushConstant.Size = sizeof(glm::mat4);
 		cameraPushConstant.Offset = 0;
@@ -27,22 +62,18 @@ namespace cv {
 
 		m_Data.LineShader = renderer->CreateShader("Shaders/LineShader.shader");
 		m_Data.LinePipeline = renderer->CreateGraphicsPipeline(m_Data.LineShader, PrimitiveTopology::LineStrip, layout);
-		m_Data.LineVertexBuffer = renderer->CreateBuffer<VertexBuffer | StorageBuffer>(sizeof(LineVertex) * s_MaxVertices);
+		m_Data.LineVertexBuffer = renderer->CreateBuffer<VertexBuffer | StorageBuffer>(sizeof(LineVertex) * (s_LineVertexOffset + s_InitialLineVertices));
 
-		m_Data.LineVertexBufferBase = new LineVertex[s_MaxVertices];
-		
-		uint32_t imageCount = renderer->GetSwapchain()->GetImageCount();
+		m_Data.LineStyleBuffer = renderer->CreateBuffer<StorageBuffer>(sizeof(LineStyle) * s_MaxLines);
+		m_Data.LinePipeline->UpdateDescriptor(m_Data.LineStyleBuffer, 0);
+
+		uint32_t imageCount = renderer->GetImageCount();
 
 		m_Data.CommandBuffers.resize(imageCount);
 		for (CommandBuffer& commandBuffer : m_Data.CommandBuffers)
 			commandBuffer = renderer->AllocateCommandBuffer();
 
-		m_Redraw = true;
-		
-		for (size_t i = 0; i < imageCount; i++)
-		{
-			m_RecordCommandBuffer.push_back(true);
-		}
+		m_VertexAllocator.Reset(s_LineVertexOffset, s_InitialLineVertices);
 
 		Window& window = renderer->GetWindow();
 		m_Data.LineIDBuffer = renderer->CreateBuffer<StagingBuffer>(sizeof(int));
@@ -55,14 +86,17 @@ namespace cv {
 
 		InputLayout layout{};
 		layout.VertexLayout = {
-			{ ShaderDataType::Float4, "a_Position" },
-			{ ShaderDataType::Float4, "a_Color" },
-			{ ShaderDataType::Int,    "a_LineIndex" },
-			{ ShaderDataType::Int,    "a_Pad1" },
-			{ ShaderDataType::Int,    "a_Pad2" },
-			{ ShaderDataType::Int,    "a_Pad3" },
+			{ ShaderDataType::Float2, "a_Position" }
 		};
 
+		ShaderResourceInfo lineStyleResource{};
+		lineStyleResource.Binding = 0;
+		lineStyleResource.ResourceCount = 1;
+		lineStyleResource.ResourceType = ShaderResourceType::StorageBuffer;
+		lineStyleResource.Stage = ShaderStage::Vertex;
+
+		layout.ShaderResources.push_back(lineStyleResource);
+
 		PushConstantInfo cameraPushConstant{};
 		cameraPushConstant.Size = sizeof(glm::mat4);
 		cameraPushConstant.Offset = 0;
@@ -73,265 +107,1074 @@ namespace cv {
 		m_Data.LineShader = renderer->CreateShader("Shaders/LineShader.shader");
 		m_Data.LinePipeline = renderer->CreateGraphicsPipeline(m_Data.LineShader, PrimitiveTopology::LineStrip, layout, framebuffer);
 
-		m_Data.LineVertexBuffer = renderer->CreateBuffer<VertexBuffer | StorageBuffer>(sizeof(LineVertex) * s_MaxVertices);
+		m_Data.LineVertexBuffer = renderer->CreateBuffer<VertexBuffer | StorageBuffer>(sizeof(LineVertex) * (s_LineVertexOffset + s_InitialLineVertices));
 		m_Data.LineVertexBuffer->SetData(0, m_Data.LineVertexBuffer->GetSize());
 
-		m_Data.LineDataBuffer = renderer->CreateBuffer<StorageBuffer>(sizeof(int) * 2);
-
-		m_Data.LineVertexBufferBase = new LineVertex[s_MaxVertices];
-
-		layout = {};
-		
-		ShaderResourceInfo bufferResource1{};
-		bufferResource1.Binding = 0;
-		bufferResource1.ResourceCount = 1;
-		bufferResource1.ResourceType = ShaderResourceType::StorageBuffer;
-		bufferResource1.Stage = ShaderStage::Compute;
-
-		ShaderResourceInfo bufferResource2{};
-		bufferResource2.Binding = 1;
-		bufferResource2.ResourceCount = 1;
-		bufferResource2.ResourceType = ShaderResourceType::StorageBuffer;
-		bufferResource2.Stage = ShaderStage::Compute;
-
-		layout.ShaderResources.push_back(bufferResource1);
-		layout.ShaderResources.push_back(bufferResource2);
-	
-		cameraPushConstant.Stage = ShaderStage::Compute;
-
-		layout.PushConstants.push_back(cameraPushConstant);
-
-		m_Data.LineComputeShader = renderer->CreateShader("Shaders/LineCompute.shader");
-		m_Data.LineComputePipeline = renderer->CreateComputePipeline(m_Data.LineComputeShader, layout);
+		m_Data.LineDataBuffer = renderer->CreateBuffer<StorageBuffer>(sizeof(LineComputeData) * s_MaxComputeLines);
+		m_Data.LineComputeDrawBuffer = renderer->CreateBuffer<IndirectBuffer | StorageBuffer>(sizeof(DrawIndirectCommand) * s_MaxComputeLines);
 
-		m_Data.LineComputePipeline->UpdateDescriptor(m_Data.LineVertexBuffer, 0);
-		m_Data.LineComputePipeline->UpdateDescriptor(m_Data.LineDataBuffer, 1);
+		m_Data.LineStyleBuffer = renderer->CreateBuffer<StorageBuffer>(sizeof(LineStyle) * s_MaxLines);
+		m_Data.LinePipeline->UpdateDescriptor(m_Data.LineStyleBuffer, 0);
 
-		uint32_t imageCount = renderer->GetSwapchain()->GetImageCount();
+		uint32_t imageCount = renderer->GetImageCount();
 
 		m_Data.CommandBuffers.resize(imageCount);
 		for (CommandBuffer& commandBuffer : m_Data.CommandBuffers)
 			commandBuffer = renderer->AllocateCommandBuffer();
 
-		m_Redraw = true;
-
-		for (size_t i = 0; i < imageCount; i++)
-		{
-			m_RecordCommandBuffer.push_back(true);
-		}
+		m_VertexAllocator.Reset(s_LineVertexOffset, s_InitialLineVertices);
 
 		m_Data.LineIDBuffer = renderer->CreateBuffer<StagingBuffer>(sizeof(int));
-
-		m_Data.LineVertexCounts = { 2000, 2000 };
 	}
 
 	LineRenderer::~LineRenderer()
 	{
-		delete[] m_Data.LineVertexBufferBase;
-
 		delete m_Data.LineIDBuffer;
 		delete m_Data.LineVertexBuffer;
 		delete m_Data.LineDataBuffer;
-		delete m_Data.LineComputePipeline;
-		delete m_Data.LineComputeShader;
+		delete m_Data.LineComputeDrawBuffer;
+		delete m_Data.LineDrawBuffer;
+		delete m_Data.LineStyleBuffer;
+
+		// futures from std::async block on destruction anyway, collect the shaders so they can be freed
+		for (PendingLineCompute& pending : m_PendingLineComputes)
+			delete pending.Result.get();
+		for (auto& [hash, program] : m_LineComputeCache)
+		{
+			delete program.Pipeline;
+			delete program.ComputeShader;
+		}
+
 		delete m_Data.LinePipeline;
 		delete m_Data.LineShader;
 	}
 
-	static glm::vec4 ProjectionMinMax(const glm::mat4& proj)
+	Buffer<StagingBuffer>* LineRenderer::Render(const GraphCamera& camera)
 	{
-		std::array corners = {
-			glm::vec4(-1.0f, -1.0f, 0.0f, 1.0f),
-			glm::vec4(-1.0f,  1.0f, 0.0f, 1.0f),
-			glm::vec4( 1.0f, -1.0f, 0.0f, 1.0f),
-			glm::vec4( 1.0f,  1.0f, 0.0f, 1.0f)
-		};
+		uint32_t imageIndex = m_Renderer->GetImageIndex();
+		CommandBuffer commandBuffer = m_Data.CommandBuffers[imageIndex];
 
-		float minX = std::numeric_limits<float>::max();
-		float maxX = -std::numeric_limits<float>::max();
-		float minY = std::numeric_limits<float>::max();
-		float maxY = -std::numeric_limits<float>::max();
+		Window& window = m_Renderer->GetWindow();
+		float aspect = (float)window.GetWidth() / (float)window.GetHeight();
 
-		for (const auto& corner : corners)
-		{
-			glm::vec4 worldPos = glm::inverse(proj) * corner;
-			worldPos = glm::vec4(worldPos.x / worldPos.w, worldPos.y / worldPos.w, worldPos.z / worldPos.w, worldPos.w / worldPos.w);
+		DefragmentVertices();
+		if (m_Redraw)
+			SampleLines(camera, { (float)window.GetWidth(), (float)window.GetHeight() });
+		UploadLineStyles();
+		UploadStreams();
+		UploadDraws();
 
-			minX = std::min(minX, worldPos.x);
-			maxX = std::max(maxX, worldPos.x);
-			minY = std::min(minY, worldPos.y);
-			maxY = std::max(maxY, worldPos.y);
-		}
+		// sampled lines are relative to the origin, streamed ones are stored as they were appended
+		glm::mat4 cameraData = camera.GetViewProjectionMatrix(m_Origin);
+		glm::mat4 streamCameraData = camera.GetViewProjectionMatrix({ 0.0, 0.0 });
+
+		Swapchain* swapchain = m_Renderer->GetSwapchain();
+
+		m_Renderer->BeginCommandBuffer(commandBuffer);
+		swapchain->BeginRenderPass(commandBuffer);
 
-		return { minX, maxX, minY, maxY };
+		m_Data.LinePipeline->Bind(commandBuffer);
+		m_Data.LinePipeline->PushConstants(commandBuffer, ShaderStage::Vertex, sizeof(glm::mat4), &cameraData);
+		m_Data.LinePipeline->SetLineWidth(commandBuffer, 10.0f);
+
+		m_Data.LinePipeline->BindDescriptor(commandBuffer);
+		m_Data.LineVertexBuffer->Bind(commandBuffer);
+
+		if (!m_Data.LineDraws.empty())
+			m_Renderer->DrawIndirect(commandBuffer, m_Data.LineDrawBuffer, 0, (uint32_t)m_Data.LineDraws.size());
+
+		m_Data.LinePipeline->PushConstants(commandBuffer, ShaderStage::Vertex, sizeof(glm::mat4), &streamCameraData);
+		if (!m_Data.StreamDraws.empty())
+			m_Renderer->DrawIndirect(commandBuffer, m_Data.LineDrawBuffer, m_Data.LineDraws.size() * sizeof(DrawIndirectCommand), (uint32_t)m_Data.StreamDraws.size());
+
+		swapchain->EndRenderPass(commandBuffer);
+		m_Renderer->EndCommandBuffer(commandBuffer);
+		m_Renderer->SubmitCommandBuffer(commandBuffer);
+
+		return m_Data.LineIDBuffer;
 	}
 
-	Buffer<StagingBuffer>* LineRenderer::Render(const GraphCamera& camera)
+	Buffer<StagingBuffer>* LineRenderer::Render(const GraphCamera& camera, Framebuffer* framebuffer, const glm::vec2& relativeMousePosition)
 	{
-		uint32_t imageIndex = m_Renderer->GetSwapchain()->GetImageIndex();
+		uint32_t imageIndex = m_Renderer->GetImageIndex();
 		CommandBuffer commandBuffer = m_Data.CommandBuffers[imageIndex];
 
 		Window& window = m_Renderer->GetWindow();
-		float aspect = (float)window.GetWidth() / (float)window.GetHeight();
-		const glm::mat4& cameraData = camera.GetViewProjectionMatrix();
+		float aspect = (float)framebuffer->GetWidth() / (float)framebuffer->GetHeight();
 
+		UpdateLineCompute();
+
+		DefragmentVertices();
 		if (m_Redraw)
+			SampleLines(camera, { (float)framebuffer->GetWidth(), (float)framebuffer->GetHeight() });
+		UploadLineStyles();
+		UploadStreams();
+		UploadDraws();
+
+		// sampled lines are relative to the origin, streamed ones are stored as they were appended
+		glm::mat4 cameraData = camera.GetViewProjectionMatrix(m_Origin);
+		glm::mat4 streamCameraData = camera.GetViewProjectionMatrix({ 0.0, 0.0 });
+
+		m_Renderer->BeginCommandBuffer(commandBuffer);
+
+		bool computeLines = DispatchLineCompute(commandBuffer, camera);
+
+		framebuffer->BeginRenderPass(commandBuffer);
+
+		m_Data.LinePipeline->Bind(commandBuffer);
+		m_Data.LinePipeline->PushConstants(commandBuffer, ShaderStage::Vertex, cameraData);
+		m_Data.LinePipeline->SetLineWidth(commandBuffer, 10.0f);
+
+		m_Data.LinePipeline->BindDescriptor(commandBuffer);
+		m_Data.LineVertexBuffer->Bind(commandBuffer);
+
+		// the CPU lines, the GPU lines with the draws the compute shader just wrote and then the streamed lines, every dispatched
+		// line writes a draw (an empty one if it's sampled on the CPU for now), so the count is known here already
+		if (!m_Data.LineDraws.empty())
+			m_Renderer->DrawIndirect(commandBuffer, m_Data.LineDrawBuffer, 0, (uint32_t)m_Data.LineDraws.size());
+		if (computeLines)
+			m_Renderer->DrawIndirect(commandBuffer, m_Data.LineComputeDrawBuffer, 0, (uint32_t)m_Data.LineComputeLines.size());
+
+		m_Data.LinePipeline->PushConstants(commandBuffer, ShaderStage::Vertex, streamCameraData);
+		if (!m_Data.StreamDraws.empty())
+			m_Renderer->DrawIndirect(commandBuffer, m_Data.LineDrawBuffer, m_Data.LineDraws.size() * sizeof(DrawIndirectCommand), (uint32_t)m_Data.StreamDraws.size());
+
+		framebuffer->EndRenderPass(commandBuffer);
+		if (!(relativeMousePosition.x < 0 || relativeMousePosition.y < 0 || relativeMousePosition.x >(float)framebuffer->GetWidth() || relativeMousePosition.y >(float)framebuffer->GetHeight()))
+			framebuffer->CopyAttachmentImageToBuffer(commandBuffer, 1, m_Data.LineIDBuffer, relativeMousePosition);
+		m_Renderer->EndCommandBuffer(commandBuffer);
+		m_Renderer->SubmitCommandBuffer(commandBuffer);
+
+		return m_Data.LineIDBuffer;
+	}
+
+	int LineRenderer::PushLine(Line&& line)
+	{
+		if (m_Lines.size() >= s_MaxLines)
+		{
+			CV_ERROR("Failed to add line: there are already ", s_MaxLines, " lines");
+			return -1;
+		}
+
+		m_Lines.push_back(std::move(line));
+		m_Redraw = true;
+
+		return (int)m_Lines.size() - 1;
+	}
+
+	void LineRenderer::UploadLineStyles()
+	{
+		// lines are only ever added, so only the new ones are uploaded
+		if (m_LineStyleCount == m_Lines.size())
+			return;
+
+		size_t count = m_Lines.size() - m_LineStyleCount;
+		LineStyle* style = (LineStyle*)m_Data.LineStyleBuffer->Map(m_LineStyleCount * sizeof(LineStyle), count * sizeof(LineStyle));
+		for (size_t i = m_LineStyleCount; i < m_Lines.size(); i++)
+			*style++ = { m_Lines[i].Color, (int)i + 1, {} };
+		m_Data.LineStyleBuffer->Unmap();
+
+		m_LineStyleCount = m_Lines.size();
+	}
+
+	void LineRenderer::SampleLines(const GraphCamera& camera, const glm::vec2& viewportSize)
+	{
+		glm::dvec4 bounds = camera.GetBounds();
+		double zoomLevel = camera.GetZoomLevel();
+
+		// the margin scales with the view, a fixed one would be millions of tiles wide when zoomed in far enough
+		LineSamplerSpecification spec{};
+		spec.MinX = bounds.x - 0.5 * zoomLevel;
+		spec.MaxX = bounds.y + 0.5 * zoomLevel;
+		spec.PixelsPerUnit = viewportSize / glm::vec2(bounds.y - bounds.x, bounds.w - bounds.z);
+		spec.Step = 0.01 * (zoomLevel / 2.0);
+		spec.PixelTolerance = m_PixelTolerance;
+
+		// the origin only moves while every line is written again anyway, the clean ones stay relative to the old one
+		if (m_OriginDirty)
+		{
+			m_Origin = glm::dvec2(camera.GetPosition());
+			m_OriginDirty = false;
+		}
+
+		double pixelWidth = (bounds.y - bounds.x) / (double)viewportSize.x;
+		double extent = std::max({ std::abs(bounds.x), std::abs(bounds.y), std::abs(bounds.z), std::abs(bounds.w) });
+		m_LineComputeInRange = pixelWidth > extent * s_ComputePixelPrecision;
+
+		m_CPULines.resize(m_Lines.size());
+		m_SampleCache.BeginFrame();
+
+		size_t cpuLineCount = 0;
+		m_DirtyLines.clear();
+		m_LineTiles.clear();
+		m_PendingTiles.clear();
+		for (int i = 0; i < m_Lines.size(); i++)
 		{
-			m_Data.LineVertexBufferPtr = m_Data.LineVertexBufferBase;
-			m_Data.LineVertexCounts.clear();
+			// lines switched away from GPU sampling may still be in the old pipeline until the new one is ready
+			bool computeLine = m_LineComputeInRange && std::find(m_Data.LineComputeLines.begin(), m_Data.LineComputeLines.end(), i) != m_Data.LineComputeLines.end();
+			if (m_Lines[i].StreamCapacity > 0 || (m_Lines[i].SamplingMode == LineSamplingMode::GPU && computeLine))
+			{
+				ReleaseVertices(i);
+				continue;
+			}
+
+			cpuLineCount++;
+			if (m_CPULines[i].Dirty)
+				m_DirtyLines.push_back(i);
+		}
+
+		// the arena can't grow past s_MaxLineVertices, below that a line is only cut off past s_MaxVerticesPerLine
+		size_t lineBudget = cpuLineCount == 0 ? 0 : std::min(s_MaxVerticesPerLine, s_MaxLineVertices / cpuLineCount);
+		SampleCPULines(0, spec, bounds, lineBudget);
+
+		// a compacting pass lays every line out again from the start, they're all dirty already
+		if (m_Defragment)
+		{
+			// the lines move, older frames still drawing them from the vertex buffer have to be done first
+			m_Renderer->WaitForFramesInFlight();
+
+			m_Defragment = false;
+			m_VertexAllocator.Reset(s_LineVertexOffset, m_VertexAllocator.GetCapacity());
+			for (CPULine& cpuLine : m_CPULines)
+				cpuLine.VertexCapacity = 0;
+		}
 
-			glm::vec4 minMax = ProjectionMinMax(cameraData);
+		// once the lines need more than the arena holds it grows first, what's still left over after that is fragmentation
+		bool fits = std::all_of(m_DirtyLines.begin(), m_DirtyLines.end(), [&](int i) { return ReserveVertices(i, lineBudget); });
+		if (!fits)
+		{
+			size_t vertexCount = 0;
+			for (const CPULine& cpuLine : m_CPULines)
+				vertexCount += cpuLine.VertexCount;
+
+			if (vertexCount + vertexCount / 4 > m_VertexAllocator.GetCapacity())
+				GrowVertices(vertexCount + vertexCount / 4);
+		}
 
-			float minX = minMax.x - 0.5f;
-			float maxX = minMax.y + 0.5f;
-			float step = 0.01f * (camera.GetZoomLevel() / 2.0f);
+		// when the free ranges are too fragmented for a line every line is laid out again from the start, the ones that weren't
+		// dirty have to be sampled again for that, their vertices only exist on the GPU
+		bool relayout = !fits && !std::all_of(m_DirtyLines.begin(), m_DirtyLines.end(), [&](int i) { return ReserveVertices(i, lineBudget); });
+		if (relayout)
+		{
+			m_Renderer->WaitForFramesInFlight();
+			m_VertexAllocator.Reset(s_LineVertexOffset, m_VertexAllocator.GetCapacity());
 
+			size_t firstDirtyLine = m_DirtyLines.size();
 			for (int i = 0; i < m_Lines.size(); i++)
 			{
-				const auto& line = m_Lines[i];
+				// lines that don't own any vertices were released and are dirty already
+				CPULine& cpuLine = m_CPULines[i];
+				cpuLine.VertexCapacity = 0;
+				if (!cpuLine.Dirty)
+				{
+					cpuLine.Dirty = true;
+					m_DirtyLines.push_back(i);
+				}
+			}
+
+			SampleCPULines(firstDirtyLine, spec, bounds, lineBudget);
+
+			// only fails at s_MaxLineVertices, the lines that don't fit any more are left out until the next redraw
+			for (int i : m_DirtyLines)
+			{
+				if (!ReserveVertices(i, lineBudget))
+					m_CPULines[i].VertexCount = 0;
+			}
+		}
+
+		// one mapping covering all dirty lines, the lines in between are left as they are in the staging memory
+		size_t mapBegin = SIZE_MAX, mapEnd = 0;
+		for (int i : m_DirtyLines)
+		{
+			const CPULine& cpuLine = m_CPULines[i];
+			if (cpuLine.VertexCount == 0)
+				continue;
+
+			mapBegin = std::min(mapBegin, cpuLine.VertexOffset);
+			mapEnd = std::max(mapEnd, cpuLine.VertexOffset + cpuLine.VertexCount);
+		}
+
+		// the vertices go straight into the mapped staging memory of the vertex buffer, nothing is copied on the CPU side
+		m_Data.LineVertexBufferOffset = mapBegin;
+		m_Data.LineVertexBufferBase = mapEnd > 0 ? (LineVertex*)m_Data.LineVertexBuffer->Map(mapBegin * sizeof(LineVertex), (mapEnd - mapBegin) * sizeof(LineVertex)) : nullptr;
+
+		JobSystem::ParallelFor(m_DirtyLines.size(), 1, [this](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				CPULine& cpuLine = m_CPULines[m_DirtyLines[i]];
 
-				size_t& vertexCount = m_Data.LineVertexCounts.emplace_back();
-				vertexCount = 0;
+				cpuLine.Strips.clear();
+				if (cpuLine.VertexCount == 0)
+					continue;
 
-				for (float x = minX; x <= maxX; x += step)
+				// undefined samples and the breaks the sampler put at discontinuities end the current strip
+				LineVertex* vertex = m_Data.LineVertexBufferBase + (cpuLine.VertexOffset - m_Data.LineVertexBufferOffset);
+				LineVertex* vertexEnd = vertex + cpuLine.VertexCount;
+				LineVertex* stripStart = vertex;
+				auto endStrip = [&]()
 				{
-					m_Data.LineVertexBufferPtr->Position = { x, line.Function(x), 0.0f, 1.0f };
-					m_Data.LineVertexBufferPtr->Color = line.Color;
-					m_Data.LineVertexBufferPtr->LineIndex = i + 1;
-					m_Data.LineVertexBufferPtr++;
+					if (vertex - stripStart >= 2)
+						cpuLine.Strips.push_back({ m_Data.LineVertexBufferOffset + (size_t)(stripStart - m_Data.LineVertexBufferBase), (size_t)(vertex - stripStart) });
+					stripStart = vertex;
+				};
 
-					vertexCount++;
+				// tiles hold double samples, the other kinds of lines float ones, both end up as floats relative to the origin
+				auto writeSamples = [&](const auto& samples, size_t first)
+				{
+					for (size_t s = first; s < samples.size() && vertex < vertexEnd; s++)
+					{
+						glm::dvec2 sample = samples[s];
+						if (!std::isfinite(sample.y))
+						{
+							endStrip();
+							continue;
+						}
+
+						// whole vertices at a time, the mapped memory is usually write combined
+						*vertex++ = { glm::vec2(sample - m_Origin) };
+					}
+				};
+
+				for (size_t t = 0; t < cpuLine.TileCount; t++)
+				{
+					const LineSampleTile& tile = *m_LineTiles[cpuLine.FirstTile + t];
+					writeSamples(tile.Samples, t > 0 && tile.SharesBoundary ? 1 : 0);
 				}
+				writeSamples(cpuLine.Samples, 0);
+
+				endStrip();
 			}
+		});
 
-			size_t dataSize = (size_t)((uint8_t*)m_Data.LineVertexBufferPtr - (uint8_t*)m_Data.LineVertexBufferBase);
-			m_Data.LineVertexBuffer->SetData(m_Data.LineVertexBufferBase, dataSize);
+		for (int i : m_DirtyLines)
+			m_CPULines[i].Dirty = false;
 
-			m_Redraw = false;
+		// the draws are cheap to lay out again, unlike the vertices, the GPU lines write their own
+		m_Data.LineDraws.clear();
+		for (int i = 0; i < m_Lines.size(); i++)
+		{
+			for (const LineStrip& strip : m_CPULines[i].Strips)
+				m_Data.LineDraws.push_back({ (uint32_t)strip.VertexCount, 1, (uint32_t)strip.VertexOffset, (uint32_t)i });
 		}
+		m_DrawsDirty = true;
 
-		Swapchain* swapchain = m_Renderer->GetSwapchain();
+		m_SampleCache.EndFrame();
 
-		m_Renderer->BeginCommandBuffer(commandBuffer);
-		swapchain->BeginRenderPass(commandBuffer);
+		if (m_Data.LineVertexBufferBase)
+		{
+			m_Data.LineVertexBuffer->Unmap();
+			m_Data.LineVertexBufferBase = nullptr;
+		}
 
-		m_Data.LinePipeline->Bind(commandBuffer);
-		m_Data.LinePipeline->PushConstants(commandBuffer, ShaderStage::Vertex, sizeof(glm::mat4), &cameraData);
-		m_Data.LinePipeline->SetLineWidth(commandBuffer, 10.0f);
+		m_Redraw = false;
+	}
 
-		m_Data.LineVertexBuffer->Bind(commandBuffer);
+	void LineRenderer::SampleCPULines(size_t firstDirtyLine, const LineSamplerSpecification& spec, const glm::dvec4& bounds, size_t lineBudget)
+	{
+		std::span<const int> lines = std::span<const int>(m_DirtyLines).subspan(firstDirtyLine);
 
-		for (size_t i = 0; i < m_Lines.size(); i++)
-			m_Renderer->Draw(commandBuffer, m_Data.LineVertexCounts[i], i == 0 ? 0 : m_Data.LineVertexCounts[i - 1]);
+		size_t firstPendingTile = m_PendingTiles.size();
+		for (int i : lines)
+		{
+			CPULine& cpuLine = m_CPULines[i];
+			cpuLine.FirstTile = m_LineTiles.size();
+			cpuLine.Samples.clear();
+			if (m_Lines[i].Function)
+				m_SampleCache.GetTiles(i, m_Lines[i].SamplingMode, spec, m_LineTiles);
+			cpuLine.TileCount = m_LineTiles.size() - cpuLine.FirstTile;
+
+			for (size_t t = cpuLine.FirstTile; t < m_LineTiles.size(); t++)
+			{
+				if (!m_LineTiles[t]->Sampled)
+					m_PendingTiles.push_back({ i, m_LineTiles[t] });
+			}
+		}
 
-		swapchain->EndRenderPass(commandBuffer);
-		m_Renderer->EndCommandBuffer(commandBuffer);
-		m_Renderer->SubmitCommandBuffer(commandBuffer);
+		// only tiles that weren't visible at this zoom level before get sampled, every one of them on its own job
+		JobSystem::ParallelFor(m_PendingTiles.size() - firstPendingTile, 1, [this, firstPendingTile](size_t begin, size_t end)
+		{
+			for (size_t i = firstPendingTile + begin; i < firstPendingTile + end; i++)
+			{
+				LineSampleTile& tile = *m_PendingTiles[i].Tile;
+				const Line& line = m_Lines[m_PendingTiles[i].LineIndex];
+				LineSampler::Sample(line.Function, line.Continuity, tile.Mode, tile.Spec, tile.Samples);
+				tile.Sampled = true;
+			}
+		});
+
+		// the other kinds of lines are still sampled in float
+		double margin = bounds.x - spec.MinX;
+
+		ImplicitSamplerSpecification implicitSpec{};
+		implicitSpec.Min = glm::vec2(spec.MinX, bounds.z - margin);
+		implicitSpec.Max = glm::vec2(spec.MaxX, bounds.w + margin);
+		implicitSpec.PixelsPerUnit = spec.PixelsPerUnit;
+		implicitSpec.MaxSamples = lineBudget;
+
+		CurveSamplerSpecification curveSpec{};
+		curveSpec.Min = implicitSpec.Min;
+		curveSpec.Max = implicitSpec.Max;
+		curveSpec.PixelsPerUnit = spec.PixelsPerUnit;
+		curveSpec.PixelTolerance = m_PixelTolerance;
+		curveSpec.MaxSamples = lineBudget;
+
+		// columns line up with the pixels, so the decimated series covers exactly what the whole one would
+		SeriesDecimatorSpecification seriesSpec{};
+		seriesSpec.MinX = (float)bounds.x;
+		seriesSpec.MaxX = (float)bounds.y;
+		seriesSpec.PixelsPerUnit = spec.PixelsPerUnit.x;
+		seriesSpec.MaxSamples = lineBudget;
+
+		// implicit lines and series are spread over the job system on their own, waiting on them here helps out with that
+		JobSystem::ParallelFor(lines.size(), 1, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				CPULine& cpuLine = m_CPULines[lines[i]];
+				const Line& line = m_Lines[lines[i]];
 
-		m_RecordCommandBuffer[imageIndex] = false;
+				if (line.Implicit)
+					ImplicitSampler::Sample(line.Implicit, line.ImplicitBounds, implicitSpec, cpuLine.Samples);
+				else if (line.Curve)
+				{
+					CurveSamplerSpecification lineSpec = curveSpec;
+					lineSpec.MinT = line.MinT;
+					lineSpec.MaxT = line.MaxT;
+					CurveSampler::Sample(line.Curve, lineSpec, cpuLine.Samples);
+				}
+				else if (line.Series)
+					line.Series(seriesSpec, cpuLine.Samples);
+			}
+		});
 
-		return m_Data.LineIDBuffer;
+		// the breaks between strips leave a few unused vertices at the end of a line
+		for (int i : lines)
+		{
+			CPULine& cpuLine = m_CPULines[i];
+
+			size_t vertexCount = cpuLine.Samples.size();
+			for (size_t t = 0; t < cpuLine.TileCount; t++)
+			{
+				const LineSampleTile& tile = *m_LineTiles[cpuLine.FirstTile + t];
+				vertexCount += tile.Samples.size() - (t > 0 && tile.SharesBoundary && !tile.Samples.empty() ? 1 : 0);
+			}
+
+			// only reachable with a lot of very detailed lines, the right end of the line gets cut off
+			cpuLine.VertexCount = std::min(vertexCount, lineBudget);
+		}
 	}
 
-	Buffer<StagingBuffer>* LineRenderer::Render(const GraphCamera& camera, Framebuffer* framebuffer, const glm::vec2& relativeMousePosition)
+	bool LineRenderer::ReserveVertices(int index, size_t lineBudget)
 	{
-		uint32_t imageIndex = m_Renderer->GetSwapchain()->GetImageIndex();
-		CommandBuffer commandBuffer = m_Data.CommandBuffers[imageIndex];
+		CPULine& cpuLine = m_CPULines[index];
+		if (cpuLine.VertexCount <= cpuLine.VertexCapacity && cpuLine.VertexCapacity <= lineBudget)
+			return true;
+
+		if (cpuLine.VertexCapacity > 0)
+			m_VertexAllocator.Free(cpuLine.VertexOffset, cpuLine.VertexCapacity);
+		cpuLine.VertexCapacity = 0;
+
+		// some room to grow, so zooming in a little doesn't move the line every time
+		size_t capacity = std::min(cpuLine.VertexCount + cpuLine.VertexCount / 4, lineBudget);
+		size_t offset = m_VertexAllocator.Allocate(capacity);
+		if (offset == VertexAllocator::InvalidOffset)
+			offset = m_VertexAllocator.Allocate(capacity = cpuLine.VertexCount);
+
+		if (offset == VertexAllocator::InvalidOffset)
+			return cpuLine.VertexCount == 0;
+
+		cpuLine.VertexOffset = offset;
+		cpuLine.VertexCapacity = capacity;
+		return true;
+	}
 
-		Window& window = m_Renderer->GetWindow();
-		float aspect = (float)framebuffer->GetWidth() / (float)framebuffer->GetHeight();
-		const glm::mat4& cameraData = camera.GetViewProjectionMatrix();
+	void LineRenderer::ReleaseVertices(int index)
+	{
+		CPULine& cpuLine = m_CPULines[index];
+		if (cpuLine.VertexCapacity > 0)
+			m_VertexAllocator.Free(cpuLine.VertexOffset, cpuLine.VertexCapacity);
+
+		cpuLine.VertexCapacity = 0;
+		cpuLine.VertexCount = 0;
+		cpuLine.Strips.clear();
+		cpuLine.Samples.clear();
+
+		// sampled from scratch once it's drawn from the CPU again
+		cpuLine.Dirty = true;
+	}
+
+	void LineRenderer::GrowVertices(size_t capacity)
+	{
+		size_t previousCapacity = m_VertexAllocator.GetCapacity();
+		capacity = std::min(std::max(capacity, previousCapacity * 2), s_MaxLineVertices);
+		if (capacity <= previousCapacity)
+			return;
+
+		// everything written so far can be read back through Map, out of the staging memory or, on unified memory, out of the
+		// buffer itself, stream rings and clean lines included, the GPU lines are written again every frame anyway; the old
+		// buffer is only read, unmapping it would queue an upload into a buffer that's about to be freed
+		Buffer<VertexBuffer | StorageBuffer>* vertexBuffer = m_Renderer->CreateBuffer<VertexBuffer | StorageBuffer>(sizeof(LineVertex) * (s_LineVertexOffset + capacity));
+		size_t size = m_Data.LineVertexBuffer->GetSize();
+		memcpy(vertexBuffer->Map(0, size), m_Data.LineVertexBuffer->Map(0, size), size);
+		vertexBuffer->Unmap();
+
+		// frames still in flight draw from the old buffer, the renderer frees it once their fences and upload batches are signaled
+		delete m_Data.LineVertexBuffer;
+		m_Data.LineVertexBuffer = vertexBuffer;
+		m_VertexAllocator.Grow(capacity);
+
+		// the compute pipelines write into the old buffer, their descriptor sets might still be in use as well
+		for (auto& [hash, program] : m_LineComputeCache)
+		{
+			delete program.Pipeline;
+			program.Pipeline = CreateLineComputePipeline(program.ComputeShader);
+			if (hash == m_Data.LineComputeHash)
+				m_Data.LineComputePipeline = program.Pipeline;
+		}
+	}
+
+	void LineRenderer::DefragmentVertices()
+	{
+		// compacting writes every line again, so it waits for a frame that has nothing else to do
+		if (m_Redraw)
+			return;
+
+		size_t freeCount = m_VertexAllocator.GetFreeCount();
+		if (freeCount < m_VertexAllocator.GetCapacity() / 4 || m_VertexAllocator.GetLargestFreeCount() >= freeCount / 2)
+			return;
+
+		// the samples mostly come straight from the tile cache
+		for (CPULine& cpuLine : m_CPULines)
+			cpuLine.Dirty = true;
+		m_Defragment = true;
+		m_Redraw = true;
+	}
+
+	void LineRenderer::MarkLineDirty(int index)
+	{
+		// lines that were just added don't have a CPULine yet, they start out dirty
+		if (index < m_CPULines.size())
+			m_CPULines[index].Dirty = true;
+		m_Redraw = true;
+	}
+
+	void LineRenderer::UploadStreams()
+	{
+		if (!m_StreamsDirty)
+			return;
 
-		/*if (m_Redraw)
+		m_StreamsDirty = false;
+		m_Data.StreamDraws.clear();
+		m_DrawsDirty = true;
+
+		for (int i = 0; i < m_Lines.size(); i++)
 		{
-			m_Data.LineVertexBufferPtr = m_Data.LineVertexBufferBase;
-			m_Data.LineVertexCounts.clear();
+			Line& line = m_Lines[i];
+			if (line.StreamCapacity == 0)
+				continue;
+
+			auto write = [&](size_t slot, std::span<const glm::vec2> samples)
+			{
+				LineVertex* vertex = (LineVertex*)m_Data.LineVertexBuffer->Map((line.StreamOffset + slot) * sizeof(LineVertex), samples.size() * sizeof(LineVertex));
+				for (const glm::vec2& sample : samples)
+					*vertex++ = { sample };
+				m_Data.LineVertexBuffer->Unmap();
+			};
+
+			// samples that would be overwritten within the same frame are skipped, the ring ends up the same
+			std::span<const glm::vec2> pending = line.PendingSamples;
+			if (pending.size() > line.StreamCapacity)
+			{
+				line.StreamCount += pending.size() - line.StreamCapacity;
+				pending = pending.last(line.StreamCapacity);
+			}
+
+			// at most two ranges, up to the end of the ring and then on from its start
+			while (!pending.empty())
+			{
+				size_t slot = line.StreamCount % line.StreamCapacity;
+				size_t count = std::min(pending.size(), line.StreamCapacity - slot);
 
-			glm::vec4 minMax = ProjectionMinMax(cameraData);
+				write(slot, pending.first(count));
+				if (slot == 0)
+					write(line.StreamCapacity, pending.first(1));
 
-			int desiredVertexCount = 2000; // per line
+				line.StreamCount += count;
+				pending = pending.subspan(count);
+			}
+			line.PendingSamples.clear();
+
+			// oldest to newest, once the ring wrapped that's from the next slot to be written to its end and through the repeated
+			// first slot, then on from the first slot
+			size_t count = std::min(line.StreamCount, line.StreamCapacity);
+			size_t start = line.StreamCount > line.StreamCapacity ? line.StreamCount % line.StreamCapacity : 0;
+			if (count < 2)
+				continue;
+
+			m_Data.StreamDraws.push_back({ (uint32_t)(start == 0 ? count : line.StreamCapacity + 1 - start), 1, (uint32_t)(line.StreamOffset + start), (uint32_t)i });
+			if (start >= 2)
+				m_Data.StreamDraws.push_back({ (uint32_t)start, 1, (uint32_t)line.StreamOffset, (uint32_t)i });
+		}
+	}
 
-			float minX = minMax[0] - 0.5f;
-			float maxX = minMax[1] + 0.5f;
+	void LineRenderer::UploadDraws()
+	{
+		if (!m_DrawsDirty)
+			return;
 
-			float range = maxX - minX;
-			float step = range / (desiredVertexCount - 1);
+		m_DrawsDirty = false;
 
-			for (int i = 0; i < m_Lines.size(); i++)
+		size_t drawCount = m_Data.LineDraws.size() + m_Data.StreamDraws.size();
+		if (drawCount == 0)
+			return;
+
+		// frames still in flight keep drawing from the old buffer until it's freed
+		if (drawCount > m_Data.LineDrawCapacity)
+		{
+			m_Data.LineDrawCapacity = std::max({ drawCount, m_Data.LineDrawCapacity * 2, s_InitialLineDraws });
+
+			delete m_Data.LineDrawBuffer;
+			m_Data.LineDrawBuffer = m_Renderer->CreateBuffer<IndirectBuffer>(sizeof(DrawIndirectCommand) * m_Data.LineDrawCapacity);
+		}
+
+		DrawIndirectCommand* draws = (DrawIndirectCommand*)m_Data.LineDrawBuffer->Map(drawCount * sizeof(DrawIndirectCommand));
+		draws = std::copy(m_Data.LineDraws.begin(), m_Data.LineDraws.end(), draws);
+		std::copy(m_Data.StreamDraws.begin(), m_Data.StreamDraws.end(), draws);
+		m_Data.LineDrawBuffer->Unmap();
+	}
+
+	void LineRenderer::UpdateLineCompute()
+	{
+		if (!m_Data.LineDataBuffer)
+			return;
+
+		if (m_LineComputeDirty)
+		{
+			m_LineComputeDirty = false;
+
+			std::vector<const Expression*> expressions;
+			m_TargetLineComputeLines.clear();
+			for (int i = 0; i < m_Lines.size() && expressions.size() < s_MaxComputeLines; i++)
 			{
-				const auto& line = m_Lines[i];
+				const Line& line = m_Lines[i];
+				if (line.SamplingMode != LineSamplingMode::GPU || !line.Expr.IsValid() || line.Expr.GetVariables().size() != 1)
+					continue;
+
+				expressions.push_back(&line.Expr);
+				m_TargetLineComputeLines.push_back(i);
+			}
 
-				size_t& vertexCount = m_Data.LineVertexCounts.emplace_back();
-				vertexCount = 0;
+			m_TargetLineComputeHash = 0;
+			if (!expressions.empty())
+			{
+				std::string source = LineComputeGenerator::Generate(expressions, (uint32_t)s_ComputeSamplesPerLine);
+				m_TargetLineComputeHash = std::hash<std::string>()(source);
 
-				for (float x = minX; x <= maxX; x += step)
+				bool pending = std::any_of(m_PendingLineComputes.begin(), m_PendingLineComputes.end(), [this](const PendingLineCompute& pending) { return pending.Hash == m_TargetLineComputeHash; });
+				if (!pending && m_LineComputeCache.find(m_TargetLineComputeHash) == m_LineComputeCache.end())
 				{
-					m_Data.LineVertexBufferPtr->Position = { x, line.Function(x), 0.0f };
-					m_Data.LineVertexBufferPtr->Color = line.Color;
-					m_Data.LineVertexBufferPtr->LineIndex = i + 1;
-					m_Data.LineVertexBufferPtr++;
-
-					vertexCount++;
+					// the hash doubles as the binary cache name, so the same set of lines is never compiled twice across runs either
+					std::stringstream name;
+					name << "LineCompute_" << std::hex << m_TargetLineComputeHash;
+
+					m_PendingLineComputes.push_back({ m_TargetLineComputeHash, std::async(std::launch::async, [renderer = m_Renderer, name = name.str(), source = std::move(source)]()
+					{
+						return renderer->CreateShader(name, source);
+					}) });
 				}
 			}
+		}
 
-			size_t dataSize = (size_t)((uint8_t*)m_Data.LineVertexBufferPtr - (uint8_t*)m_Data.LineVertexBufferBase);
-			m_Data.LineVertexBuffer->SetData(m_Data.LineVertexBufferBase, dataSize);
+		for (auto it = m_PendingLineComputes.begin(); it != m_PendingLineComputes.end();)
+		{
+			if (it->Result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				it++;
+				continue;
+			}
 
-			m_Redraw = false;
-		}*/
+			Shader* shader = it->Result.get();
+			m_LineComputeCache[it->Hash] = { shader, CreateLineComputePipeline(shader) };
+			it = m_PendingLineComputes.erase(it);
+		}
 
-		Swapchain* swapchain = m_Renderer->GetSwapchain();
+		if (m_Data.LineComputeHash == m_TargetLineComputeHash)
+			return;
 
-		m_Renderer->BeginCommandBuffer(commandBuffer);
+		// until the new pipeline is ready the old one keeps running, lines it doesn't cover are sampled on the CPU
+		LineComputeProgram program{};
+		if (m_TargetLineComputeHash)
+		{
+			auto it = m_LineComputeCache.find(m_TargetLineComputeHash);
+			if (it == m_LineComputeCache.end())
+				return;
+
+			program = it->second;
+		}
+
+		m_Data.LineComputeShader = program.ComputeShader;
+		m_Data.LineComputePipeline = program.Pipeline;
+		m_Data.LineComputeHash = m_TargetLineComputeHash;
+		m_Data.LineComputeLines = m_TargetLineComputeLines;
+
+		UploadLineComputeData();
+
+		// lines that moved in or out of the pipeline are released or dirty already, only the draws have to be laid out again
+		m_Redraw = true;
+	}
+
+	void LineRenderer::UploadLineComputeData()
+	{
+		if (m_Data.LineComputeLines.empty())
+			return;
+
+		// lines switched away from GPU sampling stay in the pipeline until the next one is ready, they just aren't drawn
+		std::vector<LineComputeData> lineData(m_Data.LineComputeLines.size());
+		for (size_t i = 0; i < lineData.size(); i++)
+		{
+			int line = m_Data.LineComputeLines[i];
+			lineData[i].VertexOffset = (int)(s_ComputeVertexOffset + i * s_ComputeSamplesPerLine);
+			lineData[i].VertexCount = m_Lines[line].SamplingMode == LineSamplingMode::GPU ? (int)s_ComputeSamplesPerLine : 0;
+			lineData[i].LineIndex = line;
+		}
+
+		m_Data.LineDataBuffer->SetData(lineData.data(), lineData.size() * sizeof(LineComputeData));
+	}
+
+	bool LineRenderer::DispatchLineCompute(CommandBuffer commandBuffer, const GraphCamera& camera)
+	{
+		if (!m_Data.LineComputePipeline || !m_LineComputeInRange)
+			return false;
+
+		// the same margin as the CPU lines, see SampleLines
+		glm::dvec4 bounds = camera.GetBounds();
+		double margin = 0.5 * camera.GetZoomLevel();
+		glm::vec4 range = { bounds.x - margin, bounds.y + margin, m_Origin.x, m_Origin.y };
+
+		// the GPU lines follow the view, so they are regenerated every frame
+		m_Renderer->ComputeBarrier(commandBuffer);
 
 		m_Data.LineComputePipeline->Bind(commandBuffer);
-		m_Data.LineComputePipeline->PushConstants(commandBuffer, cameraData);
 		m_Data.LineComputePipeline->BindDescriptor(commandBuffer);
+		m_Data.LineComputePipeline->PushConstants(commandBuffer, range);
 
-		m_Renderer->Dispatch(commandBuffer, 8, 1, 1);
+		uint32_t groupCountX = (uint32_t)((s_ComputeSamplesPerLine + LineComputeGenerator::WorkGroupSize - 1) / LineComputeGenerator::WorkGroupSize);
+		m_Renderer->Dispatch(commandBuffer, groupCountX, (uint32_t)m_Data.LineComputeLines.size(), 1);
 
-		framebuffer->BeginRenderPass(commandBuffer);
+		m_Renderer->ComputeBarrier(commandBuffer);
+		return true;
+	}
 
-		m_Data.LinePipeline->Bind(commandBuffer);
-		m_Data.LinePipeline->PushConstants(commandBuffer, ShaderStage::Vertex, cameraData);
-		m_Data.LinePipeline->SetLineWidth(commandBuffer, 10.0f);
+	ComputePipeline* LineRenderer::CreateLineComputePipeline(Shader* shader)
+	{
+		InputLayout layout{};
 
-		m_Data.LineVertexBuffer->Bind(commandBuffer);
+		ShaderResourceInfo vertexBufferResource{};
+		vertexBufferResource.Binding = 0;
+		vertexBufferResource.ResourceCount = 1;
+		vertexBufferResource.ResourceType = ShaderResourceType::StorageBuffer;
+		vertexBufferResource.Stage = ShaderStage::Compute;
+
+		ShaderResourceInfo lineDataResource{};
+		lineDataResource.Binding = 1;
+		lineDataResource.ResourceCount = 1;
+		lineDataResource.ResourceType = ShaderResourceType::StorageBuffer;
+		lineDataResource.Stage = ShaderStage::Compute;
+
+		ShaderResourceInfo drawResource{};
+		drawResource.Binding = 2;
+		drawResource.ResourceCount = 1;
+		drawResource.ResourceType = ShaderResourceType::StorageBuffer;
+		drawResource.Stage = ShaderStage::Compute;
+
+		layout.ShaderResources.push_back(vertexBufferResource);
+		layout.ShaderResources.push_back(lineDataResource);
+		layout.ShaderResources.push_back(drawResource);
+
+		PushConstantInfo rangePushConstant{};
+		rangePushConstant.Size = sizeof(glm::vec4);
+		rangePushConstant.Offset = 0;
+		rangePushConstant.Stage = ShaderStage::Compute;
+
+		layout.PushConstants.push_back(rangePushConstant);
+
+		ComputePipeline* pipeline = m_Renderer->CreateComputePipeline(shader, layout);
+		pipeline->UpdateDescriptor(m_Data.LineVertexBuffer, 0);
+		pipeline->UpdateDescriptor(m_Data.LineDataBuffer, 1);
+		pipeline->UpdateDescriptor(m_Data.LineComputeDrawBuffer, 2);
+		return pipeline;
+	}
 
-		m_Renderer->Draw(commandBuffer, 2000, 0);
-		m_Renderer->Draw(commandBuffer, 2000, 2000);
+	void LineRenderer::AddLine(std::function<double(double)>&& f, const glm::vec4& color, LineSamplingMode samplingMode)
+	{
+		LineFunction function = [f = std::move(f)](const double* x, double* y, size_t count)
+		{
+			for (size_t i = 0; i < count; i++)
+				y[i] = f(x[i]);
+		};
 
-		framebuffer->EndRenderPass(commandBuffer);
-		if (!(relativeMousePosition.x < 0 || relativeMousePosition.y < 0 || relativeMousePosition.x >(float)framebuffer->GetWidth() || relativeMousePosition.y >(float)framebuffer->GetHeight()))
-			framebuffer->CopyAttachmentImageToBuffer(commandBuffer, 1, m_Data.LineIDBuffer, relativeMousePosition);
-		m_Renderer->EndCommandBuffer(commandBuffer);
-		m_Renderer->SubmitCommandBuffer(commandBuffer);
+		PushLine({ function, {}, {}, color, samplingMode });
+	}
 
-		m_RecordCommandBuffer[imageIndex] = false;
+	void LineRenderer::AddLine(const Expression& expression, const glm::vec4& color, LineSamplingMode samplingMode)
+	{
+		if (!expression.IsValid())
+		{
+			CV_ERROR("Failed to add line '", expression.GetSource(), "': ", expression.GetError());
+			return;
+		}
 
-		return m_Data.LineIDBuffer;
+		LineFunction function = [expression](const double* x, double* y, size_t count)
+		{
+			expression.Evaluate(x, y, count);
+		};
+
+		// intervals are float, rounded outwards so the range is still covered
+		LineContinuityFunction continuity = [expression](double minX, double maxX)
+		{
+			float min = (float)minX, max = (float)maxX;
+			if ((double)min > minX)
+				min = std::nextafter(min, -std::numeric_limits<float>::infinity());
+			if ((double)max < maxX)
+				max = std::nextafter(max, std::numeric_limits<float>::infinity());
+
+			Interval y = expression.Evaluate(Interval(min, max));
+			return y.Continuous || y.Empty;
+		};
+
+		PushLine({ function, continuity, expression, color, samplingMode });
+		m_LineComputeDirty = true;
 	}
 
-	void LineRenderer::AddLine(std::function<float(float)>&& f, const glm::vec4& color)
+	void LineRenderer::AddImplicitLine(std::function<float(float, float)>&& f, const glm::vec4& color)
 	{
-		m_Lines.push_back({ f, color });
-		m_Redraw = true;
-		m_RecordCommandBuffer[m_Renderer->GetCurrentFrameIndex()] = true;
+		ImplicitFunction function = [f = std::move(f)](const float* x, const float* y, float* result, size_t count)
+		{
+			for (size_t i = 0; i < count; i++)
+				result[i] = f(x[i], y[i]);
+		};
+
+		PushLine({ {}, {}, {}, color, LineSamplingMode::Adaptive, function, {} });
+	}
+
+	void LineRenderer::AddImplicitLine(const Expression& expression, const glm::vec4& color)
+	{
+		if (!expression.IsValid() || expression.GetVariables().size() != 2)
+		{
+			CV_ERROR("Failed to add implicit line '", expression.GetSource(), "': ", expression.IsValid() ? "expected two variables" : expression.GetError());
+			return;
+		}
+
+		ImplicitFunction function = [expression](const float* x, const float* y, float* result, size_t count)
+		{
+			const float* variables[] = { x, y };
+			expression.Evaluate(variables, result, count);
+		};
+
+		ImplicitIntervalFunction bounds = [expression](const Interval& x, const Interval& y)
+		{
+			Interval variables[] = { x, y };
+			return expression.Evaluate(variables);
+		};
+
+		PushLine({ {}, {}, expression, color, LineSamplingMode::Adaptive, function, bounds });
+	}
+
+	void LineRenderer::AddParametricLine(std::function<glm::vec2(float)>&& f, float minT, float maxT, const glm::vec4& color)
+	{
+		Line line{};
+		line.Curve = [f = std::move(f)](const float* t, float* x, float* y, size_t count)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				glm::vec2 point = f(t[i]);
+				x[i] = point.x;
+				y[i] = point.y;
+			}
+		};
+		line.MinT = minT;
+		line.MaxT = maxT;
+		line.Color = color;
+
+		PushLine(std::move(line));
+	}
+
+	void LineRenderer::AddParametricLine(const Expression& x, const Expression& y, float minT, float maxT, const glm::vec4& color)
+	{
+		for (const Expression* expression : { &x, &y })
+		{
+			if (!expression->IsValid() || expression->GetVariables().size() != 1)
+			{
+				CV_ERROR("Failed to add parametric line '", expression->GetSource(), "': ", expression->IsValid() ? "expected one variable" : expression->GetError());
+				return;
+			}
+		}
+
+		Line line{};
+		line.Curve = [x, y](const float* t, float* xs, float* ys, size_t count)
+		{
+			x.Evaluate(t, xs, count);
+			y.Evaluate(t, ys, count);
+		};
+		line.MinT = minT;
+		line.MaxT = maxT;
+		line.Color = color;
+
+		PushLine(std::move(line));
+	}
+
+	void LineRenderer::AddPolarLine(std::function<float(float)>&& r, float minTheta, float maxTheta, const glm::vec4& color)
+	{
+		AddParametricLine([r = std::move(r)](float theta)
+		{
+			return r(theta) * glm::vec2(std::cos(theta), std::sin(theta));
+		}, minTheta, maxTheta, color);
+	}
+
+	void LineRenderer::AddPolarLine(const Expression& r, float minTheta, float maxTheta, const glm::vec4& color)
+	{
+		if (!r.IsValid() || r.GetVariables().size() != 1)
+		{
+			CV_ERROR("Failed to add polar line '", r.GetSource(), "': ", r.IsValid() ? "expected one variable" : r.GetError());
+			return;
+		}
+
+		Line line{};
+		line.Curve = [r](const float* theta, float* x, float* y, size_t count)
+		{
+			// the radius goes through x first, it's only needed until the point is known
+			r.Evaluate(theta, x, count);
+			for (size_t i = 0; i < count; i++)
+			{
+				float radius = x[i];
+				x[i] = radius * std::cos(theta[i]);
+				y[i] = radius * std::sin(theta[i]);
+			}
+		};
+		line.MinT = minTheta;
+		line.MaxT = maxTheta;
+		line.Color = color;
+
+		PushLine(std::move(line));
+	}
+
+	void LineRenderer::AddSeries(std::vector<float>&& x, std::vector<float>&& y, const glm::vec4& color)
+	{
+		if (x.size() != y.size())
+		{
+			CV_ERROR("Failed to add series: ", x.size(), " x values but ", y.size(), " y values");
+			return;
+		}
+
+		// shared, the line function gets copied around
+		auto data = std::make_shared<std::pair<std::vector<float>, std::vector<float>>>(std::move(x), std::move(y));
+		AddSeries([data](const SeriesDecimatorSpecification& spec, std::vector<glm::vec2>& samples)
+		{
+			return SeriesDecimator::Decimate(data->first.data(), data->second.data(), data->first.size(), spec, samples);
+		}, color);
+	}
+
+	void LineRenderer::AddSeries(const std::filesystem::path& path, const glm::vec4& color)
+	{
+		auto file = std::make_shared<SeriesFile>(path);
+		if (!file->IsValid())
+		{
+			CV_ERROR("Failed to add series '", path.string(), "': ", file->GetError());
+			return;
+		}
+
+		// only built the first time a file is opened, a failure just leaves the series scanned
+		if (file->GetCount() >= s_SeriesPyramidThreshold)
+			file->OpenPyramid();
+
+		AddSeries([file](const SeriesDecimatorSpecification& spec, std::vector<glm::vec2>& samples)
+		{
+			return file->Decimate(spec, samples);
+		}, color);
+	}
+
+	void LineRenderer::AddSeries(SeriesFunction&& series, const glm::vec4& color)
+	{
+		Line line{};
+		line.Series = std::move(series);
+		line.Color = color;
+
+		PushLine(std::move(line));
+	}
+
+	int LineRenderer::AddStream(size_t capacity, const glm::vec4& color)
+	{
+		capacity = std::max<size_t>(capacity, 2);
+		if (m_StreamVertexCount + capacity + 1 > s_MaxStreamVertices)
+		{
+			CV_ERROR("Failed to add stream of ", capacity, " samples: only ", s_MaxStreamVertices - m_StreamVertexCount, " vertices left");
+			return -1;
+		}
+
+		Line line{};
+		line.StreamOffset = s_StreamVertexOffset + m_StreamVertexCount;
+		line.StreamCapacity = capacity;
+		line.Color = color;
+
+		int index = PushLine(std::move(line));
+		if (index >= 0)
+			m_StreamVertexCount += capacity + 1;
+
+		return index;
+	}
+
+	void LineRenderer::AppendSamples(int line, std::span<const glm::vec2> samples)
+	{
+		if (line < 0 || line >= m_Lines.size() || m_Lines[line].StreamCapacity == 0)
+		{
+			CV_ERROR("Failed to append samples: line ", line, " isn't a stream");
+			return;
+		}
+
+		std::vector<glm::vec2>& pending = m_Lines[line].PendingSamples;
+		for (const glm::vec2& sample : samples)
+		{
+			if (std::isfinite(sample.x) && std::isfinite(sample.y))
+				pending.push_back(sample);
+		}
+
+		m_StreamsDirty = true;
+	}
+
+	void LineRenderer::SetLineSamplingMode(int index, LineSamplingMode samplingMode)
+	{
+		m_Lines[index].SamplingMode = samplingMode;
+		m_LineComputeDirty = true;
+		MarkLineDirty(index);
+
+		if (m_Data.LineDataBuffer)
+			UploadLineComputeData();
+	}
+
+	void LineRenderer::SetPixelTolerance(float tolerance)
+	{
+		m_PixelTolerance = tolerance;
+		MoveCamera();
+	}
+
+	void LineRenderer::SetSampleCacheBudget(size_t bytes)
+	{
+		m_SampleCache.SetMemoryBudget(bytes);
 	}
 
 	void LineRenderer::MoveCamera()
 	{
-		for (size_t i = 0; i < m_RecordCommandBuffer.size(); i++)
-			m_RecordCommandBuffer[i] = true;
+		// every line but the streamed ones depends on the view
+		for (CPULine& cpuLine : m_CPULines)
+			cpuLine.Dirty = true;
 		m_Redraw = true;
+		m_OriginDirty = true;
 	}
 
 	bool LineRenderer::OnWindowResize(WindowResizeEvent& event)
 	{
-		for (size_t i = 0; i < m_RecordCommandBuffer.size(); i++)
-			m_RecordCommandBuffer[i] = true;
-		m_Redraw = true;
+		MoveCamera();
 
 		delete m_Data.LineIDBuffer;
 
@@ -1,38 +1,68 @@
 #pragma once
 
 #include "GraphCamera.h"
+#include "LineSampler.h"
+#include "LineSampleCache.h"
+#include "ImplicitSampler.h"
+#include "CurveSampler.h"
+#include "SeriesFile.h"
+#include "VertexAllocator.h"
 
 #include <Curve/Renderer/Renderer.h>
+#include <Curve/Expression/Expression.h>
 
 #include <glm/glm.hpp>
 
+#include <span>
 #include <vector>
+#include <future>
 #include <functional>
+#include <unordered_map>
 
 namespace cv {
 
 	struct LineVertex
 	{
-		glm::vec4 Position;
+		glm::vec2 Position;
+	};
+
+	// per line data the line shader reads, has to match Line in LineShader.shader
+	struct LineStyle
+	{
 		glm::vec4 Color;
-		int LineIndex;
+		int LineIndex; // written to the id attachment, 0 is the background
 		int Padding[3];
 	};
 
 	struct RendererData
 	{
 		Shader* LineShader = nullptr;
-		Shader* LineComputeShader = nullptr;
 		GraphicsPipeline* LinePipeline = nullptr;
+
+		// the generated compute shader currently in use, owned by the line compute cache
+		Shader* LineComputeShader = nullptr;
 		ComputePipeline* LineComputePipeline = nullptr;
+		size_t LineComputeHash = 0;
+		std::vector<int> LineComputeLines; // indices of the lines sampled by LineComputePipeline
 
 		Buffer<VertexBuffer | StorageBuffer>* LineVertexBuffer = nullptr;
 		Buffer<StorageBuffer>* LineDataBuffer = nullptr;
+		Buffer<IndirectBuffer | StorageBuffer>* LineComputeDrawBuffer = nullptr; // one DrawIndirectCommand per compute line, written by LineComputePipeline
+		Buffer<StorageBuffer>* LineStyleBuffer = nullptr; // one LineStyle per line
 
+		// the mapped staging memory of LineVertexBuffer from LineVertexBufferOffset on, only while the CPU lines are written
 		LineVertex* LineVertexBufferBase = nullptr;
-		LineVertex* LineVertexBufferPtr = nullptr;
+		size_t LineVertexBufferOffset = 0;
+
+		// one draw per strip of a CPU sampled line, lines broken at discontinuities take up several, the first instance is the line
+		std::vector<DrawIndirectCommand> LineDraws;
 
-		std::vector<size_t> LineVertexCounts;
+		// the same for streamed lines, which change with every append rather than with the view
+		std::vector<DrawIndirectCommand> StreamDraws;
+
+		// LineDraws followed by StreamDraws, each drawn with a single call
+		Buffer<IndirectBuffer>* LineDrawBuffer = nullptr;
+		size_t LineDrawCapacity = 0; // in draws
 
 		std::vector<CommandBuffer> CommandBuffers = {};
 
@@ -50,27 +80,186 @@ namespace cv {
 		Buffer<StagingBuffer>* Render(const GraphCamera& camera);
 		Buffer<StagingBuffer>* Render(const GraphCamera& camera, Framebuffer* framebuffer, const glm::vec2& relativeMousePosition);
 
-		void AddLine(std::function<float(float)>&& f, const glm::vec4& color);
+		// line functions are sampled on the job system, so they have to be safe to call from several threads at once
+		void AddLine(std::function<double(double)>&& f, const glm::vec4& color, LineSamplingMode samplingMode = LineSamplingMode::Adaptive);
+		void AddLine(const Expression& expression, const glm::vec4& color, LineSamplingMode samplingMode = LineSamplingMode::Adaptive);
+
+		// draws the curve f(x, y) = 0, expressions need exactly two variables which are taken as x and y in that order
+		void AddImplicitLine(std::function<float(float, float)>&& f, const glm::vec4& color);
+		void AddImplicitLine(const Expression& expression, const glm::vec4& color);
+
+		// draws (x(t), y(t)) for t in [minT, maxT], the expressions need exactly one variable
+		void AddParametricLine(std::function<glm::vec2(float)>&& f, float minT, float maxT, const glm::vec4& color);
+		void AddParametricLine(const Expression& x, const Expression& y, float minT, float maxT, const glm::vec4& color);
+
+		// draws r(theta) around the origin for theta in [minTheta, maxTheta], the expression needs exactly one variable
+		void AddPolarLine(std::function<float(float)>&& r, float minTheta, float maxTheta, const glm::vec4& color);
+		void AddPolarLine(const Expression& r, float minTheta, float maxTheta, const glm::vec4& color);
+
+		// draws a recorded series decimated to the pixel columns of the view, x has to be sorted ascending
+		void AddSeries(std::vector<float>&& x, std::vector<float>&& y, const glm::vec4& color);
+		void AddSeries(SeriesFunction&& series, const glm::vec4& color);
+
+		// maps a series file (see SeriesFileHeader), it's only paged in as far as the view needs it
+		void AddSeries(const std::filesystem::path& path, const glm::vec4& color);
+
+		// a line fed with AppendSamples, the last capacity samples are kept in a ring in the vertex buffer and drawn as they are
+		// returns the index of the line, or -1 if the vertex buffer has no room left for the ring
+		int AddStream(size_t capacity, const glm::vec4& color);
+
+		// only the new samples are uploaded on the next Render, so the cost doesn't depend on how many the line holds
+		// undefined samples are dropped, a streamed line is never broken
+		void AppendSamples(int line, std::span<const glm::vec2> samples);
+
+		void SetLineSamplingMode(int index, LineSamplingMode samplingMode);
+		void SetPixelTolerance(float tolerance);
+
+		// memory the sample tiles of all lines may take up before the least recently used ones are evicted
+		void SetSampleCacheBudget(size_t bytes);
 
 		void MoveCamera();
 
 		bool OnWindowResize(WindowResizeEvent& event);
 
 		const glm::vec4& GetLineColor(int index) const { return m_Lines[index > m_Lines.size() - 1 ? 0 : index].Color; }
+	private:
+		struct Line;
+
+		// -1 if there are already s_MaxLines
+		int PushLine(Line&& line);
+		void UploadLineStyles();
+
+		void SampleLines(const GraphCamera& camera, const glm::vec2& viewportSize);
+		void SampleCPULines(size_t firstDirtyLine, const LineSamplerSpecification& spec, const glm::dvec4& bounds, size_t lineBudget);
+		bool ReserveVertices(int index, size_t lineBudget);
+		void ReleaseVertices(int index);
+		void GrowVertices(size_t capacity);
+		void DefragmentVertices();
+		void MarkLineDirty(int index);
+		void UploadStreams();
+		void UploadDraws();
+
+		void UpdateLineCompute();
+		void UploadLineComputeData();
+
+		// false when the GPU lines aren't sampled this frame, there's nothing to draw for them then
+		bool DispatchLineCompute(CommandBuffer commandBuffer, const GraphCamera& camera);
+		ComputePipeline* CreateLineComputePipeline(Shader* shader);
 	private:
 		Renderer* m_Renderer = nullptr;
 		RendererData m_Data;
 
-		std::vector<bool> m_RecordCommandBuffer;
+		// set when any line is dirty, see CPULine
 		bool m_Redraw = true;
 
+		// set when LineDraws or StreamDraws changed
+		bool m_DrawsDirty = false;
+
+		// the vertices of sampled lines are stored relative to this, so they stay small floats however far the view is from (0, 0)
+		glm::dvec2 m_Origin = { 0.0, 0.0 };
+		bool m_OriginDirty = true;
+
+		// false once the view is zoomed in too far for the GPU lines' float samples, they're sampled on the CPU then
+		bool m_LineComputeInRange = true;
+
 		struct Line
 		{
-			std::function<float(float)> Function;
+			LineFunction Function;
+			LineContinuityFunction Continuity; // only for expression lines, the others are never broken at discontinuities
+			Expression Expr; // invalid for lines added from a std::function
 			glm::vec4 Color;
+			LineSamplingMode SamplingMode = LineSamplingMode::Adaptive;
+
+			// only set for implicit lines, which leave Function empty and ignore the sampling mode
+			ImplicitFunction Implicit;
+			ImplicitIntervalFunction ImplicitBounds;
+
+			// only set for parametric and polar lines, same as implicit lines
+			CurveFunction Curve;
+			float MinT = 0.0f, MaxT = 1.0f;
+
+			// only set for recorded series, same as implicit lines
+			SeriesFunction Series;
+
+			// only set for streamed lines, their ring takes StreamCapacity + 1 vertices at StreamOffset, the last one repeats
+			// the first so the older half of a wrapped ring runs into the newer one
+			size_t StreamOffset = 0, StreamCapacity = 0;
+			size_t StreamCount = 0; // samples appended so far, the next one goes to StreamCount % StreamCapacity
+			std::vector<glm::vec2> PendingSamples;
 		};
 
 		std::vector<Line> m_Lines;
+		size_t m_LineStyleCount = 0; // lines whose style is uploaded already
+
+		// the rings of streamed lines are handed out from the front of their region and never given back
+		size_t m_StreamVertexCount = 0;
+		bool m_StreamsDirty = false;
+
+		LineSampleCache m_SampleCache;
+
+		struct LineStrip
+		{
+			size_t VertexOffset, VertexCount;
+		};
+
+		struct CPULine
+		{
+			// only dirty lines are sampled and uploaded again, the others keep their vertices where they are
+			bool Dirty = true;
+
+			size_t FirstTile = 0, TileCount = 0; // into m_LineTiles, while the line is sampled
+
+			// the range the line owns in the vertex buffer, it's rewritten in place as long as the vertices fit
+			size_t VertexOffset = 0, VertexCapacity = 0, VertexCount = 0;
+
+			// the line is drawn as one strip per continuous piece
+			std::vector<LineStrip> Strips;
+
+			// only y = f(x) lines go through the tile cache, the other kinds depend on more than the x range and are sampled in here every redraw
+			// unlike the tiles they're sampled in float
+			std::vector<glm::vec2> Samples;
+		};
+
+		struct PendingTile
+		{
+			int LineIndex;
+			LineSampleTile* Tile;
+		};
+
+		// one per line, streamed lines and lines sampled on the GPU don't own any vertices in here
+		std::vector<CPULine> m_CPULines;
+
+		// the part of the vertex buffer after the GPU lines and the stream rings, see GrowVertices
+		VertexAllocator m_VertexAllocator;
+		bool m_Defragment = false; // set on an idle frame once the free room is split up too much, every line is laid out again
+
+		// kept around so they don't get reallocated every redraw
+		std::vector<int> m_DirtyLines;
+		std::vector<LineSampleTile*> m_LineTiles;
+		std::vector<PendingTile> m_PendingTiles;
+
+		float m_PixelTolerance = 0.5f;
+
+		struct LineComputeProgram
+		{
+			Shader* ComputeShader = nullptr;
+			ComputePipeline* Pipeline = nullptr;
+		};
+
+		struct PendingLineCompute
+		{
+			size_t Hash;
+			std::future<Shader*> Result;
+		};
+
+		// generated shaders keyed by the hash of their source, so toggling lines back and forth never recompiles
+		std::unordered_map<size_t, LineComputeProgram> m_LineComputeCache;
+		std::vector<PendingLineCompute> m_PendingLineComputes;
+
+		// the set of GPU lines the pipeline should sample, the previous pipeline stays in use until this one is compiled
+		size_t m_TargetLineComputeHash = 0;
+		std::vector<int> m_TargetLineComputeLines;
+		bool m_LineComputeDirty = false;
 	};
 
 }
@@ -0,0 +1,175 @@
+#include "LineSampleCache.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace cv {
+
+	namespace Utils {
+
+		// the pixels per unit are recomputed from the projection every frame, so a pan can move them by a few ulps
+		static bool NearlyEqual(float a, float b)
+		{
+			return std::abs(a - b) <= std::abs(a) * 1e-4f;
+		}
+
+	}
+
+	bool LineSampleCache::LineConfiguration::Matches(LineSamplingMode mode, const LineSamplerSpecification& spec, const glm::vec2& pixelsPerStep) const
+	{
+		if (!Valid || mode != Mode)
+			return false;
+
+		// uniform samples only depend on the step
+		if (mode == LineSamplingMode::Uniform)
+			return true;
+
+		return spec.PixelTolerance == PixelTolerance && spec.MaxDepth == MaxDepth
+			&& Utils::NearlyEqual(pixelsPerStep.x, PixelsPerStep.x) && Utils::NearlyEqual(pixelsPerStep.y, PixelsPerStep.y);
+	}
+
+	size_t LineSampleCache::TileKeyHash::operator()(const TileKey& key) const
+	{
+		size_t hash = std::hash<int64_t>()(key.Tile);
+		hash ^= std::hash<int>()(key.Level) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<int>()(key.Line) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		return hash;
+	}
+
+	LineSampleCache::LineSampleCache(size_t memoryBudget)
+		: m_MemoryBudget(memoryBudget)
+	{
+	}
+
+	void LineSampleCache::BeginFrame()
+	{
+		m_Frame++;
+	}
+
+	void LineSampleCache::EndFrame()
+	{
+		// tiles used this frame are at the front, the ones sampled this frame aren't counted yet
+		for (const TileKey& key : m_LRU)
+		{
+			LineSampleTile& tile = m_Tiles[key].Tile;
+			if (tile.LastUsedFrame != m_Frame)
+				break;
+
+			if (tile.Sampled && !tile.Size)
+			{
+				tile.Samples.shrink_to_fit();
+				tile.Size = sizeof(Entry) + tile.Samples.capacity() * sizeof(glm::dvec2);
+				m_MemoryUsage += tile.Size;
+			}
+		}
+
+		while (m_MemoryUsage > m_MemoryBudget && !m_LRU.empty())
+		{
+			auto it = m_Tiles.find(m_LRU.back());
+			if (it->second.Tile.LastUsedFrame == m_Frame)
+				break;
+
+			Erase(it);
+		}
+	}
+
+	void LineSampleCache::GetTiles(int line, LineSamplingMode mode, const LineSamplerSpecification& spec, std::vector<LineSampleTile*>& tiles)
+	{
+		if (spec.MaxX <= spec.MinX || spec.Step <= 0.0)
+			return;
+
+		if (line >= (int)m_Lines.size())
+			m_Lines.resize(line + 1);
+
+		glm::vec2 pixelsPerStep = spec.PixelsPerUnit * (float)spec.Step;
+
+		LineConfiguration& configuration = m_Lines[line];
+		if (!configuration.Matches(mode, spec, pixelsPerStep))
+		{
+			ClearLine(line);
+
+			configuration.Valid = true;
+			configuration.Mode = mode;
+			configuration.PixelTolerance = spec.PixelTolerance;
+			configuration.MaxDepth = spec.MaxDepth;
+			configuration.PixelsPerStep = pixelsPerStep;
+		}
+
+		int level = (int)std::floor(std::log2(spec.Step));
+		double step = std::ldexp(1.0, level);
+		double tileWidth = step * (double)TileSteps;
+
+		int64_t firstTile = (int64_t)std::floor(spec.MinX / tileWidth);
+		int64_t lastTile = (int64_t)std::floor(spec.MaxX / tileWidth);
+
+		for (int64_t t = firstTile; t <= lastTile; t++)
+		{
+			TileKey key = { line, level, t };
+
+			auto it = m_Tiles.find(key);
+			if (it == m_Tiles.end())
+			{
+				it = m_Tiles.emplace(key, Entry{}).first;
+				m_LRU.push_front(key);
+				it->second.LRUPosition = m_LRU.begin();
+
+				LineSampleTile& tile = it->second.Tile;
+				tile.Mode = mode;
+				tile.Spec = spec;
+				tile.Spec.Step = step;
+				tile.Spec.MinX = (double)t * tileWidth;
+				tile.SharesBoundary = mode != LineSamplingMode::Uniform;
+
+				if (mode == LineSamplingMode::Uniform)
+				{
+					// the last sample sits one step before the next tile
+					tile.Spec.MaxX = ((double)t * (double)TileSteps + (double)TileSteps - 0.5) * step;
+					tile.Spec.MaxSamples = (size_t)TileSteps;
+				}
+				else
+				{
+					// sampled as if zoomed in to the level, which is at most twice as strict as the camera asks for
+					tile.Spec.MaxX = (double)(t + 1) * tileWidth;
+					tile.Spec.PixelsPerUnit = configuration.PixelsPerStep / (float)step;
+					tile.Spec.InitialSegments = TileInitialSegments;
+					tile.Spec.MaxSamples = TileMaxSamples;
+				}
+			}
+			else
+				m_LRU.splice(m_LRU.begin(), m_LRU, it->second.LRUPosition);
+
+			it->second.Tile.LastUsedFrame = m_Frame;
+			tiles.push_back(&it->second.Tile);
+		}
+	}
+
+	void LineSampleCache::ClearLine(int line)
+	{
+		for (auto it = m_Tiles.begin(); it != m_Tiles.end();)
+		{
+			auto next = std::next(it);
+			if (it->first.Line == line)
+				Erase(it);
+			it = next;
+		}
+
+		if (line < (int)m_Lines.size())
+			m_Lines[line] = {};
+	}
+
+	void LineSampleCache::Clear()
+	{
+		m_Tiles.clear();
+		m_LRU.clear();
+		m_Lines.clear();
+		m_MemoryUsage = 0;
+	}
+
+	void LineSampleCache::Erase(std::unordered_map<TileKey, Entry, TileKeyHash>::iterator it)
+	{
+		m_MemoryUsage -= it->second.Tile.Size;
+		m_LRU.erase(it->second.LRUPosition);
+		m_Tiles.erase(it);
+	}
+
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "LineSampler.h"
+
+#include <glm/glm.hpp>
+
+#include <list>
+#include <vector>
+#include <unordered_map>
+
+namespace cv {
+
+	// a fixed piece of a line's x range, sampled once and then reused until it gets evicted
+	struct LineSampleTile
+	{
+		LineSamplingMode Mode = LineSamplingMode::Adaptive;
+		LineSamplerSpecification Spec;
+
+		std::vector<glm::dvec2> Samples;
+		bool Sampled = false;
+
+		// adaptive tiles include both of their end points, so a tile's first sample repeats the last one of the tile before
+		bool SharesBoundary = false;
+
+		size_t Size = 0; // bytes, counted once the tile is sampled
+		uint64_t LastUsedFrame = 0;
+	};
+
+	// sample tiles of all lines, like a mipmap per line keyed by (level, tile)
+	// level l samples at a step of 2^l, the finest power of two at or below the camera's step, so zooming back and forth
+	// and panning only ever sample tiles that weren't visible before; least recently used tiles are evicted above the budget
+	class LineSampleCache
+	{
+	public:
+		static constexpr int64_t TileSteps = 128;
+		static constexpr uint32_t TileInitialSegments = 8;
+		static constexpr size_t TileMaxSamples = 4096;
+
+		LineSampleCache(size_t memoryBudget = 64ull * 1024 * 1024);
+
+		void SetMemoryBudget(size_t bytes) { m_MemoryBudget = bytes; }
+		size_t GetMemoryBudget() const { return m_MemoryBudget; }
+		size_t GetMemoryUsage() const { return m_MemoryUsage; }
+
+		// tiles handed out during a frame are never evicted before EndFrame
+		void BeginFrame();
+		void EndFrame();
+
+		// appends the tiles covering [spec.MinX, spec.MaxX] to tiles, sorted by x
+		// tiles that aren't sampled yet have to be sampled (e.g. on the job system) before EndFrame
+		void GetTiles(int line, LineSamplingMode mode, const LineSamplerSpecification& spec, std::vector<LineSampleTile*>& tiles);
+
+		void ClearLine(int line);
+		void Clear();
+	private:
+		struct TileKey
+		{
+			int Line;
+			int Level;
+			int64_t Tile;
+
+			bool operator==(const TileKey& other) const { return Line == other.Line && Level == other.Level && Tile == other.Tile; }
+		};
+
+		struct TileKeyHash
+		{
+			size_t operator()(const TileKey& key) const;
+		};
+
+		struct Entry
+		{
+			LineSampleTile Tile;
+			std::list<TileKey>::iterator LRUPosition;
+		};
+
+		// everything apart from the zoom that changes the samples, tiles of a line are dropped when it changes
+		struct LineConfiguration
+		{
+			bool Valid = false;
+			LineSamplingMode Mode = LineSamplingMode::Adaptive;
+			float PixelTolerance = 0.0f;
+			uint32_t MaxDepth = 0;
+			glm::vec2 PixelsPerStep = { 0.0f, 0.0f }; // constant while zooming, changes with the viewport
+
+			bool Matches(LineSamplingMode mode, const LineSamplerSpecification& spec, const glm::vec2& pixelsPerStep) const;
+		};
+
+		void Erase(std::unordered_map<TileKey, Entry, TileKeyHash>::iterator it);
+	private:
+		std::unordered_map<TileKey, Entry, TileKeyHash> m_Tiles;
+		std::list<TileKey> m_LRU; // most recently used first
+		std::vector<LineConfiguration> m_Lines;
+
+		size_t m_MemoryBudget;
+		size_t m_MemoryUsage = 0;
+		uint64_t m_Frame = 0;
+	};
+
+}
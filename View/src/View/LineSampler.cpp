@@ -0,0 +1,145 @@
+#include "LineSampler.h"
+#include "SegmentRefinement.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace cv {
+
+	namespace Utils {
+
+		// sits between the two sides of a discontinuity, the renderer starts a new strip after it
+		static glm::dvec2 Break(double startX, double endX)
+		{
+			return { (startX + endX) * 0.5, std::numeric_limits<double>::quiet_NaN() };
+		}
+
+	}
+
+	size_t LineSampler::Sample(const LineFunction& function, const LineContinuityFunction& continuity, LineSamplingMode mode, const LineSamplerSpecification& spec, std::vector<glm::dvec2>& samples)
+	{
+		switch (mode)
+		{
+			case LineSamplingMode::Uniform:  return SampleUniform(function, continuity, spec, samples);
+			case LineSamplingMode::Adaptive: return SampleAdaptive(function, continuity, spec, samples);
+
+			// only reached while the line has no compute shader (yet)
+			case LineSamplingMode::GPU:      return SampleAdaptive(function, continuity, spec, samples);
+		}
+
+		return 0;
+	}
+
+	size_t LineSampler::SampleUniform(const LineFunction& function, const LineContinuityFunction& continuity, const LineSamplerSpecification& spec, std::vector<glm::dvec2>& samples)
+	{
+		if (spec.MaxX <= spec.MinX || spec.Step <= 0.0)
+			return 0;
+
+		size_t count = (size_t)((spec.MaxX - spec.MinX) / spec.Step) + 1;
+		count = std::min(count, spec.MaxSamples);
+
+		thread_local std::vector<double> xs, ys;
+		xs.resize(count);
+		ys.resize(count);
+
+		for (size_t i = 0; i < count; i++)
+			xs[i] = spec.MinX + (double)i * spec.Step;
+
+		function(xs.data(), ys.data(), count);
+
+		size_t first = samples.size();
+		samples.reserve(samples.size() + count);
+		for (size_t i = 0; i < count; i++)
+		{
+			if (continuity && i > 0 && std::isfinite(ys[i - 1]) && std::isfinite(ys[i]) && !continuity(xs[i - 1], xs[i]))
+				samples.push_back(Utils::Break(xs[i - 1], xs[i]));
+
+			samples.push_back({ xs[i], ys[i] });
+		}
+
+		return samples.size() - first;
+	}
+
+	size_t LineSampler::SampleAdaptive(const LineFunction& function, const LineContinuityFunction& continuity, const LineSamplerSpecification& spec, std::vector<glm::dvec2>& samples)
+	{
+		if (spec.MaxX <= spec.MinX || spec.MaxSamples < 2)
+			return 0;
+
+		uint32_t segments = (uint32_t)std::min<size_t>(std::max(spec.InitialSegments, 1u), spec.MaxSamples - 1);
+		double segmentWidth = (spec.MaxX - spec.MinX) / (double)segments;
+
+		// points[i] and points[i + 1] form a segment, open segments still have to be tested against their midpoint
+		thread_local std::vector<glm::dvec2> points;
+		thread_local std::vector<SegmentState> states;
+		thread_local std::vector<double> xs, ys;
+
+		xs.resize(segments + 1);
+		ys.resize(segments + 1);
+		for (uint32_t i = 0; i <= segments; i++)
+			xs[i] = i == segments ? spec.MaxX : spec.MinX + (double)i * segmentWidth;
+
+		function(xs.data(), ys.data(), xs.size());
+
+		points.clear();
+		for (size_t i = 0; i < xs.size(); i++)
+			points.push_back({ xs[i], ys[i] });
+		states.assign(segments, SegmentState::Open);
+
+		// undefined samples break the line on their own already
+		auto isJump = [&](const glm::dvec2& start, const glm::dvec2& end)
+		{
+			return continuity && IsFinitePoint(start) && IsFinitePoint(end) && !continuity(start.x, end.x);
+		};
+
+		auto getMidpoint = [](const glm::dvec2& start, const glm::dvec2& end)
+		{
+			return glm::dvec2((start.x + end.x) * 0.5, 0.0);
+		};
+
+		auto evaluate = [&](std::vector<glm::dvec2>& midpoints)
+		{
+			xs.resize(midpoints.size());
+			ys.resize(midpoints.size());
+			for (size_t i = 0; i < midpoints.size(); i++)
+				xs[i] = midpoints[i].x;
+
+			function(xs.data(), ys.data(), xs.size());
+
+			for (size_t i = 0; i < midpoints.size(); i++)
+				midpoints[i].y = ys[i];
+		};
+
+		auto test = [&](const glm::dvec2& start, const glm::dvec2& middle, const glm::dvec2& end, size_t pointCount)
+		{
+			bool narrow = (end.x - start.x) * spec.PixelsPerUnit.x <= spec.PixelTolerance;
+			bool full = pointCount >= spec.MaxSamples;
+			bool flat = full || IsFlatSegment(start, middle, end, spec.PixelsPerUnit, spec.PixelTolerance);
+
+			// segments that aren't split for their curvature are tested once, a jump in there is narrowed down to the tolerance
+			bool jump = (flat || narrow) && isJump(start, end);
+			bool split = !full && (jump ? !narrow : !flat);
+
+			if (split)
+				return SegmentState::Open;
+			return jump ? SegmentState::Broken : SegmentState::Closed;
+		};
+
+		RefineSegments(points, states, spec.MaxDepth, getMidpoint, evaluate, test);
+
+		size_t first = samples.size();
+		for (size_t i = 0; i < states.size(); i++)
+		{
+			samples.push_back(points[i]);
+
+			// segments still open at the maximum depth weren't tested yet
+			bool broken = states[i] == SegmentState::Broken || (states[i] == SegmentState::Open && isJump(points[i], points[i + 1]));
+			if (broken)
+				samples.push_back(Utils::Break(points[i].x, points[i + 1].x));
+		}
+		samples.push_back(points.back());
+
+		return samples.size() - first;
+	}
+
+}
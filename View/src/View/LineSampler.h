@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <functional>
+
+namespace cv {
+
+	enum class LineSamplingMode
+	{
+		Uniform = 0,
+		Adaptive,
+		GPU // sampled by the generated line compute shader, expression lines only
+	};
+
+	// evaluates y for a whole batch of x values at once, in double so the samples stay apart however far the camera zooms in
+	using LineFunction = std::function<void(const double* x, double* y, size_t count)>;
+
+	// true when the line is proven continuous over [minX, maxX], false when it might jump or have a pole in there
+	using LineContinuityFunction = std::function<bool(double minX, double maxX)>;
+
+	struct LineSamplerSpecification
+	{
+		double MinX = -1.0, MaxX = 1.0;
+		glm::vec2 PixelsPerUnit = { 1.0f, 1.0f };
+		size_t MaxSamples = 100'000;
+
+		// uniform only
+		double Step = 0.01;
+
+		// adaptive only, segments are split until the midpoint is within PixelTolerance of the chord on screen
+		float PixelTolerance = 0.5f;
+		uint32_t InitialSegments = 64;
+		uint32_t MaxDepth = 14;
+	};
+
+	class LineSampler
+	{
+	public:
+		// appends the samples to the back of samples, returns the amount of samples added
+		// with a continuity function the line is broken at discontinuities by a sample with a NaN y in between, instead of
+		// connecting both sides, adaptive sampling narrows them down to within the pixel tolerance first
+		static size_t Sample(const LineFunction& function, const LineContinuityFunction& continuity, LineSamplingMode mode, const LineSamplerSpecification& spec, std::vector<glm::dvec2>& samples);
+
+		static size_t SampleUniform(const LineFunction& function, const LineContinuityFunction& continuity, const LineSamplerSpecification& spec, std::vector<glm::dvec2>& samples);
+		static size_t SampleAdaptive(const LineFunction& function, const LineContinuityFunction& continuity, const LineSamplerSpecification& spec, std::vector<glm::dvec2>& samples);
+	};
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <vector>
+#include <cstdint>
+
+namespace cv {
+
+	enum class SegmentState : uint8_t
+	{
+		Closed = 0, Open, Broken
+	};
+
+	template<typename T>
+	inline bool IsFinitePoint(const glm::vec<2, T>& point)
+	{
+		return std::isfinite(point.x) && std::isfinite(point.y);
+	}
+
+	// true when the midpoint is within tolerance pixels of the chord on screen
+	template<typename T>
+	inline bool IsFlatSegment(const glm::vec<2, T>& start, const glm::vec<2, T>& middle, const glm::vec<2, T>& end, const glm::vec2& pixelsPerUnit, float tolerance)
+	{
+		bool startFinite = IsFinitePoint(start), middleFinite = IsFinitePoint(middle), endFinite = IsFinitePoint(end);
+
+		// nothing to draw in an undefined region, keep splitting only around its edges
+		if (!startFinite && !middleFinite && !endFinite)
+			return true;
+		if (!startFinite || !middleFinite || !endFinite)
+			return false;
+
+		// relative to the start, far from the origin the points themselves are too big to scale to pixels on their own
+		glm::vec<2, T> m = (middle - start) * glm::vec<2, T>(pixelsPerUnit);
+		glm::vec<2, T> chord = (end - start) * glm::vec<2, T>(pixelsPerUnit);
+
+		// a closed loop comes back to where it started, the chord says nothing about it then
+		T length = glm::length(chord);
+		if (length < (T)1e-6)
+			return glm::length(m) <= tolerance;
+
+		T distance = std::abs(chord.x * m.y - chord.y * m.x) / length;
+		return distance <= tolerance;
+	}
+
+	// points[i] and points[i + 1] form segment i, every open segment is tested against its midpoint until none is left open
+	// or maxDepth levels are done, getMidpoint(start, end) places a midpoint, evaluate(midpoints) fills in a whole batch of
+	// them and test(start, middle, end, pointCount) returns Open to split the segment in two open ones or the state it ends in
+	template<typename Point, typename MidpointFunction, typename EvaluateFunction, typename TestFunction>
+	void RefineSegments(std::vector<Point>& points, std::vector<SegmentState>& states, uint32_t maxDepth, const MidpointFunction& getMidpoint, const EvaluateFunction& evaluate, const TestFunction& test)
+	{
+		thread_local std::vector<Point> midpoints, nextPoints;
+		thread_local std::vector<SegmentState> nextStates;
+
+		// refine a whole level at a time, so every level is evaluated as one batch
+		for (uint32_t depth = 0; depth < maxDepth; depth++)
+		{
+			midpoints.clear();
+			for (size_t i = 0; i < states.size(); i++)
+			{
+				if (states[i] == SegmentState::Open)
+					midpoints.push_back(getMidpoint(points[i], points[i + 1]));
+			}
+
+			if (midpoints.empty())
+				break;
+
+			evaluate(midpoints);
+
+			nextPoints.clear();
+			nextStates.clear();
+
+			size_t midpoint = 0;
+			size_t pointCount = points.size();
+			for (size_t i = 0; i < states.size(); i++)
+			{
+				nextPoints.push_back(points[i]);
+
+				if (states[i] != SegmentState::Open)
+				{
+					nextStates.push_back(states[i]);
+					continue;
+				}
+
+				const Point& middle = midpoints[midpoint++];
+				SegmentState state = test(points[i], middle, points[i + 1], pointCount);
+
+				if (state == SegmentState::Open)
+				{
+					nextPoints.push_back(middle);
+					nextStates.push_back(SegmentState::Open);
+					nextStates.push_back(SegmentState::Open);
+					pointCount++;
+				}
+				else
+					nextStates.push_back(state);
+			}
+			nextPoints.push_back(points.back());
+
+			std::swap(points, nextPoints);
+			std::swap(states, nextStates);
+		}
+	}
+
+}
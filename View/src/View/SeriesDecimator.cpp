@@ -0,0 +1,263 @@
+#include "SeriesDecimator.h"
+#include "SeriesPyramid.h"
+
+#include <Curve/Core/JobSystem.h>
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace cv {
+
+	namespace Utils {
+
+		// indices of the points a pixel column keeps, a gap stands for a run of undefined points
+		struct SeriesColumn
+		{
+			int64_t Column;
+			size_t First, Last, Min, Max;
+			bool Gap;
+		};
+
+		template<typename T>
+		static void AggregateColumns(const T* x, const T* y, size_t begin, size_t end, const SeriesDecimatorSpecification& spec, int64_t columnCount, std::vector<SeriesColumn>& columns)
+		{
+			double minX = spec.MinX, pixelsPerUnit = spec.PixelsPerUnit;
+
+			// x is sorted, so the column only has to be worked out again once a point passes the end of the current one
+			SeriesColumn current{};
+			double columnEnd = -std::numeric_limits<double>::infinity();
+			T minY = 0, maxY = 0;
+			bool open = false;
+
+			for (size_t i = begin; i < end; i++)
+			{
+				T value = y[i];
+				if (!std::isfinite((double)value))
+				{
+					if (open)
+						columns.push_back(current);
+					if (!columns.empty() && columns.back().Gap)
+						columns.back().Last = i;
+					else
+						columns.push_back({ 0, i, i, i, i, true });
+
+					open = false;
+					continue;
+				}
+
+				if (open && (double)x[i] < columnEnd)
+				{
+					current.Last = i;
+					if (value < minY)
+					{
+						minY = value;
+						current.Min = i;
+					}
+					if (value > maxY)
+					{
+						maxY = value;
+						current.Max = i;
+					}
+					continue;
+				}
+
+				// the points outside of the view share a column on either side, only one of them is in range anyway
+				int64_t column = (int64_t)std::clamp(std::floor(((double)x[i] - minX) * pixelsPerUnit), -1.0, (double)columnCount);
+				if (open)
+					columns.push_back(current);
+
+				current = { column, i, i, i, i, false };
+				columnEnd = column >= columnCount ? std::numeric_limits<double>::infinity() : minX + (double)(column + 1) / pixelsPerUnit;
+				minY = maxY = value;
+				open = true;
+			}
+
+			if (open)
+				columns.push_back(current);
+		}
+
+		template<typename T>
+		static void MergeColumn(const T* y, SeriesColumn& column, const SeriesColumn& next)
+		{
+			column.Last = next.Last;
+			if (y[next.Min] < y[column.Min])
+				column.Min = next.Min;
+			if (y[next.Max] > y[column.Max])
+				column.Max = next.Max;
+		}
+
+		// runs of undefined points next to each other become one gap, a column split by a chunk border is put back together
+		template<typename T>
+		static void AppendColumn(const T* y, std::vector<SeriesColumn>& columns, const SeriesColumn& column)
+		{
+			if (!columns.empty() && columns.back().Gap == column.Gap && (column.Gap || columns.back().Column == column.Column))
+			{
+				if (!column.Gap)
+					MergeColumn(y, columns.back(), column);
+				return;
+			}
+
+			columns.push_back(column);
+		}
+
+		template<typename T>
+		static void EmitColumns(const T* x, const T* y, const std::vector<SeriesColumn>& columns, size_t maxSamples, std::vector<glm::vec2>& samples)
+		{
+			size_t first = samples.size();
+			for (const SeriesColumn& column : columns)
+			{
+				if (column.Gap)
+				{
+					if (samples.size() - first + 1 > maxSamples)
+						break;
+
+					samples.push_back({ (float)x[column.First], std::numeric_limits<float>::quiet_NaN() });
+					continue;
+				}
+
+				// the four points in the order they were recorded, without the ones that are the same point
+				size_t indices[4] = { column.First, std::min(column.Min, column.Max), std::max(column.Min, column.Max), column.Last };
+				size_t* indicesEnd = std::unique(indices, indices + 4);
+
+				if (samples.size() - first + (size_t)(indicesEnd - indices) > maxSamples)
+					break;
+
+				for (const size_t* index = indices; index != indicesEnd; index++)
+					samples.push_back({ (float)x[*index], (float)y[*index] });
+			}
+		}
+
+	}
+
+	template<typename T>
+	size_t SeriesDecimator::Decimate(const T* x, const T* y, size_t count, const SeriesDecimatorSpecification& spec, std::vector<glm::vec2>& samples)
+	{
+		if (count == 0 || spec.MaxX <= spec.MinX || spec.PixelsPerUnit <= 0.0f || spec.MaxSamples == 0)
+			return 0;
+
+		size_t begin = (size_t)(std::lower_bound(x, x + count, (T)spec.MinX) - x);
+		size_t end = (size_t)(std::upper_bound(x, x + count, (T)spec.MaxX) - x);
+		begin = begin > 0 ? begin - 1 : 0;
+		end = std::min(end + 1, count);
+
+		int64_t columnCount = (int64_t)std::ceil(((double)spec.MaxX - spec.MinX) * spec.PixelsPerUnit);
+
+		// every chunk aggregates the columns it touches, only the columns at the chunk borders can be split between two of them
+		size_t chunkSize = std::max<size_t>(spec.ChunkSize, 1);
+		size_t chunkCount = (end - begin + chunkSize - 1) / chunkSize;
+
+		std::vector<std::vector<Utils::SeriesColumn>> chunks(chunkCount);
+		JobSystem::ParallelFor(chunkCount, 1, [&](size_t first, size_t last)
+		{
+			for (size_t chunk = first; chunk < last; chunk++)
+			{
+				size_t chunkBegin = begin + chunk * chunkSize;
+				Utils::AggregateColumns(x, y, chunkBegin, std::min(chunkBegin + chunkSize, end), spec, columnCount, chunks[chunk]);
+			}
+		});
+
+		std::vector<Utils::SeriesColumn> columns;
+		for (const auto& chunk : chunks)
+		{
+			for (const Utils::SeriesColumn& column : chunk)
+				Utils::AppendColumn(y, columns, column);
+		}
+
+		size_t first = samples.size();
+		Utils::EmitColumns(x, y, columns, spec.MaxSamples, samples);
+		return samples.size() - first;
+	}
+
+	template<typename T>
+	size_t SeriesDecimator::Decimate(const T* x, const T* y, size_t count, const SeriesPyramid& pyramid, const SeriesDecimatorSpecification& spec, std::vector<glm::vec2>& samples)
+	{
+		if (count == 0 || spec.MaxX <= spec.MinX || spec.PixelsPerUnit <= 0.0f || spec.MaxSamples == 0)
+			return 0;
+
+		size_t columnCount = (size_t)std::ceil(((double)spec.MaxX - spec.MinX) * spec.PixelsPerUnit);
+		size_t begin = (size_t)(std::lower_bound(x, x + count, (T)spec.MinX) - x);
+		size_t end = (size_t)(std::upper_bound(x, x + count, (T)spec.MaxX) - x);
+
+		// zoomed in far enough the points themselves are cheaper than searching for every column
+		if (end - begin <= columnCount * ((size_t)2 << SeriesPyramid::BaseLevel))
+			return Decimate(x, y, count, spec, samples);
+
+		// boundaries[c] is the first point of column c, the last one is the first point right of the view
+		std::vector<size_t> boundaries(columnCount + 1);
+		std::vector<std::vector<Utils::SeriesColumn>> columnParts(columnCount);
+
+		static constexpr size_t s_ColumnGrainSize = 64;
+		JobSystem::ParallelFor(columnCount + 1, s_ColumnGrainSize, [&](size_t first, size_t last)
+		{
+			for (size_t c = first; c < last; c++)
+			{
+				// the same column formula as the scan, so both agree on which column a point right at a boundary falls in, the
+				// points past MaxX are left out like the scan does, only the first one of them is kept below
+				boundaries[c] = (size_t)(std::lower_bound(x + begin, x + end, (double)c, [&](T value, double column)
+				{
+					return std::floor(((double)value - (double)spec.MinX) * (double)spec.PixelsPerUnit) < column;
+				}) - x);
+			}
+		});
+
+		JobSystem::ParallelFor(columnCount, s_ColumnGrainSize, [&](size_t first, size_t last)
+		{
+			for (size_t c = first; c < last; c++)
+			{
+				std::vector<Utils::SeriesColumn>& parts = columnParts[c];
+				parts.clear();
+
+				size_t columnBegin = boundaries[c], columnEnd = boundaries[c + 1];
+				if (columnBegin >= columnEnd)
+					continue;
+
+				size_t minIndex, maxIndex;
+				bool hasUndefined;
+				pyramid.FindMinMax(y, columnBegin, columnEnd, minIndex, maxIndex, hasUndefined);
+
+				// the line breaks inside of the column, it's scanned so the gaps end up exactly where the scan puts them
+				if (hasUndefined)
+				{
+					Utils::AggregateColumns(x, y, columnBegin, columnEnd, spec, (int64_t)columnCount, parts);
+					continue;
+				}
+
+				parts.push_back({ (int64_t)c, columnBegin, columnEnd - 1, minIndex, maxIndex, false });
+			}
+		});
+
+		std::vector<Utils::SeriesColumn> columns;
+		columns.reserve(columnCount + 2);
+
+		// the points right outside of the view, so the line runs off screen
+		std::vector<Utils::SeriesColumn> outside;
+		if (boundaries[0] > 0)
+			Utils::AggregateColumns(x, y, boundaries[0] - 1, boundaries[0], spec, (int64_t)columnCount, outside);
+		for (const Utils::SeriesColumn& column : outside)
+			Utils::AppendColumn(y, columns, column);
+
+		for (const auto& parts : columnParts)
+		{
+			for (const Utils::SeriesColumn& column : parts)
+				Utils::AppendColumn(y, columns, column);
+		}
+
+		outside.clear();
+		if (boundaries[columnCount] < count)
+			Utils::AggregateColumns(x, y, boundaries[columnCount], boundaries[columnCount] + 1, spec, (int64_t)columnCount, outside);
+		for (const Utils::SeriesColumn& column : outside)
+			Utils::AppendColumn(y, columns, column);
+
+		size_t first = samples.size();
+		Utils::EmitColumns(x, y, columns, spec.MaxSamples, samples);
+		return samples.size() - first;
+	}
+
+	template size_t SeriesDecimator::Decimate<float>(const float*, const float*, size_t, const SeriesDecimatorSpecification&, std::vector<glm::vec2>&);
+	template size_t SeriesDecimator::Decimate<double>(const double*, const double*, size_t, const SeriesDecimatorSpecification&, std::vector<glm::vec2>&);
+	template size_t SeriesDecimator::Decimate<float>(const float*, const float*, size_t, const SeriesPyramid&, const SeriesDecimatorSpecification&, std::vector<glm::vec2>&);
+	template size_t SeriesDecimator::Decimate<double>(const double*, const double*, size_t, const SeriesPyramid&, const SeriesDecimatorSpecification&, std::vector<glm::vec2>&);
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <functional>
+
+namespace cv {
+
+	class SeriesPyramid;
+
+	struct SeriesDecimatorSpecification
+	{
+		// the visible x range, pixel columns are 1 / PixelsPerUnit wide starting at MinX
+		float MinX = -1.0f, MaxX = 1.0f;
+		float PixelsPerUnit = 1.0f;
+		size_t MaxSamples = 100'000;
+
+		// points per job
+		size_t ChunkSize = 1 << 16;
+	};
+
+	// decimates a recorded series for the given view, see SeriesDecimator
+	using SeriesFunction = std::function<size_t(const SeriesDecimatorSpecification& spec, std::vector<glm::vec2>& samples)>;
+
+	class SeriesDecimator
+	{
+	public:
+		// M4 decimation: keeps the first, lowest, highest and last point of every pixel column, which a line strip rasterizes to
+		// the same pixels as the whole series, so the output stays at a few thousand samples no matter how many points are visible
+		// x has to be sorted ascending, the points right outside of the visible range are kept so the line runs off screen
+		// points with an undefined y break the line, appends the samples to the back of samples and returns the amount added
+		template<typename T>
+		static size_t Decimate(const T* x, const T* y, size_t count, const SeriesDecimatorSpecification& spec, std::vector<glm::vec2>& samples);
+
+		// the same with the lowest and highest point of every column taken from a min/max pyramid over y, so only the column
+		// boundaries are searched for and a column costs O(levels) no matter how many points it holds, the output is the same as the
+		// scan's: a column holding undefined points is scanned, so the line breaks at the same gaps
+		template<typename T>
+		static size_t Decimate(const T* x, const T* y, size_t count, const SeriesPyramid& pyramid, const SeriesDecimatorSpecification& spec, std::vector<glm::vec2>& samples);
+	};
+
+}
@@ -0,0 +1,147 @@
+#include "SeriesFile.h"
+
+#include <Curve/Core/Base.h>
+
+#include <bit>
+#include <cstring>
+#include <fstream>
+
+namespace cv {
+
+	static_assert(std::endian::native == std::endian::little, "Series files are read in place, which needs a little endian host!");
+	static_assert(sizeof(SeriesFileHeader) == 32, "The series columns have to stay aligned for doubles!");
+
+	namespace Utils {
+
+		static size_t SeriesValueSize(SeriesValueType type)
+		{
+			switch (type)
+			{
+				case SeriesValueType::Float32: return sizeof(float);
+				case SeriesValueType::Float64: return sizeof(double);
+			}
+
+			return 0;
+		}
+
+		template<typename T>
+		static bool WriteSeries(const std::filesystem::path& path, SeriesValueType type, const T* x, const T* y, size_t count)
+		{
+			std::ofstream stream(path, std::ios::binary);
+			if (!stream)
+				return false;
+
+			SeriesFileHeader header{};
+			header.ValueType = type;
+			header.Count = count;
+
+			stream.write((const char*)&header, sizeof(header));
+			stream.write((const char*)x, (std::streamsize)(count * sizeof(T)));
+			stream.write((const char*)y, (std::streamsize)(count * sizeof(T)));
+			return (bool)stream;
+		}
+
+	}
+
+	SeriesFile::SeriesFile(const std::filesystem::path& path)
+		: m_Path(path), m_File(path)
+	{
+		if (!m_File.IsOpen())
+		{
+			m_Error = "failed to open the file";
+			return;
+		}
+
+		SeriesFileHeader header{};
+		if (m_File.GetSize() < sizeof(header))
+		{
+			m_Error = "the file is too small for the header";
+			return;
+		}
+
+		std::memcpy(&header, m_File.GetData(), sizeof(header));
+		if (std::memcmp(header.Magic, SeriesFileHeader().Magic, sizeof(header.Magic)) != 0 || header.Version != 1)
+		{
+			m_Error = "not a series file (or an unknown version)";
+			return;
+		}
+
+		size_t valueSize = Utils::SeriesValueSize(header.ValueType);
+		if (valueSize == 0)
+		{
+			m_Error = "unknown value type";
+			return;
+		}
+
+		if (header.Count > (m_File.GetSize() - sizeof(header)) / (2 * valueSize))
+		{
+			m_Error = "the file is shorter than its header says";
+			return;
+		}
+
+		m_Count = (size_t)header.Count;
+		m_ValueType = header.ValueType;
+		m_X = m_File.GetData() + sizeof(header);
+		m_Y = m_File.GetData() + sizeof(header) + m_Count * valueSize;
+	}
+
+	bool SeriesFile::OpenPyramid()
+	{
+		if (!IsValid())
+			return false;
+
+		std::filesystem::path path = m_Path;
+		path += ".lod";
+
+		auto pyramid = std::make_unique<SeriesPyramid>(path, *this);
+		if (!pyramid->IsValid())
+		{
+			// the stale file is replaced by the new one, it can't stay mapped while that happens
+			pyramid.reset();
+
+			if (!SeriesPyramid::Build(*this, path))
+			{
+				CV_ERROR("Failed to build the pyramid '", path.string(), "'");
+				return false;
+			}
+
+			pyramid = std::make_unique<SeriesPyramid>(path, *this);
+			if (!pyramid->IsValid())
+			{
+				CV_ERROR("Failed to open the pyramid '", path.string(), "': ", pyramid->GetError());
+				return false;
+			}
+		}
+
+		m_Pyramid = std::move(pyramid);
+		return true;
+	}
+
+	size_t SeriesFile::Decimate(const SeriesDecimatorSpecification& spec, std::vector<glm::vec2>& samples) const
+	{
+		if (!IsValid())
+			return 0;
+
+		if (m_ValueType == SeriesValueType::Float64)
+		{
+			if (m_Pyramid)
+				return SeriesDecimator::Decimate((const double*)m_X, (const double*)m_Y, m_Count, *m_Pyramid, spec, samples);
+			return SeriesDecimator::Decimate((const double*)m_X, (const double*)m_Y, m_Count, spec, samples);
+		}
+
+		if (m_Pyramid)
+			return SeriesDecimator::Decimate((const float*)m_X, (const float*)m_Y, m_Count, *m_Pyramid, spec, samples);
+		return SeriesDecimator::Decimate((const float*)m_X, (const float*)m_Y, m_Count, spec, samples);
+	}
+
+	bool SeriesFile::Write(const std::filesystem::path& path, const float* x, const float* y, size_t count)
+	{
+		return Utils::WriteSeries(path, SeriesValueType::Float32, x, y, count);
+	}
+
+	bool SeriesFile::Write(const std::filesystem::path& path, const double* x, const double* y, size_t count)
+	{
+		return Utils::WriteSeries(path, SeriesValueType::Float64, x, y, count);
+	}
+
+}
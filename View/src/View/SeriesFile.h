@@ -0,0 +1,72 @@
+#pragma once
+
+#include "SeriesDecimator.h"
+#include "SeriesPyramid.h"
+
+#include <Curve/Core/MappedFile.h>
+
+#include <memory>
+#include <string>
+#include <filesystem>
+
+namespace cv {
+
+	enum class SeriesValueType : uint32_t
+	{
+		Float32 = 0,
+		Float64
+	};
+
+	// little endian, followed by Count x values and then Count y values of ValueType, x sorted ascending
+	struct SeriesFileHeader
+	{
+		char Magic[4] = { 'C', 'V', 'S', 'R' };
+		uint32_t Version = 1;
+		SeriesValueType ValueType = SeriesValueType::Float32;
+		uint32_t Padding = 0;
+		uint64_t Count = 0;
+		uint64_t Reserved = 0;
+	};
+
+	// a series file that is mapped instead of read, so opening is instant no matter the size and the decimation only pages in
+	// the visible range (and the few pages the binary search for it touches)
+	class SeriesFile
+	{
+	public:
+		SeriesFile(const std::filesystem::path& path);
+
+		bool IsValid() const { return m_X != nullptr; }
+		const std::string& GetError() const { return m_Error; }
+
+		const std::filesystem::path& GetPath() const { return m_Path; }
+		size_t GetFileSize() const { return m_File.GetSize(); }
+
+		size_t GetCount() const { return m_Count; }
+		SeriesValueType GetValueType() const { return m_ValueType; }
+
+		const void* GetXData() const { return m_X; }
+		const void* GetYData() const { return m_Y; }
+
+		// maps the min/max pyramid in the sidecar file next to the series, building it first if it's missing or out of date
+		// decimation reads the pyramid from then on, which only touches a few blocks per pixel column instead of every visible point
+		bool OpenPyramid();
+		bool HasPyramid() const { return m_Pyramid != nullptr; }
+
+		size_t Decimate(const SeriesDecimatorSpecification& spec, std::vector<glm::vec2>& samples) const;
+
+		static bool Write(const std::filesystem::path& path, const float* x, const float* y, size_t count);
+		static bool Write(const std::filesystem::path& path, const double* x, const double* y, size_t count);
+	private:
+		std::filesystem::path m_Path;
+		MappedFile m_File;
+		std::string m_Error;
+
+		std::unique_ptr<SeriesPyramid> m_Pyramid;
+
+		const void* m_X = nullptr;
+		const void* m_Y = nullptr;
+		size_t m_Count = 0;
+		SeriesValueType m_ValueType = SeriesValueType::Float32;
+	};
+
+}
@@ -0,0 +1,314 @@
+#include "SeriesPyramid.h"
+#include "SeriesFile.h"
+
+#include <Curve/Core/JobSystem.h>
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace cv {
+
+	static_assert(sizeof(SeriesPyramidHeader) == 40 && sizeof(SeriesPyramidBlock) == 40, "The pyramid file layout changed!");
+
+	namespace Utils {
+
+		static constexpr uint64_t s_NoIndex = UINT64_MAX;
+
+		// the levels with blocks of at most 2^s_ChunkShift samples are built a chunk at a time, the few above from the chunk tops
+		static constexpr uint32_t s_ChunkShift = 22;
+
+		static size_t PyramidBlockCount(uint64_t count, uint32_t level)
+		{
+			uint32_t shift = SeriesPyramid::BaseLevel + level;
+			return (size_t)((count + (1ull << shift) - 1) >> shift);
+		}
+
+		static uint32_t PyramidLevelCount(uint64_t count)
+		{
+			uint32_t levels = 0;
+			while (count > 0 && PyramidBlockCount(count, levels++) > 1);
+			return levels;
+		}
+
+		static int64_t SeriesTime(const std::filesystem::path& path)
+		{
+			std::error_code error;
+			auto time = std::filesystem::last_write_time(path, error);
+			return error ? 0 : (int64_t)time.time_since_epoch().count();
+		}
+
+		static void MergeBlock(SeriesPyramidBlock& block, const SeriesPyramidBlock& other)
+		{
+			block.UndefinedCount += other.UndefinedCount;
+			if (other.MinIndex == s_NoIndex)
+				return;
+
+			// ties keep the earlier point, so the pyramid always agrees with a plain scan
+			if (block.MinIndex == s_NoIndex || other.MinY < block.MinY)
+			{
+				block.MinIndex = other.MinIndex;
+				block.MinY = other.MinY;
+			}
+			if (block.MaxIndex == s_NoIndex || other.MaxY > block.MaxY)
+			{
+				block.MaxIndex = other.MaxIndex;
+				block.MaxY = other.MaxY;
+			}
+		}
+
+		template<typename T>
+		static SeriesPyramidBlock ScanBlock(const T* y, size_t begin, size_t end)
+		{
+			SeriesPyramidBlock block = { s_NoIndex, s_NoIndex, 0.0, 0.0, 0 };
+			for (size_t i = begin; i < end; i++)
+			{
+				double value = (double)y[i];
+				if (!std::isfinite(value))
+				{
+					block.UndefinedCount++;
+					continue;
+				}
+
+				if (block.MinIndex == s_NoIndex || value < block.MinY)
+				{
+					block.MinIndex = i;
+					block.MinY = value;
+				}
+				if (block.MaxIndex == s_NoIndex || value > block.MaxY)
+				{
+					block.MaxIndex = i;
+					block.MaxY = value;
+				}
+			}
+
+			return block;
+		}
+
+		static void MergeLevel(const std::vector<SeriesPyramidBlock>& blocks, std::vector<SeriesPyramidBlock>& parents)
+		{
+			parents.resize((blocks.size() + 1) / 2);
+			for (size_t i = 0; i < parents.size(); i++)
+			{
+				parents[i] = blocks[i * 2];
+				if (i * 2 + 1 < blocks.size())
+					MergeBlock(parents[i], blocks[i * 2 + 1]);
+			}
+		}
+
+		template<typename T>
+		static bool BuildPyramid(const T* y, const SeriesPyramidHeader& header, const std::filesystem::path& path)
+		{
+			std::vector<size_t> levelOffsets(header.LevelCount);
+			size_t blockCount = 0;
+			for (uint32_t level = 0; level < header.LevelCount; level++)
+			{
+				levelOffsets[level] = blockCount;
+				blockCount += PyramidBlockCount(header.Count, level);
+			}
+
+			// built next to it and renamed once every block is written, an interrupted build never leaves a sidecar that passes the checks
+			std::filesystem::path tempPath = path;
+			tempPath += ".tmp";
+
+			{
+				std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+				if (!stream)
+					return false;
+
+				stream.write((const char*)&header, sizeof(header));
+			}
+
+			std::error_code error;
+			std::filesystem::resize_file(tempPath, sizeof(header) + blockCount * sizeof(SeriesPyramidBlock), error);
+			if (error)
+			{
+				std::filesystem::remove(tempPath, error);
+				return false;
+			}
+
+			std::fstream stream(tempPath, std::ios::binary | std::ios::in | std::ios::out);
+			if (!stream)
+			{
+				std::filesystem::remove(tempPath, error);
+				return false;
+			}
+
+			auto writeBlocks = [&](uint32_t level, size_t firstBlock, const std::vector<SeriesPyramidBlock>& blocks)
+			{
+				stream.seekp((std::streamoff)(sizeof(header) + (levelOffsets[level] + firstBlock) * sizeof(SeriesPyramidBlock)));
+				stream.write((const char*)blocks.data(), (std::streamsize)(blocks.size() * sizeof(SeriesPyramidBlock)));
+			};
+
+			uint32_t chunkLevels = std::min(header.LevelCount, s_ChunkShift - SeriesPyramid::BaseLevel + 1);
+			size_t chunkSize = (size_t)1 << s_ChunkShift;
+			size_t chunkCount = (size_t)((header.Count + chunkSize - 1) / chunkSize);
+
+			// a few chunks per thread at a time keeps the memory bounded no matter how big the series is
+			size_t batchSize = (size_t)JobSystem::GetThreadCount() * 2;
+			std::vector<std::vector<std::vector<SeriesPyramidBlock>>> batch(batchSize, std::vector<std::vector<SeriesPyramidBlock>>(chunkLevels));
+			std::vector<SeriesPyramidBlock> tops;
+
+			for (size_t firstChunk = 0; firstChunk < chunkCount; firstChunk += batchSize)
+			{
+				size_t batchChunks = std::min(batchSize, chunkCount - firstChunk);
+				JobSystem::ParallelFor(batchChunks, 1, [&](size_t begin, size_t end)
+				{
+					for (size_t c = begin; c < end; c++)
+					{
+						auto& levels = batch[c];
+						size_t chunkBegin = (firstChunk + c) * chunkSize;
+						size_t chunkEnd = (size_t)std::min<uint64_t>(chunkBegin + chunkSize, header.Count);
+
+						size_t baseSize = (size_t)1 << SeriesPyramid::BaseLevel;
+						levels[0].clear();
+						for (size_t i = chunkBegin; i < chunkEnd; i += baseSize)
+							levels[0].push_back(ScanBlock(y, i, std::min(i + baseSize, chunkEnd)));
+
+						for (uint32_t level = 1; level < chunkLevels; level++)
+							MergeLevel(levels[level - 1], levels[level]);
+					}
+				});
+
+				for (size_t c = 0; c < batchChunks; c++)
+				{
+					for (uint32_t level = 0; level < chunkLevels; level++)
+						writeBlocks(level, (firstChunk + c) << (s_ChunkShift - SeriesPyramid::BaseLevel - level), batch[c][level]);
+
+					if (chunkLevels < header.LevelCount)
+						tops.push_back(batch[c][chunkLevels - 1][0]);
+				}
+			}
+
+			std::vector<SeriesPyramidBlock> parents;
+			for (uint32_t level = chunkLevels; level < header.LevelCount; level++)
+			{
+				MergeLevel(tops, parents);
+				writeBlocks(level, 0, parents);
+				std::swap(tops, parents);
+			}
+
+			stream.close();
+			if (!stream)
+			{
+				std::filesystem::remove(tempPath, error);
+				return false;
+			}
+
+			std::filesystem::rename(tempPath, path, error);
+			if (error)
+			{
+				std::filesystem::remove(tempPath, error);
+				return false;
+			}
+
+			return true;
+		}
+
+	}
+
+	SeriesPyramid::SeriesPyramid(const std::filesystem::path& path, const SeriesFile& series)
+		: m_File(path)
+	{
+		if (!m_File.IsOpen())
+		{
+			m_Error = "failed to open the file";
+			return;
+		}
+
+		SeriesPyramidHeader header{};
+		if (m_File.GetSize() < sizeof(header))
+		{
+			m_Error = "the file is too small for the header";
+			return;
+		}
+
+		std::memcpy(&header, m_File.GetData(), sizeof(header));
+		if (std::memcmp(header.Magic, SeriesPyramidHeader().Magic, sizeof(header.Magic)) != 0 || header.Version != SeriesPyramidHeader().Version || header.BaseLevel != BaseLevel)
+		{
+			m_Error = "not a pyramid file (or an unknown version)";
+			return;
+		}
+
+		if (header.Count != series.GetCount() || header.SeriesSize != series.GetFileSize() || header.SeriesTime != Utils::SeriesTime(series.GetPath()) ||
+			header.LevelCount != Utils::PyramidLevelCount(header.Count))
+		{
+			m_Error = "built for a different series";
+			return;
+		}
+
+		m_LevelCount = header.LevelCount;
+		m_LevelOffsets.resize(m_LevelCount);
+
+		size_t blockCount = 0;
+		for (uint32_t level = 0; level < m_LevelCount; level++)
+		{
+			m_LevelOffsets[level] = blockCount;
+			blockCount += Utils::PyramidBlockCount(header.Count, level);
+		}
+
+		if (m_File.GetSize() != sizeof(header) + blockCount * sizeof(SeriesPyramidBlock))
+		{
+			m_Error = "the file is shorter than its header says";
+			return;
+		}
+
+		m_Blocks = (const SeriesPyramidBlock*)(m_File.GetData() + sizeof(header));
+	}
+
+	template<typename T>
+	void SeriesPyramid::FindMinMax(const T* y, size_t begin, size_t end, size_t& minIndex, size_t& maxIndex, bool& hasUndefined) const
+	{
+		SeriesPyramidBlock result = { Utils::s_NoIndex, Utils::s_NoIndex, 0.0, 0.0, 0 };
+		size_t baseSize = (size_t)1 << BaseLevel;
+
+		// samples up to the first block boundary, then the biggest aligned blocks that fit, then the samples after the last one
+		size_t i = begin;
+		size_t headEnd = std::min(end, (begin + baseSize - 1) & ~(baseSize - 1));
+		Utils::MergeBlock(result, Utils::ScanBlock(y, i, headEnd));
+		i = headEnd;
+
+		while (IsValid() && i + baseSize <= end)
+		{
+			uint32_t level = 0;
+			while (level + 1 < m_LevelCount)
+			{
+				size_t size = baseSize << (level + 1);
+				if ((i & (size - 1)) != 0 || i + size > end)
+					break;
+				level++;
+			}
+
+			Utils::MergeBlock(result, m_Blocks[m_LevelOffsets[level] + (i >> (BaseLevel + level))]);
+			i += baseSize << level;
+		}
+
+		Utils::MergeBlock(result, Utils::ScanBlock(y, i, end));
+
+		minIndex = result.MinIndex == Utils::s_NoIndex ? SIZE_MAX : (size_t)result.MinIndex;
+		maxIndex = result.MaxIndex == Utils::s_NoIndex ? SIZE_MAX : (size_t)result.MaxIndex;
+		hasUndefined = result.UndefinedCount > 0;
+	}
+
+	template void SeriesPyramid::FindMinMax<float>(const float*, size_t, size_t, size_t&, size_t&, bool&) const;
+	template void SeriesPyramid::FindMinMax<double>(const double*, size_t, size_t, size_t&, size_t&, bool&) const;
+
+	bool SeriesPyramid::Build(const SeriesFile& series, const std::filesystem::path& path)
+	{
+		if (!series.IsValid())
+			return false;
+
+		SeriesPyramidHeader header{};
+		header.BaseLevel = BaseLevel;
+		header.LevelCount = Utils::PyramidLevelCount(series.GetCount());
+		header.Count = series.GetCount();
+		header.SeriesSize = series.GetFileSize();
+		header.SeriesTime = Utils::SeriesTime(series.GetPath());
+
+		if (series.GetValueType() == SeriesValueType::Float64)
+			return Utils::BuildPyramid((const double*)series.GetYData(), header, path);
+
+		return Utils::BuildPyramid((const float*)series.GetYData(), header, path);
+	}
+
+}
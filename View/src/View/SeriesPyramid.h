@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Curve/Core/MappedFile.h>
+
+#include <string>
+#include <vector>
+#include <filesystem>
+
+namespace cv {
+
+	class SeriesFile;
+
+	// a block of 2^(BaseLevel + level) samples, indices are UINT64_MAX for a block without any defined y
+	struct SeriesPyramidBlock
+	{
+		uint64_t MinIndex, MaxIndex;
+		double MinY, MaxY;
+
+		// points with an undefined y, they break the line so a range holding any has to be scanned
+		uint64_t UndefinedCount;
+	};
+
+	// little endian, followed by the blocks of every level starting at the finest, each level holds ceil(Count / block size) blocks
+	struct SeriesPyramidHeader
+	{
+		char Magic[4] = { 'C', 'V', 'L', 'P' };
+		uint32_t Version = 2;
+		uint32_t BaseLevel = 0;
+		uint32_t LevelCount = 0;
+		uint64_t Count = 0;
+
+		// of the series file the pyramid was built for, a pyramid that doesn't match is built again
+		uint64_t SeriesSize = 0;
+		int64_t SeriesTime = 0;
+	};
+
+	// a min/max pyramid over a series file, kept in a sidecar file next to it and mapped just like the series
+	// the lowest and highest point of any index range is found in O(levels) blocks plus less than two base blocks of samples
+	class SeriesPyramid
+	{
+	public:
+		static constexpr uint32_t BaseLevel = 6;
+
+		SeriesPyramid(const std::filesystem::path& path, const SeriesFile& series);
+
+		bool IsValid() const { return m_Blocks != nullptr; }
+		const std::string& GetError() const { return m_Error; }
+
+		// indices of the lowest and highest defined point in [begin, end), both are SIZE_MAX if there is none,
+		// hasUndefined is set if any point in the range has an undefined y
+		template<typename T>
+		void FindMinMax(const T* y, size_t begin, size_t end, size_t& minIndex, size_t& maxIndex, bool& hasUndefined) const;
+
+		// scans the series once, the blocks are worked out in parallel a few million samples at a time
+		static bool Build(const SeriesFile& series, const std::filesystem::path& path);
+	private:
+		MappedFile m_File;
+		std::string m_Error;
+
+		const SeriesPyramidBlock* m_Blocks = nullptr;
+		std::vector<size_t> m_LevelOffsets; // in blocks
+		uint32_t m_LevelCount = 0;
+	};
+
+}
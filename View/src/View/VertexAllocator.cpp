@@ -0,0 +1,91 @@
+#include "VertexAllocator.h"
+
+#include <algorithm>
+
+namespace cv {
+
+	VertexAllocator::VertexAllocator(size_t first, size_t capacity)
+	{
+		Reset(first, capacity);
+	}
+
+	size_t VertexAllocator::Allocate(size_t count)
+	{
+		if (count == 0)
+			return InvalidOffset;
+
+		for (auto it = m_FreeRanges.begin(); it != m_FreeRanges.end(); it++)
+		{
+			auto [offset, freeCount] = *it;
+			if (freeCount < count)
+				continue;
+
+			m_FreeRanges.erase(it);
+			if (freeCount > count)
+				m_FreeRanges.emplace(offset + count, freeCount - count);
+
+			m_FreeCount -= count;
+			return offset;
+		}
+
+		return InvalidOffset;
+	}
+
+	void VertexAllocator::Free(size_t offset, size_t count)
+	{
+		if (count == 0)
+			return;
+
+		m_FreeCount += count;
+
+		auto next = m_FreeRanges.lower_bound(offset);
+		if (next != m_FreeRanges.end() && offset + count == next->first)
+		{
+			count += next->second;
+			next = m_FreeRanges.erase(next);
+		}
+
+		if (next != m_FreeRanges.begin())
+		{
+			auto previous = std::prev(next);
+			if (previous->first + previous->second == offset)
+			{
+				previous->second += count;
+				return;
+			}
+		}
+
+		m_FreeRanges.emplace_hint(next, offset, count);
+	}
+
+	void VertexAllocator::Reset(size_t first, size_t capacity)
+	{
+		m_FreeRanges.clear();
+		if (capacity > 0)
+			m_FreeRanges.emplace(first, capacity);
+
+		m_First = first;
+		m_Capacity = capacity;
+		m_FreeCount = capacity;
+	}
+
+	void VertexAllocator::Grow(size_t capacity)
+	{
+		if (capacity <= m_Capacity)
+			return;
+
+		size_t end = m_First + m_Capacity;
+		m_Capacity = capacity;
+		Free(end, m_First + capacity - end);
+	}
+
+	size_t VertexAllocator::GetLargestFreeCount() const
+	{
+		size_t largest = 0;
+		for (const auto& [offset, count] : m_FreeRanges)
+			largest = std::max(largest, count);
+
+		return largest;
+	}
+
+}
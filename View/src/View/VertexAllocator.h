@@ -0,0 +1,40 @@
+#pragma once
+
+#include <map>
+#include <cstddef>
+#include <cstdint>
+
+namespace cv {
+
+	// hands out ranges of [first, first + capacity) of a vertex buffer, first fit, a freed range is merged with the free ones next to it
+	class VertexAllocator
+	{
+	public:
+		static constexpr size_t InvalidOffset = SIZE_MAX;
+
+		VertexAllocator(size_t first = 0, size_t capacity = 0);
+
+		// InvalidOffset if no free range is big enough
+		size_t Allocate(size_t count);
+		void Free(size_t offset, size_t count);
+
+		// frees everything at once
+		void Reset(size_t first, size_t capacity);
+
+		// adds free room at the end, the allocated ranges stay where they are
+		void Grow(size_t capacity);
+
+		size_t GetFirst() const { return m_First; }
+		size_t GetCapacity() const { return m_Capacity; }
+		size_t GetFreeCount() const { return m_FreeCount; }
+
+		// the biggest allocation that would succeed right now
+		size_t GetLargestFreeCount() const;
+	private:
+		std::map<size_t, size_t> m_FreeRanges; // offset to count
+		size_t m_First = 0;
+		size_t m_Capacity = 0;
+		size_t m_FreeCount = 0;
+	};
+
+}
@@ -37,10 +37,14 @@ namespace cv {
 		spec.Multisample = true;
 
 		m_Framebuffer = renderer->CreateFramebuffer(spec);
+		if (Application::Get().IsHeadless())
+			Application::Get().SetHeadlessTarget(m_Framebuffer);
 
 		m_LineRenderer = new LineRenderer(renderer, m_Framebuffer);
 		m_LineRenderer->AddLine([](float x) { return x * cos(x) * sin(x); }, { 1.0f, 1.0f, 1.0f, 1.0f });
-		m_LineRenderer->AddLine([](float x) { return x * sin(x); }, { 1.0f, 1.0f, 1.0f, 1.0f });
+		m_LineRenderer->AddLine(Expression("x sin(x)"), { 1.0f, 1.0f, 1.0f, 1.0f }, LineSamplingMode::GPU);
+		m_LineRenderer->AddImplicitLine(Expression("x^2 + y^2 - 4", { "x", "y" }), { 1.0f, 1.0f, 1.0f, 1.0f });
+		m_LineRenderer->AddPolarLine(Expression("0.2 t", { "t" }), 0.0f, 40.0f, { 1.0f, 1.0f, 1.0f, 1.0f });
 
 		Window& window = renderer->GetWindow();
 		m_Camera = GraphCamera((float)window.GetWidth(), (float)window.GetHeight());
@@ -2,6 +2,9 @@
 
 #include <Curve/Core/EntryPoint.h>
 
+#include <cstring>
+#include <cctype>
+
 cv::Application* cv::CreateApplication(int argc, char** argv)
 {
 	ApplicationSpecification spec{};
@@ -12,6 +15,19 @@ cv::Application* cv::CreateApplication(int argc, char** argv)
 	spec.UseImGui = true;
 	spec.UseDefaultTitlebar = true;
 
+	// --headless [frame count] [output.ppm]
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--headless") != 0)
+			continue;
+
+		spec.Headless = true;
+		if (i + 1 < argc && isdigit(argv[i + 1][0]))
+			spec.HeadlessFrameCount = (uint32_t)atoi(argv[++i]);
+		if (i + 1 < argc && argv[i + 1][0] != '-')
+			spec.HeadlessOutputPath = argv[++i];
+	}
+
 	Application* app = new Application(spec);
 	app->PushLayer(new ViewLayer());
 
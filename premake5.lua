@@ -24,6 +24,21 @@ Library["ShaderC_Release"] = "%{LibraryDir.Vulkan}/shaderc_shared.lib"
 Library["SPIRV_Cross_Release"] = "%{LibraryDir.Vulkan}/spirv-cross-core.lib"
 Library["SPIRV_Cross_GLSL_Release"] = "%{LibraryDir.Vulkan}/spirv-cross-glsl.lib"
 
+-- Linux uses the system (or SDK) shared libraries by name, e.g. for headless runs on lavapipe
+if os.target() == "linux" then
+	IncludeDir["Vulkan"] = (VULKAN_SDK or "/usr") .. "/include"
+
+	Library["Vulkan"] = "vulkan"
+
+	Library["ShaderC_Debug"] = "shaderc_shared"
+	Library["SPIRV_Cross_Debug"] = "spirv-cross-core"
+	Library["SPIRV_Cross_GLSL_Debug"] = "spirv-cross-glsl"
+
+	Library["ShaderC_Release"] = "shaderc_shared"
+	Library["SPIRV_Cross_Release"] = "spirv-cross-core"
+	Library["SPIRV_Cross_GLSL_Release"] = "spirv-cross-glsl"
+end
+
 workspace "Curve"
 	architecture "x86_64"
 	startproject "View"
@@ -102,6 +117,22 @@ project "Curve"
 			"dwmapi.lib"
 		}
 
+	-- the expression SIMD kernels are the only code built for wider instruction sets, the cpu is checked at runtime before using them
+	filter "files:**/ExpressionSIMDSSE41.cpp"
+		flags { "NoPCH" }
+
+	filter "files:**/ExpressionSIMDAVX2.cpp"
+		flags { "NoPCH" }
+
+	filter { "files:**/ExpressionSIMDSSE41.cpp", "system:linux" }
+		buildoptions { "-msse4.1" }
+
+	filter { "files:**/ExpressionSIMDAVX2.cpp", "system:linux" }
+		buildoptions { "-mavx2", "-mfma", "-ffp-contract=off" }
+
+	filter { "files:**/ExpressionSIMDAVX2.cpp", "system:windows" }
+		buildoptions { "/arch:AVX2" }
+
 	filter "configurations:Debug"
 		defines "CV_DEBUG"
 		runtime "Debug"
@@ -176,6 +207,13 @@ project "View"
 
 		defines { "NOMINMAX" }
 
+	filter "system:linux"
+		links
+		{
+			"pthread",
+			"dl"
+		}
+
 	filter "configurations:Debug"
 		kind "ConsoleApp"
 		defines "CV_DEBUG"